@@ -0,0 +1,130 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <QtTest/QTest>
+
+#include "compiledtemplate.h"
+#include "context.h"
+#include "corpus.h"
+#include "engine.h"
+#include "grantlee_paths.h"
+#include "template.h"
+
+// Generated by grantlee-compile from the templates directory.
+void addCompiledBenchmarkTemplates(Grantlee::CompiledTemplateLoader *loader);
+
+using namespace Grantlee;
+
+class CompiledBenchmarks : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void load_data();
+  void load();
+
+  void render_data();
+  void render();
+
+private:
+  Engine *m_interpretedEngine;
+  Engine *m_compiledEngine;
+};
+
+void CompiledBenchmarks::initTestCase()
+{
+  m_interpretedEngine = new Engine(this);
+  m_interpretedEngine->setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  auto fileLoader = QSharedPointer<FileSystemTemplateLoader>::create();
+  fileLoader->setTemplateDirs(
+      {QStringLiteral(GRANTLEE_BENCHMARK_TEMPLATE_PATH)});
+  m_interpretedEngine->addTemplateLoader(fileLoader);
+
+  m_compiledEngine = new Engine(this);
+  m_compiledEngine->setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  auto compiledLoader = QSharedPointer<CompiledTemplateLoader>::create();
+  addCompiledBenchmarkTemplates(compiledLoader.data());
+  m_compiledEngine->addTemplateLoader(compiledLoader);
+}
+
+void CompiledBenchmarks::cleanupTestCase()
+{
+  delete m_interpretedEngine;
+  delete m_compiledEngine;
+}
+
+void CompiledBenchmarks::load_data()
+{
+  QTest::addColumn<bool>("compiled");
+
+  QTest::newRow("interpreted") << false;
+  QTest::newRow("compiled") << true;
+}
+
+void CompiledBenchmarks::load()
+{
+  QFETCH(bool, compiled);
+
+  const auto engine = compiled ? m_compiledEngine : m_interpretedEngine;
+
+  QBENCHMARK
+  {
+    const auto t = engine->loadByName(QStringLiteral("page.html"));
+    QCOMPARE(t->error(), NoError);
+  }
+}
+
+void CompiledBenchmarks::render_data()
+{
+  QTest::addColumn<bool>("compiled");
+  QTest::addColumn<int>("articles");
+
+  QTest::newRow("interpreted-10") << false << 10;
+  QTest::newRow("compiled-10") << true << 10;
+  QTest::newRow("interpreted-100") << false << 100;
+  QTest::newRow("compiled-100") << true << 100;
+}
+
+void CompiledBenchmarks::render()
+{
+  QFETCH(bool, compiled);
+  QFETCH(int, articles);
+
+  const auto interpreted
+      = m_interpretedEngine->loadByName(QStringLiteral("page.html"));
+  const auto t = compiled
+                     ? m_compiledEngine->loadByName(QStringLiteral("page.html"))
+                     : interpreted;
+  QCOMPARE(t->error(), NoError);
+
+  Context c(Corpus::context(articles));
+
+  // Both engines render the same output.
+  QCOMPARE(t->render(&c), interpreted->render(&c));
+
+  QBENCHMARK { t->render(&c); }
+}
+
+QTEST_MAIN(CompiledBenchmarks)
+#include "compiledbenchmarks.moc"
@@ -0,0 +1,332 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "corpus.h"
+
+#include <QtCore/QDateTime>
+
+static const char *const s_words[]
+    = {"template", "engine",  "render",   "context", "filter",  "library",
+       "plugin",   "escape",  "markup",   "document", "variable", "block",
+       "inherit",  "include", "loop",     "theme",   "locale",  "string",
+       "widget",   "model",   "signal",   "property", "cache",   "stream",
+       "parser",   "token",   "node",     "output",  "syntax",  "query"};
+
+static const int s_wordCount = sizeof(s_words) / sizeof(*s_words);
+
+static const char *const s_categories[]
+    = {"news", "tutorials", "releases", "community", "internals"};
+
+static const int s_categoryCount
+    = sizeof(s_categories) / sizeof(*s_categories);
+
+static QString word(int index)
+{
+  return QString::fromLatin1(s_words[index % s_wordCount]);
+}
+
+static QString words(int seed, int count)
+{
+  QStringList result;
+  for (auto i = 0; i < count; ++i)
+    result.append(word(seed * 7 + i * 13));
+  return result.join(QLatin1Char(' '));
+}
+
+static QString paragraphs(int seed, int count)
+{
+  QString result;
+  for (auto i = 0; i < count; ++i) {
+    result += QStringLiteral("<p>") + words(seed + i, 12)
+              + QStringLiteral(" <b>") + words(seed + i + 1, 3)
+              + QStringLiteral("</b> & ") + words(seed + i + 2, 20)
+              + QStringLiteral(".\n") + words(seed + i + 3, 8)
+              + QStringLiteral("</p>\n");
+  }
+  return result;
+}
+
+static QVariantHash author(int index)
+{
+  QVariantHash author;
+  const QString name = word(index) + QLatin1Char(' ') + word(index + 11);
+  author.insert(QStringLiteral("name"), name);
+  author.insert(QStringLiteral("email"),
+                QString(word(index) + QStringLiteral("@example.org")));
+  author.insert(QStringLiteral("bio"), words(index, 15));
+  return author;
+}
+
+static QVariantHash article(int index)
+{
+  QVariantHash article;
+  article.insert(QStringLiteral("id"), index);
+  article.insert(QStringLiteral("title"), words(index, 6));
+  article.insert(QStringLiteral("url"),
+                 QString(QStringLiteral("/articles/") + QString::number(index)
+                         + QLatin1Char('/')));
+  article.insert(QStringLiteral("author"), author(index % 9));
+  article.insert(QStringLiteral("published"),
+                 QDateTime(QDate(2020, 1, 1).addDays(index), QTime(9, 30)));
+  article.insert(QStringLiteral("body"), paragraphs(index, 5));
+  article.insert(QStringLiteral("category"),
+                 QString::fromLatin1(s_categories[index % s_categoryCount]));
+
+  QVariantList tags;
+  for (auto i = 0; i < 4; ++i)
+    tags.append(word(index + i * 5).toUpper());
+  article.insert(QStringLiteral("tags"), tags);
+
+  QVariantList comments;
+  const auto commentCount = 3 + index % 7;
+  for (auto i = 0; i < commentCount; ++i) {
+    QVariantHash comment;
+    comment.insert(
+        QStringLiteral("author"),
+        author((index + i / 2) % 9).value(QStringLiteral("name")));
+    comment.insert(QStringLiteral("text"),
+                   QString(words(index + i, 10) + QLatin1Char('\n')
+                           + words(i, 5)));
+    comment.insert(QStringLiteral("score"), (index + i) % 5);
+    comments.append(comment);
+  }
+  article.insert(QStringLiteral("comments"), comments);
+  return article;
+}
+
+QHash<QString, QString> Corpus::templates()
+{
+  QHash<QString, QString> templates;
+
+  templates.insert(
+      QStringLiteral("base.html"),
+      QStringLiteral(
+          "<!DOCTYPE html>\n"
+          "<html>\n"
+          "<head><title>{% block title %}{{ site.name }}{% endblock "
+          "%}</title></head>\n"
+          "<body>\n"
+          "<header><h1>{{ site.name }}</h1><p>{{ site.tagline|capfirst "
+          "}}</p></header>\n"
+          "<nav><ul>{% for category in categories %}"
+          "<li><a href=\"/{{ category.slug }}/\">{{ category.name|title "
+          "}}</a> ({{ category.count }})</li>"
+          "{% endfor %}</ul></nav>\n"
+          "<main>{% block content %}{% endblock %}</main>\n"
+          "<aside>{% block sidebar %}{% if user.isStaff %}"
+          "<a href=\"/admin/\">Admin</a>{% endif %}{% endblock %}</aside>\n"
+          "<footer>{% block footer %}&copy; {{ site.name }}{% endblock "
+          "%}</footer>\n"
+          "</body>\n"
+          "</html>\n"));
+
+  templates.insert(
+      QStringLiteral("section.html"),
+      QStringLiteral(
+          "{% extends \"base.html\" %}\n"
+          "{% block title %}{{ page_title }} | {{ block.super }}{% endblock "
+          "%}\n"
+          "{% block content %}<section>{% block articles %}{% endblock "
+          "%}</section>{% endblock %}\n"
+          "{% block sidebar %}{{ block.super }}<h3>Recent</h3><ul>"
+          "{% for article in articles|slice:\":10\" %}"
+          "<li>{{ article.title }}</li>{% endfor %}</ul>{% endblock %}\n"));
+
+  templates.insert(
+      QStringLiteral("inheritance.html"),
+      QStringLiteral("{% extends \"section.html\" %}\n"
+                     "{% block articles %}{% for article in articles %}"
+                     "<article><h2>{{ article.title|title }}</h2>"
+                     "{{ article.body|safe }}</article>"
+                     "{% endfor %}{% endblock %}\n"
+                     "{% block footer %}{{ block.super }} {{ articles|length "
+                     "}} articles{% endblock %}\n"));
+
+  templates.insert(QStringLiteral("header.html"),
+                   QStringLiteral("<header><h1>{{ site.name }}</h1>"
+                                  "<p>{{ site.tagline }}</p></header>\n"));
+
+  templates.insert(QStringLiteral("footer.html"),
+                   QStringLiteral("<footer>&copy; {{ site.name }}</footer>\n"));
+
+  templates.insert(
+      QStringLiteral("article_summary.html"),
+      QStringLiteral(
+          "<article id=\"article-{{ article.id }}\">\n"
+          "<h2><a href=\"{{ article.url }}\">{{ article.title|title "
+          "}}</a></h2>\n"
+          "<p class=\"meta\">{{ article.author.name }} &middot; "
+          "{{ article.published|date:\"yyyy-MM-dd\" }} &middot; "
+          "{{ article.comments|length }} comments</p>\n"
+          "<p>{{ article.body|striptags|truncatewords:30 }}</p>\n"
+          "<ul class=\"tags\">{% for tag in article.tags %}"
+          "<li>{{ tag|lower }}</li>{% endfor %}</ul>\n"
+          "</article>\n"));
+
+  templates.insert(QStringLiteral("comment.html"),
+                   QStringLiteral("<li><b>{{ comment.author }}</b>: "
+                                  "{{ comment.text|linebreaksbr }}</li>\n"));
+
+  templates.insert(
+      QStringLiteral("include.html"),
+      QStringLiteral("{% include \"header.html\" %}\n"
+                     "{% for article in articles %}"
+                     "{% include \"article_summary.html\" %}<ul>"
+                     "{% for comment in article.comments %}"
+                     "{% include \"comment.html\" %}{% endfor %}</ul>"
+                     "{% endfor %}\n"
+                     "{% include \"footer.html\" %}\n"));
+
+  templates.insert(
+      QStringLiteral("loop.html"),
+      QStringLiteral(
+          "<table>\n"
+          "{% for article in articles %}"
+          "<tr class=\"{% cycle 'odd' 'even' %}\">"
+          "<td>{{ forloop.counter }}</td><td>{{ article.title }}</td>"
+          "<td>{% for tag in article.tags %}{{ tag }}"
+          "{% if not forloop.last %}, {% endif %}{% endfor %}</td>"
+          "<td>{% for comment in article.comments %}"
+          "{% ifchanged comment.author %}{{ comment.author }}{% endifchanged "
+          "%}"
+          "{% if comment.score > 2 %}+{% else %}-{% endif %}"
+          "{% endfor %}</td>"
+          "<td>{% with article.author as author %}{{ author.name }} "
+          "&lt;{{ author.email }}&gt;{% endwith %}</td></tr>\n"
+          "{% endfor %}"
+          "</table>\n"
+          "{% regroup articles by category as grouped %}"
+          "{% for group in grouped %}<h3>{{ group.grouper }}</h3>"
+          "{% for article in group.list %}{{ article.id }} {% endfor %}"
+          "{% endfor %}\n"));
+
+  templates.insert(
+      QStringLiteral("filters.html"),
+      QStringLiteral(
+          "{% for article in articles %}"
+          "<h2>{{ article.title|title|cut:\" \"|slugify }}</h2>"
+          "<p>{{ article.body|striptags|wordcount }} words, "
+          "{{ article.published|date:\"dd MMM yyyy\" }}</p>"
+          "<p>{{ article.tags|join:\", \"|upper }}</p>"
+          "<p>{{ article.body|removetags:\"b\"|truncatewords:15 }}</p>"
+          "{% for comment in article.comments|dictsort:\"author\" %}"
+          "{{ comment.author|capfirst }} {{ comment.score|add:1 }}"
+          "{{ comment.text|linebreaks }}{% endfor %}"
+          "{% endfor %}\n"));
+
+  return templates;
+}
+
+QStringList Corpus::pages()
+{
+  return {QStringLiteral("loop.html"), QStringLiteral("inheritance.html"),
+          QStringLiteral("include.html"), QStringLiteral("filters.html")};
+}
+
+QVariantHash Corpus::context(int articles)
+{
+  QVariantHash context;
+
+  QVariantHash site;
+  site.insert(QStringLiteral("name"), QStringLiteral("Grantlee Blog"));
+  site.insert(QStringLiteral("tagline"),
+              QStringLiteral("string templates for Qt"));
+  context.insert(QStringLiteral("site"), site);
+
+  QVariantHash user;
+  user.insert(QStringLiteral("name"), author(0).value(QStringLiteral("name")));
+  user.insert(QStringLiteral("isStaff"), true);
+  context.insert(QStringLiteral("user"), user);
+
+  context.insert(QStringLiteral("page_title"), QStringLiteral("Articles"));
+
+  QVariantList categories;
+  for (auto i = 0; i < s_categoryCount; ++i) {
+    QVariantHash category;
+    const auto name = QString::fromLatin1(s_categories[i]);
+    category.insert(QStringLiteral("name"), name);
+    category.insert(QStringLiteral("slug"), name);
+    category.insert(QStringLiteral("count"),
+                    articles / s_categoryCount + (i < articles % s_categoryCount
+                                                      ? 1
+                                                      : 0));
+    categories.append(category);
+  }
+  context.insert(QStringLiteral("categories"), categories);
+
+  QVariantList articleList;
+  for (auto i = 0; i < articles; ++i)
+    articleList.append(article(i));
+  context.insert(QStringLiteral("articles"), articleList);
+
+  return context;
+}
+
+QString Corpus::generatedTemplate(int size)
+{
+  QString result;
+  result.reserve(size + 512);
+  for (auto i = 0; result.size() < size; ++i) {
+    result += QStringLiteral("<div class=\"item\">\n  {# item ")
+              + QString::number(i)
+              + QStringLiteral(
+                    " #}\n"
+                    "  <h2>{{ item.title|title }}</h2>\n"
+                    "  {% if item.visible %}<p>{{ item.text|truncatewords:20 "
+                    "}}</p>{% else %}<p>Hidden</p>{% endif %}\n"
+                    "  {% for tag in item.tags %}<span>{{ tag }}</span>"
+                    "{% endfor %}\n  <p>")
+              + words(i, 15) + QStringLiteral("</p>\n</div>\n");
+  }
+  return result;
+}
+
+QString Corpus::document(int sections)
+{
+  QString result = QStringLiteral("<html><body>\n");
+  for (auto i = 0; i < sections; ++i) {
+    result += QStringLiteral("<h2>") + words(i, 4) + QStringLiteral("</h2>\n")
+              + QStringLiteral("<p>") + words(i, 10) + QStringLiteral(" <b>")
+              + words(i + 1, 3) + QStringLiteral("</b> <i>") + words(i + 2, 3)
+              + QStringLiteral("</i> <u>") + words(i + 3, 2)
+              + QStringLiteral("</u> <a href=\"https://example.org/")
+              + QString::number(i) + QStringLiteral("\">") + words(i + 4, 2)
+              + QStringLiteral("</a> <span style=\"color:#aa0000;\">")
+              + words(i + 5, 3) + QStringLiteral("</span> ") + words(i + 6, 12)
+              + QStringLiteral("</p>\n<ul>\n");
+    for (auto item = 0; item < 3; ++item)
+      result += QStringLiteral("<li>") + words(i + item, 5)
+                + QStringLiteral("</li>\n");
+    result += QStringLiteral("</ul>\n<ol>\n<li>") + words(i, 3)
+              + QStringLiteral("<ol><li>") + words(i + 1, 3)
+              + QStringLiteral("</li></ol></li>\n</ol>\n")
+              + QStringLiteral("<table border=\"1\">\n");
+    for (auto row = 0; row < 3; ++row) {
+      result += QStringLiteral("<tr>");
+      for (auto column = 0; column < 3; ++column)
+        result += QStringLiteral("<td>") + words(i + row + column, 2)
+                  + QStringLiteral("</td>");
+      result += QStringLiteral("</tr>\n");
+    }
+    result += QStringLiteral("</table>\n");
+  }
+  result += QStringLiteral("</body></html>\n");
+  return result;
+}
@@ -0,0 +1,68 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_BENCHMARK_CORPUS_H
+#define GRANTLEE_BENCHMARK_CORPUS_H
+
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+/*
+  A generated corpus modelled on a blog with articles, authors, tags and
+  comments. The corpus is deterministic so that results of different runs
+  can be compared.
+*/
+namespace Corpus
+{
+
+/*
+  Returns the templates of the corpus by name.
+*/
+QHash<QString, QString> templates();
+
+/*
+  Returns the names of the templates which render a complete page.
+
+  "loop.html" iterates deeply nested data, "inheritance.html" extends a
+  chain of three templates, "include.html" includes a template for each
+  article and "filters.html" chains filters on each article.
+*/
+QStringList pages();
+
+/*
+  Returns the context for the pages with @p articles articles.
+*/
+QVariantHash context(int articles);
+
+/*
+  Returns a template of at least @p size characters which mixes text,
+  variables, filters, tags and comments.
+*/
+QString generatedTemplate(int size);
+
+/*
+  Returns an html document with @p sections sections of headings,
+  formatted paragraphs, lists and tables.
+*/
+QString document(int sections);
+}
+
+#endif
@@ -0,0 +1,2 @@
+#define GRANTLEE_PLUGIN_PATH "@GRANTLEE_PLUGIN_PATH@"
+#define GRANTLEE_BENCHMARK_TEMPLATE_PATH "@CMAKE_CURRENT_SOURCE_DIR@/templates"
@@ -0,0 +1,610 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  Runs the benchmark corpus and compares the results to a baseline.
+
+  Each case runs in its own process so that its peak resident set size is
+  not affected by the other cases. The results are written as JSON:
+
+    {
+      "iterations": 20,
+      "cases": {
+        "render/loop.html": {
+          "wallTimeMs": 1.2, "cpuTimeMs": 1.2,
+          "allocations": 5230, "peakRssKb": 14200
+        },
+        ...
+      }
+    }
+
+  Times and allocations are per iteration. wallTimeMs is the median of all
+  iterations. A results file can be used as the baseline of a later run,
+  which fails if any metric of a case exceeds its baseline by more than the
+  relative threshold plus the absolute threshold of the metric. The
+  absolute threshold keeps short cases from failing on timer noise.
+*/
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+#include <QtCore/QTextStream>
+#include <QtCore/QVector>
+
+#include "cachingloaderdecorator.h"
+#include "context.h"
+#include "corpus.h"
+#include "engine.h"
+#include "grantlee_paths.h"
+#include "lexer_p.h"
+#include "outputstream.h"
+#include "template.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace Grantlee;
+
+static std::atomic<quint64> s_allocations{0};
+
+#if defined(__GLIBC__)
+// Count every heap allocation of the process, including those made by Qt
+// containers which do not use operator new, and aligned allocations.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept
+{
+  if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto result = __libc_memalign(alignment, size);
+  if (!result)
+    return ENOMEM;
+  *ptr = result;
+  return 0;
+}
+
+void *valloc(size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_valloc(size);
+}
+
+void *pvalloc(size_t size) noexcept
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_pvalloc(size);
+}
+
+void free(void *ptr) noexcept { __libc_free(ptr); }
+}
+#define GRANTLEE_COUNT_ALLOCATIONS 1
+#endif
+
+static const QString s_wallTimeMetric = QStringLiteral("wallTimeMs");
+static const QString s_cpuTimeMetric = QStringLiteral("cpuTimeMs");
+static const QString s_allocationsMetric = QStringLiteral("allocations");
+static const QString s_peakRssMetric = QStringLiteral("peakRssKb");
+
+// Returned when cases could not be compared, which ctest reports as skipped.
+static const int s_skipExitCode = 77;
+
+#ifdef Q_OS_UNIX
+static double cpuTimeMs()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0
+         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+static qint64 peakRssKb()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef Q_OS_MACOS
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+#endif
+
+class CaseRunner
+{
+public:
+  CaseRunner()
+  {
+    m_engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+    m_loader = QSharedPointer<InMemoryTemplateLoader>::create();
+    const auto templates = Corpus::templates();
+    for (auto it = templates.constBegin(); it != templates.constEnd(); ++it)
+      m_loader->setTemplate(it.key(), it.value());
+    m_engine.addTemplateLoader(m_loader);
+  }
+
+  /*
+    Returns the cases, which cover the same corpus as templatebenchmarks:
+    lexing small and huge templates, parsing each template, rendering each
+    page with and without bytecode, escaping and the caching loader.
+  */
+  static QStringList cases()
+  {
+    QStringList cases;
+    for (const auto &size : {"small", "huge"}) {
+      cases << QString(QStringLiteral("lex/") + QLatin1String(size));
+      cases << QString(QStringLiteral("lex/") + QLatin1String(size)
+                       + QStringLiteral("-smarttrim"));
+    }
+
+    auto templates = Corpus::templates().keys();
+    templates.sort();
+    for (const auto &name : qAsConst(templates))
+      cases << QString(QStringLiteral("parse/") + name);
+
+    const auto pages = Corpus::pages();
+    for (const auto &page : pages) {
+      for (const auto &variant : {"-10", "-100", "-10-bytecode",
+                                  "-100-bytecode"})
+        cases << QString(QStringLiteral("render/") + page
+                         + QLatin1String(variant));
+    }
+
+    cases << QStringLiteral("escape/plain") << QStringLiteral("escape/markup");
+    cases << QStringLiteral("cachingloader/hit")
+          << QStringLiteral("cachingloader/miss");
+    return cases;
+  }
+
+  /*
+    Prepares the case @p name and returns a function running one iteration
+    of it, or an empty function if the case does not exist.
+  */
+  std::function<void()> prepare(const QString &name)
+  {
+    const auto group = name.section(QLatin1Char('/'), 0, 0);
+    auto variant = name.section(QLatin1Char('/'), 1);
+
+    if (group == QLatin1String("lex")) {
+      const auto trimType = variant.endsWith(QLatin1String("-smarttrim"))
+                                ? Lexer::SmartTrim
+                                : Lexer::NoSmartTrim;
+      variant.remove(QStringLiteral("-smarttrim"));
+      if (variant != QLatin1String("small") && variant != QLatin1String("huge"))
+        return {};
+      const auto content = Corpus::generatedTemplate(
+          variant == QLatin1String("small") ? 1024 : 1024 * 1024);
+      return [content, trimType] {
+        Lexer lexer(content);
+        lexer.tokenize(trimType);
+      };
+    }
+
+    if (group == QLatin1String("parse")) {
+      if (!Corpus::templates().contains(variant))
+        return {};
+      return [this, variant] { m_engine.loadByName(variant); };
+    }
+
+    if (group == QLatin1String("render")) {
+      const auto bytecode = variant.endsWith(QLatin1String("-bytecode"));
+      variant.remove(QStringLiteral("-bytecode"));
+      const auto articles = variant.section(QLatin1Char('-'), -1).toInt();
+      const auto page = variant.section(QLatin1Char('-'), 0, -2);
+      if (!Corpus::pages().contains(page) || articles <= 0)
+        return {};
+
+      // Included templates are loaded while rendering, so bytecode stays
+      // enabled for the whole case.
+      m_engine.setBytecodeEnabled(bytecode);
+      auto t = m_engine.loadByName(page);
+      if (t->error() != NoError)
+        return {};
+      auto context = std::make_shared<Context>(Corpus::context(articles));
+      return [t, context] { t->render(context.get()); };
+    }
+
+    if (group == QLatin1String("escape")) {
+      QString input;
+      if (variant == QLatin1String("plain"))
+        input = Corpus::context(10)
+                    .value(QStringLiteral("articles"))
+                    .toList()
+                    .first()
+                    .toHash()
+                    .value(QStringLiteral("title"))
+                    .toString();
+      else if (variant == QLatin1String("markup"))
+        input = Corpus::document(20);
+      else
+        return {};
+      auto stream = std::make_shared<OutputStream>();
+      return [stream, input] { stream->escape(input); };
+    }
+
+    if (group == QLatin1String("cachingloader")) {
+      const auto hit = variant == QLatin1String("hit");
+      if (!hit && variant != QLatin1String("miss"))
+        return {};
+      auto cache = QSharedPointer<CachingLoaderDecorator>::create(m_loader);
+      m_engine.addTemplateLoader(cache);
+      const auto page = QStringLiteral("inheritance.html");
+      cache->loadByName(page, &m_engine);
+      return [this, cache, hit, page] {
+        if (!hit)
+          cache->clear();
+        cache->loadByName(page, &m_engine);
+      };
+    }
+    return {};
+  }
+
+private:
+  Engine m_engine;
+  QSharedPointer<InMemoryTemplateLoader> m_loader;
+};
+
+static int runCase(const QString &name, int iterations)
+{
+  CaseRunner runner;
+  const auto iteration = runner.prepare(name);
+  if (!iteration) {
+    QTextStream(stderr) << "Unknown case: " << name << '\n';
+    return 1;
+  }
+
+  // Warm up lazily initialized state such as plugins and caches.
+  iteration();
+
+  QVector<qint64> wallTimes;
+  wallTimes.reserve(iterations);
+
+  const auto allocationsBefore = s_allocations.load();
+#ifdef Q_OS_UNIX
+  const auto cpuBefore = cpuTimeMs();
+#endif
+
+  QElapsedTimer timer;
+  for (auto i = 0; i < iterations; ++i) {
+    timer.start();
+    iteration();
+    wallTimes.append(timer.nsecsElapsed());
+  }
+
+#ifdef Q_OS_UNIX
+  const auto cpuAfter = cpuTimeMs();
+#endif
+  const auto allocationsAfter = s_allocations.load();
+
+  std::sort(wallTimes.begin(), wallTimes.end());
+
+  QJsonObject result;
+  result.insert(s_wallTimeMetric,
+                wallTimes.at(wallTimes.size() / 2) / 1000000.0);
+#ifdef Q_OS_UNIX
+  result.insert(s_cpuTimeMetric, (cpuAfter - cpuBefore) / iterations);
+  result.insert(s_peakRssMetric, static_cast<double>(peakRssKb()));
+#endif
+#ifdef GRANTLEE_COUNT_ALLOCATIONS
+  result.insert(s_allocationsMetric,
+                static_cast<double>(allocationsAfter - allocationsBefore)
+                    / iterations);
+#else
+  Q_UNUSED(allocationsBefore)
+  Q_UNUSED(allocationsAfter)
+#endif
+
+  QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact)
+                      << '\n';
+  return 0;
+}
+
+static bool runInProcess(const QString &name, int iterations,
+                         QJsonObject *result)
+{
+  QProcess process;
+  process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  process.start(QCoreApplication::applicationFilePath(),
+                {QStringLiteral("--run-case"), name,
+                 QStringLiteral("--iterations"), QString::number(iterations)});
+  if (!process.waitForFinished(-1)
+      || process.exitStatus() != QProcess::NormalExit
+      || process.exitCode() != 0)
+    return false;
+
+  *result = QJsonDocument::fromJson(process.readAllStandardOutput()).object();
+  return !result->isEmpty();
+}
+
+static QJsonObject readResults(const QString &fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    return {};
+  return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+static bool writeResults(const QString &fileName, const QJsonObject &results)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  file.write(QJsonDocument(results).toJson());
+  return true;
+}
+
+static QString row(const QString &name, const QString &metric,
+                   const QString &baseline, const QString &current,
+                   const QString &change)
+{
+  return name.leftJustified(40) + metric.leftJustified(14)
+         + baseline.rightJustified(14) + current.rightJustified(14)
+         + change.rightJustified(10);
+}
+
+/*
+  Parses absolute thresholds given as "metric=value,metric=value".
+*/
+static QHash<QString, double> parseThresholds(const QString &value)
+{
+  QHash<QString, double> thresholds;
+  const auto items = value.split(QLatin1Char(','));
+  for (const auto &item : items) {
+    const auto metric = item.section(QLatin1Char('='), 0, 0).trimmed();
+    if (!metric.isEmpty())
+      thresholds.insert(metric, item.section(QLatin1Char('='), 1).toDouble());
+  }
+  return thresholds;
+}
+
+/*
+  Prints the metrics of each case against the baseline and returns the
+  number of regressions. A metric regresses when it exceeds its baseline by
+  more than @p threshold of the baseline plus the absolute threshold of the
+  metric in @p absoluteThresholds. The cases which have no results in the
+  baseline are appended to @p missing.
+*/
+static int compare(const QJsonObject &baseline, const QJsonObject &results,
+                   const QStringList &metrics, double threshold,
+                   const QHash<QString, double> &absoluteThresholds,
+                   QStringList *missing)
+{
+  QTextStream out(stdout);
+  const auto baselineCases = baseline.value(QStringLiteral("cases")).toObject();
+  const auto cases = results.value(QStringLiteral("cases")).toObject();
+
+  auto regressions = 0;
+  out << row(QStringLiteral("case"), QStringLiteral("metric"),
+             QStringLiteral("baseline"), QStringLiteral("current"),
+             QStringLiteral("change"))
+      << '\n';
+
+  for (auto it = cases.constBegin(); it != cases.constEnd(); ++it) {
+    const auto current = it.value().toObject();
+    const auto base = baselineCases.value(it.key()).toObject();
+    if (base.isEmpty()) {
+      out << it.key().leftJustified(40) << "no baseline\n";
+      missing->append(it.key());
+      continue;
+    }
+
+    for (const auto &metric : metrics) {
+      if (!current.contains(metric) || !base.contains(metric))
+        continue;
+      const auto baseValue = base.value(metric).toDouble();
+      const auto value = current.value(metric).toDouble();
+      const auto change = baseValue > 0 ? (value - baseValue) / baseValue : 0.0;
+      const auto regressed
+          = value - baseValue
+            > baseValue * threshold + absoluteThresholds.value(metric);
+      if (regressed)
+        ++regressions;
+
+      out << row(it.key(), metric, QString::number(baseValue, 'f', 2),
+                 QString::number(value, 'f', 2),
+                 QString::number(change * 100, 'f', 1) + QLatin1Char('%'));
+      if (regressed)
+        out << "  REGRESSION";
+      out << '\n';
+    }
+  }
+  return regressions;
+}
+
+int main(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      QStringLiteral("Runs the Grantlee benchmark corpus and compares the "
+                     "results to a baseline."));
+  parser.addHelpOption();
+
+  const QCommandLineOption iterationsOption(
+      QStringLiteral("iterations"),
+      QStringLiteral("Number of iterations of each case."), QStringLiteral("n"),
+      QStringLiteral("20"));
+  const QCommandLineOption caseOption(
+      QStringLiteral("case"),
+      QStringLiteral("Run only the case <name>. May be repeated."),
+      QStringLiteral("name"));
+  const QCommandLineOption listOption(QStringLiteral("list"),
+                                      QStringLiteral("List the cases."));
+  const QCommandLineOption outputOption(
+      QStringLiteral("output"),
+      QStringLiteral("Write the results as JSON to <file>."),
+      QStringLiteral("file"));
+  const QCommandLineOption baselineOption(
+      QStringLiteral("baseline"),
+      QStringLiteral("Compare the results to the results in <file>. Exits "
+                     "with 77 if cases have no baseline and none regressed."),
+      QStringLiteral("file"));
+  const QCommandLineOption thresholdOption(
+      QStringLiteral("threshold"),
+      QStringLiteral("Fraction by which a metric may exceed its baseline."),
+      QStringLiteral("fraction"), QStringLiteral("0.10"));
+  const QCommandLineOption absoluteThresholdOption(
+      QStringLiteral("absolute-threshold"),
+      QStringLiteral("Amount by which each metric may exceed its baseline in "
+                     "addition to the relative threshold, as "
+                     "metric=value pairs separated by commas."),
+      QStringLiteral("thresholds"),
+      QStringLiteral("wallTimeMs=0.05,cpuTimeMs=0.05,allocations=16,"
+                     "peakRssKb=1024"));
+  const QCommandLineOption metricsOption(
+      QStringLiteral("metrics"),
+      QStringLiteral("Comma separated metrics to compare."),
+      QStringLiteral("metrics"),
+      QStringList{s_wallTimeMetric, s_cpuTimeMetric, s_allocationsMetric,
+                  s_peakRssMetric}
+          .join(QLatin1Char(',')));
+  const QCommandLineOption runCaseOption(QStringLiteral("run-case"),
+                                         QStringLiteral("Internal."),
+                                         QStringLiteral("name"));
+
+  parser.addOptions({iterationsOption, caseOption, listOption, outputOption,
+                     baselineOption, thresholdOption,
+                     absoluteThresholdOption, metricsOption,
+                     runCaseOption});
+  parser.process(app);
+
+  const auto iterations = qMax(1, parser.value(iterationsOption).toInt());
+
+  if (parser.isSet(runCaseOption))
+    return runCase(parser.value(runCaseOption), iterations);
+
+  auto cases = CaseRunner::cases();
+  if (parser.isSet(listOption)) {
+    QTextStream(stdout) << cases.join(QLatin1Char('\n')) << '\n';
+    return 0;
+  }
+  if (parser.isSet(caseOption))
+    cases = parser.values(caseOption);
+
+  QJsonObject caseResults;
+  for (const auto &name : qAsConst(cases)) {
+    QJsonObject result;
+    if (!runInProcess(name, iterations, &result)) {
+      QTextStream(stderr) << "Failed to run case " << name << '\n';
+      return 1;
+    }
+    caseResults.insert(name, result);
+  }
+
+  QJsonObject results;
+  results.insert(QStringLiteral("iterations"), iterations);
+  results.insert(QStringLiteral("cases"), caseResults);
+
+  if (parser.isSet(outputOption)
+      && !writeResults(parser.value(outputOption), results)) {
+    QTextStream(stderr) << "Could not write " << parser.value(outputOption)
+                        << '\n';
+    return 1;
+  }
+
+  if (!parser.isSet(baselineOption))
+    return 0;
+
+  const auto baseline = readResults(parser.value(baselineOption));
+  if (baseline.isEmpty()) {
+    QTextStream(stdout) << "No baseline in " << parser.value(baselineOption)
+                        << ", nothing compared.\n";
+    return s_skipExitCode;
+  }
+
+  QStringList missing;
+  const auto regressions
+      = compare(baseline, results,
+                parser.value(metricsOption)
+                    .split(QLatin1Char(','),
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+                           QString::SkipEmptyParts
+#else
+                           Qt::SkipEmptyParts
+#endif
+                           ),
+                parser.value(thresholdOption).toDouble(),
+                parseThresholds(parser.value(absoluteThresholdOption)),
+                &missing);
+  if (regressions > 0) {
+    QTextStream(stdout) << regressions << " regression(s) beyond "
+                        << parser.value(thresholdOption) << " plus "
+                        << parser.value(absoluteThresholdOption) << '\n';
+    return 1;
+  }
+  if (!missing.isEmpty()) {
+    QTextStream(stdout) << missing.size()
+                        << " case(s) not compared, record them in "
+                        << parser.value(baselineOption) << '\n';
+    return s_skipExitCode;
+  }
+  return 0;
+}
@@ -0,0 +1,419 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "cachingloaderdecorator.h"
+#include "context.h"
+#include "corpus.h"
+#include "engine.h"
+#include "filterexpression.h"
+#include "grantlee_paths.h"
+#include "grantlee_version.h"
+#include "lexer_p.h"
+#include "outputstream.h"
+#include "parser.h"
+#include "template.h"
+
+using namespace Grantlee;
+
+Q_DECLARE_METATYPE(Lexer::TrimType)
+
+class TemplateBenchmarks : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void lexer_data();
+  void lexer();
+
+  void filterExpression_data();
+  void filterExpression();
+
+  void render_data();
+  void render();
+
+  void filters_data();
+  void filters();
+
+  void scriptableFilters_data();
+  void scriptableFilters();
+
+  void cachingLoader_data();
+  void cachingLoader();
+
+  void escape_data();
+  void escape();
+
+private:
+  Engine *getEngine();
+
+  Engine *m_engine;
+  QSharedPointer<InMemoryTemplateLoader> m_loader;
+};
+
+Engine *TemplateBenchmarks::getEngine()
+{
+  auto engine = new Engine(this);
+  engine->setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  return engine;
+}
+
+void TemplateBenchmarks::initTestCase()
+{
+  m_engine = getEngine();
+  m_loader = QSharedPointer<InMemoryTemplateLoader>::create();
+  const auto templates = Corpus::templates();
+  for (auto it = templates.constBegin(); it != templates.constEnd(); ++it)
+    m_loader->setTemplate(it.key(), it.value());
+  m_engine->addTemplateLoader(m_loader);
+}
+
+void TemplateBenchmarks::cleanupTestCase() { delete m_engine; }
+
+void TemplateBenchmarks::lexer_data()
+{
+  QTest::addColumn<QString>("content");
+  QTest::addColumn<Lexer::TrimType>("trimType");
+
+  const auto small = QStringLiteral(
+      "Hello {{ name|title }}, {% if messages %}you have {{ messages|length "
+      "}} messages{% else %}no messages{% endif %}. {# greeting #}");
+  const auto huge = Corpus::generatedTemplate(1024 * 1024);
+
+  QTest::newRow("small") << small << Lexer::NoSmartTrim;
+  QTest::newRow("small-smarttrim") << small << Lexer::SmartTrim;
+  QTest::newRow("huge") << huge << Lexer::NoSmartTrim;
+  QTest::newRow("huge-smarttrim") << huge << Lexer::SmartTrim;
+}
+
+void TemplateBenchmarks::lexer()
+{
+  QFETCH(QString, content);
+  QFETCH(Lexer::TrimType, trimType);
+
+  QBENCHMARK
+  {
+    Lexer lexer(content);
+    lexer.tokenize(trimType);
+  }
+}
+
+void TemplateBenchmarks::filterExpression_data()
+{
+  QTest::addColumn<QString>("expression");
+
+  QTest::newRow("variable") << QStringLiteral("article");
+  QTest::newRow("lookup") << QStringLiteral("article.author.name");
+  QTest::newRow("filter") << QStringLiteral("article.title|title");
+  QTest::newRow("filter-chain") << QStringLiteral(
+      "article.body|striptags|truncatewords:30|default:\"none\"");
+  QTest::newRow("literal") << QStringLiteral("\"some literal\"|cut:\" \"");
+}
+
+void TemplateBenchmarks::filterExpression()
+{
+  QFETCH(QString, expression);
+
+  auto t = m_engine->newTemplate(QString(), QStringLiteral("expression"));
+  Parser parser({}, t.data());
+
+  QBENCHMARK { FilterExpression fe(expression, &parser); }
+}
+
+void TemplateBenchmarks::render_data()
+{
+  QTest::addColumn<QString>("name");
+  QTest::addColumn<int>("articles");
+  QTest::addColumn<bool>("bytecode");
+
+  const auto pages = Corpus::pages();
+  for (const auto &page : pages) {
+    QTest::newRow(qPrintable(page + QStringLiteral("-10"))) << page << 10
+                                                            << false;
+    QTest::newRow(qPrintable(page + QStringLiteral("-100"))) << page << 100
+                                                             << false;
+    QTest::newRow(qPrintable(page + QStringLiteral("-10-bytecode")))
+        << page << 10 << true;
+    QTest::newRow(qPrintable(page + QStringLiteral("-100-bytecode")))
+        << page << 100 << true;
+  }
+}
+
+void TemplateBenchmarks::render()
+{
+  QFETCH(QString, name);
+  QFETCH(int, articles);
+  QFETCH(bool, bytecode);
+
+  // Included templates are loaded while rendering, so bytecode stays
+  // enabled for the whole benchmark.
+  m_engine->setBytecodeEnabled(bytecode);
+
+  auto t = m_engine->loadByName(name);
+  QCOMPARE(t->error(), NoError);
+
+  Context c(Corpus::context(articles));
+
+  QBENCHMARK { t->render(&c); }
+
+  m_engine->setBytecodeEnabled(false);
+
+  QCOMPARE(t->error(), NoError);
+}
+
+void TemplateBenchmarks::filters_data()
+{
+  QTest::addColumn<QString>("filter");
+  QTest::addColumn<QVariantList>("inputs");
+
+  const auto context = Corpus::context(50);
+  const auto articles = context.value(QStringLiteral("articles")).toList();
+
+  QVariantList text;
+  QVariantList numbers;
+  QVariantList reals;
+  QVariantList sizes;
+  QVariantList dates;
+  QVariantList lists;
+  QVariantList dictLists;
+  for (const auto &article : articles) {
+    const auto hash = article.toHash();
+    const auto id = hash.value(QStringLiteral("id")).toInt();
+    text.append(hash.value(QStringLiteral("body")));
+    numbers.append(id * 37);
+    reals.append(id * 3.14159);
+    sizes.append(qint64(id) * 123457);
+    dates.append(hash.value(QStringLiteral("published")));
+    lists.append(hash.value(QStringLiteral("tags")));
+    dictLists.append(hash.value(QStringLiteral("comments")));
+  }
+
+  QVariantList largeDictList;
+  for (auto i = 0; i < 100000; ++i) {
+    QVariantHash item;
+    item.insert(QStringLiteral("n"), (i * 7919) % 100003);
+    largeDictList.append(item);
+  }
+  const QVariantList largeDictLists{QVariant(largeDictList)};
+
+  QTest::newRow("add") << QStringLiteral("add:4") << numbers;
+  QTest::newRow("addslashes") << QStringLiteral("addslashes") << text;
+  QTest::newRow("capfirst") << QStringLiteral("capfirst") << text;
+  QTest::newRow("center") << QStringLiteral("center:80") << lists;
+  QTest::newRow("cut") << QStringLiteral("cut:\" \"") << text;
+  QTest::newRow("date") << QStringLiteral("date:\"yyyy-MM-dd\"") << dates;
+  QTest::newRow("date-names")
+      << QStringLiteral("date:\"dddd, d MMMM yyyy h:mm AP\"") << dates;
+  QTest::newRow("default") << QStringLiteral("default:\"none\"") << text;
+  QTest::newRow("default_if_none")
+      << QStringLiteral("default_if_none:\"none\"") << text;
+  QTest::newRow("dictsort")
+      << QStringLiteral("dictsort:\"author\"") << dictLists;
+  QTest::newRow("dictsort-100k")
+      << QStringLiteral("dictsort:\"n\"|length") << largeDictLists;
+  QTest::newRow("divisibleby") << QStringLiteral("divisibleby:3") << numbers;
+  QTest::newRow("escape") << QStringLiteral("escape") << text;
+  QTest::newRow("escapejs") << QStringLiteral("escapejs") << text;
+  QTest::newRow("first") << QStringLiteral("first") << lists;
+  QTest::newRow("fix_ampersands") << QStringLiteral("fix_ampersands") << text;
+  QTest::newRow("floatformat") << QStringLiteral("floatformat:2") << reals;
+  QTest::newRow("filesizeformat") << QStringLiteral("filesizeformat") << sizes;
+  QTest::newRow("force_escape") << QStringLiteral("force_escape") << text;
+  QTest::newRow("get_digit") << QStringLiteral("get_digit:2") << numbers;
+  QTest::newRow("join") << QStringLiteral("join:\", \"") << lists;
+  QTest::newRow("last") << QStringLiteral("last") << lists;
+  QTest::newRow("length") << QStringLiteral("length") << lists;
+  QTest::newRow("length_is") << QStringLiteral("length_is:4") << lists;
+  QTest::newRow("linebreaks") << QStringLiteral("linebreaks") << text;
+  QTest::newRow("linebreaksbr") << QStringLiteral("linebreaksbr") << text;
+  QTest::newRow("linenumbers") << QStringLiteral("linenumbers") << text;
+  QTest::newRow("ljust") << QStringLiteral("ljust:80") << lists;
+  QTest::newRow("lower") << QStringLiteral("lower") << text;
+  QTest::newRow("make_list") << QStringLiteral("make_list") << numbers;
+  QTest::newRow("random") << QStringLiteral("random") << lists;
+  QTest::newRow("removetags") << QStringLiteral("removetags:\"b p\"") << text;
+  QTest::newRow("rjust") << QStringLiteral("rjust:80") << lists;
+  QTest::newRow("safe") << QStringLiteral("safe") << text;
+  QTest::newRow("safeseq") << QStringLiteral("safeseq") << lists;
+  QTest::newRow("slice") << QStringLiteral("slice:\"1:3\"") << lists;
+  QTest::newRow("slugify") << QStringLiteral("slugify") << text;
+  QTest::newRow("stringformat")
+      << QStringLiteral("stringformat:\"<%1>\"") << text;
+  QTest::newRow("striptags") << QStringLiteral("striptags") << text;
+  QTest::newRow("time") << QStringLiteral("time:\"hh:mm\"") << dates;
+  QTest::newRow("timesince") << QStringLiteral("timesince") << dates;
+  QTest::newRow("timeuntil") << QStringLiteral("timeuntil") << dates;
+  QTest::newRow("title") << QStringLiteral("title") << text;
+  QTest::newRow("truncatechars") << QStringLiteral("truncatechars:40") << text;
+  QTest::newRow("truncatewords") << QStringLiteral("truncatewords:10") << text;
+  QTest::newRow("unordered_list") << QStringLiteral("unordered_list") << lists;
+  QTest::newRow("upper") << QStringLiteral("upper") << text;
+  QTest::newRow("wordcount") << QStringLiteral("wordcount") << text;
+  QTest::newRow("wordwrap") << QStringLiteral("wordwrap:20") << text;
+  QTest::newRow("yesno") << QStringLiteral("yesno:\"yes,no,maybe\"")
+                         << numbers;
+  QTest::newRow("string-chain")
+      << QStringLiteral("lower|truncatewords:5|escape") << text;
+}
+
+void TemplateBenchmarks::filters()
+{
+  QFETCH(QString, filter);
+  QFETCH(QVariantList, inputs);
+
+  auto t = m_engine->newTemplate(
+      QStringLiteral("{% for input in inputs %}{{ input|") + filter
+          + QStringLiteral(" }}{% endfor %}"),
+      filter);
+  QCOMPARE(t->error(), NoError);
+
+  QVariantHash h;
+  h.insert(QStringLiteral("inputs"), inputs);
+  Context c(h);
+
+  QBENCHMARK { t->render(&c); }
+
+  QCOMPARE(t->error(), NoError);
+}
+
+void TemplateBenchmarks::scriptableFilters_data()
+{
+  QTest::addColumn<QString>("filter");
+
+  // The input of "wrapped" is passed in a string object as before, and
+  // that of "plain" as a JavaScript string.
+  QTest::newRow("wrapped") << QStringLiteral("upper2");
+  QTest::newRow("plain") << QStringLiteral("upper3");
+}
+
+void TemplateBenchmarks::scriptableFilters()
+{
+  QFETCH(QString, filter);
+
+  QTemporaryDir pluginDir;
+  const auto libraryDir = QStringLiteral("grantlee/%1.%2")
+                              .arg(GRANTLEE_VERSION_MAJOR)
+                              .arg(GRANTLEE_VERSION_MINOR);
+  QVERIFY(QDir(pluginDir.path()).mkpath(libraryDir));
+  QFile script(pluginDir.path() + QLatin1Char('/') + libraryDir
+               + QStringLiteral("/benchmarkfilters.qs"));
+  QVERIFY(script.open(QIODevice::WriteOnly));
+  script.write(R"javascript(
+    var WrappedFilter = function(input) {
+      return input.rawString().toUpperCase();
+    };
+    WrappedFilter.filterName = "upper2";
+    Library.addFilter("WrappedFilter");
+
+    var PlainFilter = function(input) {
+      return input.toUpperCase();
+    };
+    PlainFilter.filterName = "upper3";
+    PlainFilter.plainStrings = true;
+    Library.addFilter("PlainFilter");
+  )javascript");
+  script.close();
+
+  auto engine = getEngine();
+  engine->setPluginPaths(
+      {QStringLiteral(GRANTLEE_PLUGIN_PATH), pluginDir.path()});
+  engine->addDefaultLibrary(QStringLiteral("grantlee_scriptabletags"));
+
+  auto t = engine->newTemplate(
+      QStringLiteral("{% load benchmarkfilters %}"
+                     "{% for article in articles %}{{ article.title|")
+          + filter + QStringLiteral(" }}{% endfor %}"),
+      filter);
+  if (t->error() != NoError) {
+    delete engine;
+    QSKIP("Scripted libraries are not available");
+  }
+
+  Context c(Corpus::context(100));
+
+  QBENCHMARK { t->render(&c); }
+
+  QCOMPARE(t->error(), NoError);
+  delete engine;
+}
+
+void TemplateBenchmarks::cachingLoader_data()
+{
+  QTest::addColumn<bool>("hit");
+
+  QTest::newRow("hit") << true;
+  QTest::newRow("miss") << false;
+}
+
+void TemplateBenchmarks::cachingLoader()
+{
+  QFETCH(bool, hit);
+
+  auto engine = getEngine();
+  auto cache = QSharedPointer<CachingLoaderDecorator>::create(m_loader);
+  engine->addTemplateLoader(cache);
+
+  const auto name = QStringLiteral("inheritance.html");
+  cache->loadByName(name, engine);
+  QCOMPARE(cache->size(), 1);
+
+  QBENCHMARK
+  {
+    if (!hit)
+      cache->clear();
+    cache->loadByName(name, engine);
+  }
+
+  delete engine;
+}
+
+void TemplateBenchmarks::escape_data()
+{
+  QTest::addColumn<QString>("input");
+
+  QTest::newRow("plain") << Corpus::context(10)
+                                .value(QStringLiteral("articles"))
+                                .toList()
+                                .first()
+                                .toHash()
+                                .value(QStringLiteral("title"))
+                                .toString();
+  QTest::newRow("markup") << Corpus::document(20);
+}
+
+void TemplateBenchmarks::escape()
+{
+  QFETCH(QString, input);
+
+  OutputStream stream;
+
+  QBENCHMARK { stream.escape(input); }
+}
+
+QTEST_MAIN(TemplateBenchmarks)
+#include "templatebenchmarks.moc"
@@ -0,0 +1,136 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <QtGui/QTextDocument>
+#include <QtTest/QTest>
+
+#include "concurrentmarkupexporter.h"
+#include "corpus.h"
+#include "markupdirector.h"
+#include "plaintextmarkupbuilder.h"
+#include "texthtmlbuilder.h"
+
+using namespace Grantlee;
+
+class TextDocumentBenchmarks : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+  void htmlExport_data();
+  void htmlExport();
+
+  void htmlStreamExport_data();
+  void htmlStreamExport();
+
+  void htmlConcurrentExport_data();
+  void htmlConcurrentExport();
+
+  void plainTextExport_data();
+  void plainTextExport();
+
+private:
+  void addDocumentRows();
+};
+
+void TextDocumentBenchmarks::addDocumentRows()
+{
+  QTest::addColumn<QString>("html");
+
+  QTest::newRow("small") << Corpus::document(10);
+  QTest::newRow("large") << Corpus::document(500);
+}
+
+void TextDocumentBenchmarks::htmlExport_data() { addDocumentRows(); }
+
+void TextDocumentBenchmarks::htmlExport()
+{
+  QFETCH(QString, html);
+
+  QTextDocument doc;
+  doc.setHtml(html);
+
+  QBENCHMARK
+  {
+    TextHTMLBuilder builder;
+    MarkupDirector md(&builder);
+    md.processDocument(&doc);
+    builder.getResult();
+  }
+}
+
+void TextDocumentBenchmarks::htmlStreamExport_data() { addDocumentRows(); }
+
+void TextDocumentBenchmarks::htmlStreamExport()
+{
+  QFETCH(QString, html);
+
+  QTextDocument doc;
+  doc.setHtml(html);
+
+  QBENCHMARK
+  {
+    // The chunks are discarded, as if they were sent over a network.
+    qint64 size = 0;
+    TextHTMLBuilder builder;
+    builder.setOutputFunction(
+        [&size](const QString &chunk) { size += chunk.size(); });
+    MarkupDirector md(&builder);
+    md.processDocument(&doc);
+    builder.getResult();
+  }
+}
+
+void TextDocumentBenchmarks::htmlConcurrentExport_data() { addDocumentRows(); }
+
+void TextDocumentBenchmarks::htmlConcurrentExport()
+{
+  QFETCH(QString, html);
+
+  QTextDocument doc;
+  doc.setHtml(html);
+
+  ConcurrentMarkupExporter exporter([] { return new TextHTMLBuilder(); });
+  QBENCHMARK
+  {
+    exporter.markup(&doc);
+  }
+}
+
+void TextDocumentBenchmarks::plainTextExport_data() { addDocumentRows(); }
+
+void TextDocumentBenchmarks::plainTextExport()
+{
+  QFETCH(QString, html);
+
+  QTextDocument doc;
+  doc.setHtml(html);
+
+  QBENCHMARK
+  {
+    PlainTextMarkupBuilder builder;
+    MarkupDirector md(&builder);
+    md.processDocument(&doc);
+    builder.getResult();
+  }
+}
+
+QTEST_MAIN(TextDocumentBenchmarks)
+#include "textdocumentbenchmarks.moc"
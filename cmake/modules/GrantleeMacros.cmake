@@ -17,3 +17,66 @@ macro(grantlee_adjust_plugin_name pluginname)
       )
   endforeach()
 endmacro()
+
+# Compiles template files to C++ with grantlee-compile and adds the result
+# to the sources of <target>. The generated source defines a function
+#
+#   void <name>(Grantlee::CompiledTemplateLoader *loader);
+#
+# which adds the templates to the loader. Templates are named by their path
+# relative to BASE_DIR, or by their file name. The tag libraries used by the
+# templates are loaded from the PLUGIN_PATHS while compiling.
+#
+#   grantlee_compile_templates(<target>
+#     FUNCTION <name>
+#     [BASE_DIR <dir>]
+#     [SMART_TRIM]
+#     [PLUGIN_PATHS <dir>...]
+#     [DEPENDS <target or file>...]
+#     TEMPLATES <file>...
+#   )
+function(grantlee_compile_templates target)
+  cmake_parse_arguments(_compile "SMART_TRIM" "FUNCTION;BASE_DIR"
+    "PLUGIN_PATHS;DEPENDS;TEMPLATES" ${ARGN}
+  )
+  if (NOT _compile_FUNCTION)
+    message(FATAL_ERROR "grantlee_compile_templates requires a FUNCTION name")
+  endif()
+
+  if (TARGET grantlee-compile)
+    # Within the Grantlee build the headers are not in a grantlee directory.
+    set(_compiler grantlee-compile)
+    set(_args --include-prefix=)
+  else()
+    set(_compiler Grantlee5::Compiler)
+    set(_args)
+  endif()
+
+  set(_output "${CMAKE_CURRENT_BINARY_DIR}/${_compile_FUNCTION}.cpp")
+  list(APPEND _args --output "${_output}" --function ${_compile_FUNCTION})
+  if (_compile_BASE_DIR)
+    get_filename_component(_base_dir "${_compile_BASE_DIR}" ABSOLUTE)
+    list(APPEND _args --base-dir "${_base_dir}")
+  endif()
+  if (_compile_SMART_TRIM)
+    list(APPEND _args --smart-trim)
+  endif()
+  foreach(_path ${_compile_PLUGIN_PATHS})
+    list(APPEND _args --plugin-path "${_path}")
+  endforeach()
+
+  set(_templates)
+  foreach(_template ${_compile_TEMPLATES})
+    get_filename_component(_template "${_template}" ABSOLUTE)
+    list(APPEND _templates "${_template}")
+  endforeach()
+
+  add_custom_command(
+    OUTPUT "${_output}"
+    COMMAND ${_compiler} ${_args} ${_templates}
+    DEPENDS ${_compiler} ${_templates} ${_compile_DEPENDS}
+    COMMENT "Compiling templates for ${target}"
+    VERBATIM
+  )
+  target_sources(${target} PRIVATE "${_output}")
+endfunction()
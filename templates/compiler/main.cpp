@@ -0,0 +1,158 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  grantlee-compile compiles templates into a C++ source file defining a
+  function which adds them to a CompiledTemplateLoader:
+
+    grantlee-compile --function addTemplates --base-dir templates \
+        --output templates.cpp templates/page.html templates/item.html
+*/
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QTextStream>
+
+#include "engine.h"
+#include "templatecompiler.h"
+
+using namespace Grantlee;
+
+static bool readTemplate(const QString &fileName, QString *content)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return false;
+
+  // Read the file as the FileSystemTemplateLoader does.
+  QTextStream fstream(&file);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  fstream.setCodec("UTF-8");
+#else
+  fstream.setEncoding(QStringConverter::Utf8);
+#endif
+  *content = fstream.readAll();
+  return true;
+}
+
+static bool writeIfChanged(const QString &fileName, const QByteArray &source)
+{
+  QFile file(fileName);
+  if (file.open(QIODevice::ReadOnly) && file.readAll() == source)
+    return true;
+  file.close();
+
+  // Leave the output untouched if it is unchanged, so that it is not
+  // rebuilt.
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  return file.write(source) == source.size();
+}
+
+int main(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral(
+      "Compiles Grantlee templates into C++ functions which are loaded with "
+      "a Grantlee::CompiledTemplateLoader."));
+  parser.addHelpOption();
+
+  const QCommandLineOption outputOption(
+      QStringLiteral("output"),
+      QStringLiteral("Write the generated source to <file>."),
+      QStringLiteral("file"));
+  const QCommandLineOption functionOption(
+      QStringLiteral("function"),
+      QStringLiteral("Name of the generated function which adds the "
+                     "templates to a loader."),
+      QStringLiteral("name"));
+  const QCommandLineOption baseDirOption(
+      QStringLiteral("base-dir"),
+      QStringLiteral("Name the templates by their path relative to <dir>. "
+                     "By default templates are named by their file name."),
+      QStringLiteral("dir"));
+  const QCommandLineOption pluginPathOption(
+      QStringLiteral("plugin-path"),
+      QStringLiteral("Load the tag libraries from <dir>. May be repeated."),
+      QStringLiteral("dir"));
+  const QCommandLineOption smartTrimOption(
+      QStringLiteral("smart-trim"),
+      QStringLiteral("Compile the templates with smart trimming enabled."));
+  const QCommandLineOption includePrefixOption(
+      QStringLiteral("include-prefix"),
+      QStringLiteral("Prefix of the Grantlee headers included by the "
+                     "generated source."),
+      QStringLiteral("prefix"), QStringLiteral("grantlee/"));
+
+  parser.addOptions({outputOption, functionOption, baseDirOption,
+                     pluginPathOption, smartTrimOption, includePrefixOption});
+  parser.addPositionalArgument(QStringLiteral("templates"),
+                               QStringLiteral("The template files."),
+                               QStringLiteral("templates..."));
+  parser.process(app);
+
+  QTextStream err(stderr);
+
+  const auto functionName = parser.value(functionOption);
+  static const QRegularExpression identifier(
+      QStringLiteral("^[A-Za-z_][A-Za-z0-9_]*$"));
+  if (!parser.isSet(outputOption)
+      || !identifier.match(functionName).hasMatch()) {
+    err << "The output file and a valid function name are required.\n";
+    return 1;
+  }
+
+  Engine engine;
+  if (parser.isSet(pluginPathOption))
+    engine.setPluginPaths(parser.values(pluginPathOption));
+  engine.setSmartTrimEnabled(parser.isSet(smartTrimOption));
+
+  TemplateCompiler compiler(&engine);
+
+  const QDir baseDir(parser.value(baseDirOption));
+  for (const auto &fileName : parser.positionalArguments()) {
+    const auto name = parser.isSet(baseDirOption)
+                          ? baseDir.relativeFilePath(fileName)
+                          : QFileInfo(fileName).fileName();
+    QString content;
+    if (!readTemplate(fileName, &content)) {
+      err << "Could not read " << fileName << '\n';
+      return 1;
+    }
+    if (!compiler.addTemplate(name, content)) {
+      err << fileName << ": " << compiler.errorString() << '\n';
+      return 1;
+    }
+  }
+
+  const auto source = compiler.generate(
+      functionName, parser.value(includePrefixOption));
+  if (!writeIfChanged(parser.value(outputOption), source)) {
+    err << "Could not write " << parser.value(outputOption) << '\n';
+    return 1;
+  }
+  return 0;
+}
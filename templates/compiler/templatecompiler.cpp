@@ -0,0 +1,351 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "templatecompiler.h"
+
+#include "engine.h"
+#include "exception.h"
+#include "lexer_p.h"
+#include "parser.h"
+#include "template.h"
+
+#include <QtCore/QLocale>
+#include <QtCore/QRegularExpression>
+
+using namespace Grantlee;
+
+// Tags which depend on the rest of the template, or change how it is
+// parsed.
+static const char *const s_wholeTemplateTags[] = {"extends", "block", "load"};
+
+// Text is written in pieces, because compilers limit the length of string
+// literals.
+static const int s_maxLiteralLength = 4096;
+
+static QStringList plainLookups(const QString &expression)
+{
+  // Literals, translations, Qt enums and filters are resolved by a
+  // FilterExpression.
+  static const QRegularExpression lookupExpression(QStringLiteral(
+      "^[A-Za-z][A-Za-z0-9_]*(\\.[A-Za-z0-9][A-Za-z0-9_]*)*$"));
+  if (!lookupExpression.match(expression).hasMatch())
+    return {};
+
+  auto isNumber = false;
+  QLocale::c().toDouble(expression, &isNumber);
+  if (isNumber)
+    return {};
+
+  const auto lookups = expression.split(QLatin1Char('.'));
+  if (lookups.first() == QStringLiteral("Qt"))
+    return {};
+  return lookups;
+}
+
+static QByteArray octalEscape(uchar c)
+{
+  return '\\' + QByteArray::number(c, 8).rightJustified(3, '0');
+}
+
+static QByteArray escapeAscii(uint c)
+{
+  switch (c) {
+  case '\\':
+    return "\\\\";
+  case '"':
+    return "\\\"";
+  case '?':
+    // Avoid trigraphs.
+    return "\\?";
+  case '\n':
+    return "\\n";
+  case '\r':
+    return "\\r";
+  case '\t':
+    return "\\t";
+  default:
+    if (c < 0x20 || c == 0x7f)
+      return octalEscape(c);
+    return QByteArray(1, char(c));
+  }
+}
+
+// Returns the concatenated string literals of @p text, with a literal for
+// each line. Characters outside of ASCII are written as universal character
+// names.
+static QByteArray stringLiteral(const QString &text, const QByteArray &indent)
+{
+  QByteArray result = "\"";
+  for (auto i = 0; i < text.size(); ++i) {
+    uint c = text.at(i).unicode();
+    if (QChar::isHighSurrogate(c) && i + 1 < text.size()
+        && text.at(i + 1).isLowSurrogate()) {
+      c = QChar::surrogateToUcs4(text.at(i).unicode(),
+                                 text.at(i + 1).unicode());
+      ++i;
+    } else if (QChar::isSurrogate(c)) {
+      c = QChar::ReplacementCharacter;
+    }
+
+    if (c < 0x80)
+      result += escapeAscii(c);
+    else if (c <= 0xffff)
+      result += "\\u" + QByteArray::number(c, 16).rightJustified(4, '0');
+    else
+      result += "\\U" + QByteArray::number(c, 16).rightJustified(8, '0');
+
+    if (c == '\n' && i + 1 < text.size())
+      result += "\"\n" + indent + '"';
+  }
+  return result + '"';
+}
+
+// Returns the string literal of @p text encoded in UTF-8.
+static QByteArray utf8Literal(const QString &text)
+{
+  QByteArray result = "\"";
+  const auto utf8 = text.toUtf8();
+  for (const auto c : utf8) {
+    if (uchar(c) < 0x80)
+      result += escapeAscii(uchar(c));
+    else
+      result += octalEscape(uchar(c));
+  }
+  return result + '"';
+}
+
+static QByteArray tokenType(int type)
+{
+  switch (type) {
+  case TextToken:
+    return "Grantlee::TextToken";
+  case VariableToken:
+    return "Grantlee::VariableToken";
+  case BlockToken:
+    return "Grantlee::BlockToken";
+  }
+  return "Grantlee::CommentToken";
+}
+
+TemplateCompiler::TemplateCompiler(Engine *engine) : m_engine(engine) {}
+
+QString TemplateCompiler::errorString() const { return m_errorString; }
+
+int TemplateCompiler::tagExtent(const QList<Token> &tokens, int start) const
+{
+  // A tag extends over the fewest tokens which are parsed to a single node.
+  // Only end tags can complete a tag which is not complete by itself.
+  for (auto end = start; end < tokens.size(); ++end) {
+    const auto &token = tokens.at(end);
+    if (end > start
+        && (token.tokenType != BlockToken
+            || !token.content.startsWith(QStringLiteral("end"))))
+      continue;
+
+    const auto scratch
+        = m_engine->newTemplate(QString(), QStringLiteral("grantlee-compile"));
+    try {
+      Parser p(tokens.mid(start, end - start + 1), scratch.data());
+      if (p.parse(scratch.data()).size() == 1)
+        return end - start + 1;
+    } catch (const Grantlee::Exception &) {
+    }
+  }
+  return 0;
+}
+
+bool TemplateCompiler::addTemplate(const QString &name, const QString &content)
+{
+  const auto t = m_engine->newTemplate(content, name);
+  if (t->error() != NoError) {
+    m_errorString = t->errorString();
+    return false;
+  }
+
+  Lexer lexer(content);
+  const auto tokens = lexer.tokenize(
+      m_engine->smartTrimEnabled() ? Lexer::SmartTrim : Lexer::NoSmartTrim);
+
+  CompiledTemplate compiled;
+  compiled.name = name;
+  compiled.interpreted = false;
+
+  auto nodes = 0;
+  for (auto i = 0; i < tokens.size();) {
+    const auto &token = tokens.at(i);
+
+    if (token.tokenType == TextToken) {
+      if (!compiled.segments.isEmpty()
+          && compiled.segments.last().type == Segment::Text)
+        compiled.segments.last().text += token.content;
+      else
+        compiled.segments.append({Segment::Text, token.content, {}, 0});
+      ++i;
+      continue;
+    }
+
+    if (token.tokenType == VariableToken) {
+      const auto lookups = plainLookups(token.content);
+      if (!lookups.isEmpty()) {
+        compiled.segments.append({Segment::Variable, {}, lookups, 0});
+      } else {
+        compiled.segments.append({Segment::Node, {}, {}, nodes++});
+        compiled.tokens.append(token);
+      }
+      ++i;
+      continue;
+    }
+
+    const auto command = token.content.section(QLatin1Char(' '), 0, 0);
+    for (auto tag : s_wholeTemplateTags) {
+      if (command == QLatin1String(tag))
+        compiled.interpreted = true;
+    }
+    const auto extent = compiled.interpreted ? 0 : tagExtent(tokens, i);
+    if (extent == 0) {
+      compiled.interpreted = true;
+      break;
+    }
+
+    compiled.segments.append({Segment::Node, {}, {}, nodes++});
+    compiled.tokens.append(tokens.mid(i, extent));
+    i += extent;
+  }
+
+  if (compiled.interpreted) {
+    compiled.segments.clear();
+    compiled.tokens = tokens;
+  }
+
+  m_templates.append(compiled);
+  return true;
+}
+
+QByteArray TemplateCompiler::generate(const QString &functionName,
+                                      const QString &includePrefix) const
+{
+  QByteArray source
+      = "// This file was generated by grantlee-compile. Do not edit.\n"
+        "\n"
+        "#include \""
+        + includePrefix.toUtf8()
+        + "compiledtemplate.h\"\n"
+          "\n"
+          "namespace\n"
+          "{\n";
+
+  for (auto i = 0; i < m_templates.size(); ++i) {
+    const auto &compiled = m_templates.at(i);
+    const auto index = QByteArray::number(i);
+
+    source += "\n// " + compiled.name.toUtf8() + "\n";
+
+    if (!compiled.interpreted) {
+      source += "void render" + index
+                + "(Grantlee::CompiledRenderer &r)\n"
+                  "{\n";
+      if (compiled.segments.isEmpty())
+        source += "  Q_UNUSED(r)\n";
+
+      // The properties looked up are classified once, by a key for each
+      // name.
+      QStringList keys;
+      for (const auto &segment : compiled.segments) {
+        for (auto j = 1; j < segment.lookups.size(); ++j) {
+          const auto &property = segment.lookups.at(j);
+          if (keys.contains(property))
+            continue;
+          source += "  static const Grantlee::CompiledLookupKey key"
+                    + QByteArray::number(keys.size()) + "(QStringLiteral("
+                    + stringLiteral(property, {}) + "));\n";
+          keys.append(property);
+        }
+      }
+
+      for (const auto &segment : compiled.segments) {
+        switch (segment.type) {
+        case Segment::Text:
+          for (auto pos = 0; pos < segment.text.size();
+               pos += s_maxLiteralLength) {
+            source += "  r.write(QStringLiteral(";
+            source += stringLiteral(segment.text.mid(pos, s_maxLiteralLength),
+                                    "                        ");
+            source += "));\n";
+          }
+          break;
+        case Segment::Variable: {
+          QByteArray lookup = "r.lookup(QStringLiteral("
+                              + stringLiteral(segment.lookups.first(), {})
+                              + "))";
+          for (auto j = 1; j < segment.lookups.size(); ++j)
+            lookup = "r.lookup(" + lookup + ", key"
+                     + QByteArray::number(keys.indexOf(segment.lookups.at(j)))
+                     + ")";
+          source += "  r.writeValue(" + lookup + ");\n";
+          break;
+        }
+        case Segment::Node:
+          source += "  r.renderNode(" + QByteArray::number(segment.node)
+                    + ");\n";
+          break;
+        }
+      }
+      source += "}\n";
+    }
+
+    if (!compiled.tokens.isEmpty()) {
+      source += "\nconst Grantlee::CompiledToken tokens" + index + "[] = {\n";
+      for (const auto &token : compiled.tokens)
+        source += "    {" + tokenType(token.tokenType) + ", "
+                  + QByteArray::number(token.linenumber) + ", "
+                  + utf8Literal(token.content) + "},\n";
+      source += "};\n";
+    }
+  }
+
+  const auto function = functionName.toUtf8();
+  source += "}\n"
+            "\n"
+            "void "
+            + function
+            + "(Grantlee::CompiledTemplateLoader *loader);\n"
+              "\n"
+              "void "
+            + function
+            + "(Grantlee::CompiledTemplateLoader *loader)\n"
+              "{\n";
+  for (auto i = 0; i < m_templates.size(); ++i) {
+    const auto &compiled = m_templates.at(i);
+    const auto index = QByteArray::number(i);
+    source += "  loader->addTemplate(QStringLiteral("
+              + stringLiteral(compiled.name, {}) + "),\n"
+              + "                      "
+              + (compiled.interpreted ? QByteArray("nullptr")
+                                      : QByteArray("render" + index))
+              + ", "
+              + (compiled.tokens.isEmpty() ? QByteArray("nullptr")
+                                           : QByteArray("tokens" + index))
+              + ", " + QByteArray::number(compiled.tokens.size()) + ");\n";
+  }
+  if (m_templates.isEmpty())
+    source += "  Q_UNUSED(loader)\n";
+  source += "}\n";
+  return source;
+}
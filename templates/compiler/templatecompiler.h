@@ -0,0 +1,89 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_TEMPLATECOMPILER_H
+#define GRANTLEE_TEMPLATECOMPILER_H
+
+#include "token.h"
+
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace Grantlee
+{
+class Engine;
+}
+
+/*
+  Generates the C++ source of render functions for templates.
+
+  Text and variables without filters are written directly by the generated
+  functions. Each tag at the top level of a template, with the content up
+  to its end tag, is kept as tokens which are parsed when the template is
+  loaded, and is rendered through its node. Templates which use tags
+  affecting the whole template are kept as tokens entirely.
+*/
+class TemplateCompiler
+{
+public:
+  explicit TemplateCompiler(Grantlee::Engine *engine);
+
+  /*
+    Compiles the template called @p name from @p content. Returns false and
+    sets the errorString if the template is not valid.
+  */
+  bool addTemplate(const QString &name, const QString &content);
+
+  QString errorString() const;
+
+  /*
+    Returns the source of a file which defines a function called
+    @p functionName adding the compiled templates to a
+    CompiledTemplateLoader. The Grantlee headers are included with the
+    @p includePrefix.
+  */
+  QByteArray generate(const QString &functionName,
+                      const QString &includePrefix) const;
+
+private:
+  struct Segment {
+    enum Type { Text, Variable, Node };
+
+    Type type;
+    QString text;
+    QStringList lookups;
+    int node;
+  };
+
+  struct CompiledTemplate {
+    QString name;
+    QVector<Segment> segments;
+    QList<Grantlee::Token> tokens;
+    bool interpreted;
+  };
+
+  int tagExtent(const QList<Grantlee::Token> &tokens, int start) const;
+
+  Grantlee::Engine *const m_engine;
+  QVector<CompiledTemplate> m_templates;
+  QString m_errorString;
+};
+
+#endif
@@ -20,10 +20,50 @@
 
 #include "datetime.h"
 
+#include "datetimeformat_p.h"
 #include "util.h"
 
 #include <QtCore/QDateTime>
 
+namespace
+{
+struct TimeUnit {
+  int seconds;
+  const char *singular;
+  const char *plural;
+};
+}
+
+static const TimeUnit s_timeUnits[] = {
+    {60 * 60 * 24 * 365, "year", "years"},
+    {60 * 60 * 24 * 30, "month", "months"},
+    {60 * 60 * 24 * 7, "week", "weeks"},
+    {60 * 60 * 24, "day", "days"},
+    {60 * 60, "hour", "hours"},
+    {60, "minute", "minutes"}};
+
+static const int s_timeUnitCount = sizeof(s_timeUnits) / sizeof(TimeUnit);
+
+static void appendTimeUnit(QString *result, qint64 count, const TimeUnit &unit)
+{
+  result->append(QString::number(count));
+  result->append(QLatin1Char(' '));
+  result->append(QLatin1String(count != 1 ? unit.plural : unit.singular));
+}
+
+// Formats as QDateTime::toString does, with the format parsed only once.
+static QString formatDateTime(const QDateTime &d, const QString &format)
+{
+  if (format.isEmpty())
+    return d.toString(format);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  const auto locale = QLocale::system();
+#else
+  const auto locale = QLocale::c();
+#endif
+  return cachedDateTimeFormat(locale, format).toString(d);
+}
+
 QVariant timeSince(const QDateTime &early, const QDateTime &late)
 {
   Q_ASSERT(early.isValid());
@@ -35,50 +75,23 @@ QVariant timeSince(const QDateTime &early, const QDateTime &late)
     return SafeString(QStringLiteral("0 minutes"));
 
   // TODO: i18n
-  QStringList singularNames;
-  singularNames << QStringLiteral("year") << QStringLiteral("month")
-                << QStringLiteral("week") << QStringLiteral("day")
-                << QStringLiteral("hour") << QStringLiteral("minute");
-
-  QStringList pluralNames;
-  pluralNames << QStringLiteral("years") << QStringLiteral("months")
-              << QStringLiteral("weeks") << QStringLiteral("days")
-              << QStringLiteral("hours") << QStringLiteral("minutes");
-
-  QList<int> seconds;
-  seconds << (60 * 60 * 24 * 365) // year
-          << (60 * 60 * 24 * 30)  // month
-          << (60 * 60 * 24 * 7)   // week
-          << (60 * 60 * 24)       // day
-          << (60 * 60)            // hour
-          << (60);                // minute
-
   auto count = secsSince;
   auto i = 0;
-  while (i < seconds.size()) {
-    count = (secsSince / seconds.at(i));
+  while (i < s_timeUnitCount) {
+    count = (secsSince / s_timeUnits[i].seconds);
     ++i;
     if (count != 0)
       break;
   }
   QString firstChunk;
+  appendTimeUnit(&firstChunk, count, s_timeUnits[i - 1]);
 
-  if (count != 1)
-    firstChunk.append(
-        QStringLiteral("%1 %2").arg(count).arg(pluralNames.at(i - 1)));
-  else {
-    firstChunk.append(
-        QStringLiteral("%1 %2").arg(count).arg(singularNames.at(i - 1)));
-  }
-  if (seconds.size() > i) {
-    auto count2 = (secsSince - (seconds.at(i - 1) * count)) / seconds.at(i);
+  if (s_timeUnitCount > i) {
+    auto count2 = (secsSince - (s_timeUnits[i - 1].seconds * count))
+                  / s_timeUnits[i].seconds;
     if (count2 != 0) {
-      if (count2 > 1)
-        firstChunk.append(
-            QStringLiteral(", %1 %2").arg(count2).arg(pluralNames.at(i)));
-      else
-        firstChunk.append(
-            QStringLiteral(", %1 %2").arg(count2).arg(singularNames.at(i)));
+      firstChunk.append(QStringLiteral(", "));
+      appendTimeUnit(&firstChunk, count2, s_timeUnits[i]);
     }
   }
   return firstChunk;
@@ -108,9 +121,9 @@ QVariant DateFilter::doFilter(const QVariant &input, const QVariant &argument,
   auto argString = getSafeString(argument);
 
   if (!argString.get().isEmpty())
-    return d.toString(argString);
+    return formatDateTime(d, argString);
 
-  return d.toString(QStringLiteral("MMM. d, yyyy"));
+  return formatDateTime(d, QStringLiteral("MMM. d, yyyy"));
 }
 
 QVariant TimeFilter::doFilter(const QVariant &input, const QVariant &argument,
@@ -135,7 +148,7 @@ QVariant TimeFilter::doFilter(const QVariant &input, const QVariant &argument,
   }
 
   auto argString = getSafeString(argument);
-  return d.toString(argString);
+  return formatDateTime(d, argString);
 }
 
 QVariant TimeSinceFilter::doFilter(const QVariant &input,
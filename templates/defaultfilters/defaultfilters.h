@@ -41,7 +41,8 @@ class DefaultFiltersLibrary : public QObject, public TagLibraryInterface
 {
   Q_OBJECT
   Q_INTERFACES(Grantlee::TagLibraryInterface)
-  Q_PLUGIN_METADATA(IID "org.grantlee.TagLibraryInterface")
+  Q_PLUGIN_METADATA(
+      IID "org.grantlee.TagLibraryInterface" FILE "defaultfilters.json")
 public:
   DefaultFiltersLibrary(QObject *parent = {}) : QObject(parent) {}
 
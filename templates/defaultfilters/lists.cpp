@@ -20,6 +20,7 @@
 
 #include "lists.h"
 
+#include "lookupkey_p.h"
 #include "metatype.h"
 #include "util.h"
 #include "variable.h"
@@ -28,7 +29,15 @@
 #include <QtCore/QRandomGenerator>
 #endif
 #include <QtCore/QDateTime>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
 #include <QtCore/QSequentialIterable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 QVariant JoinFilter::doFilter(const QVariant &input, const QVariant &argument,
                               bool autoescape) const
@@ -266,12 +275,106 @@ SafeString UnorderedListFilter::processList(const QVariantList &list, int tabs,
   return output.join(QChar::fromLatin1('\n'));
 }
 
+namespace
+{
+template <typename Iterator, typename LessThan>
+class SortRunnable : public QRunnable
+{
+public:
+  SortRunnable(Iterator begin, Iterator end, LessThan lessThan,
+               QSemaphore *done)
+      : m_begin(begin), m_end(end), m_lessThan(lessThan), m_done(done)
+  {
+  }
+
+  void run() override
+  {
+    std::stable_sort(m_begin, m_end, m_lessThan);
+    m_done->release();
+  }
+
+private:
+  const Iterator m_begin;
+  const Iterator m_end;
+  const LessThan m_lessThan;
+  QSemaphore *const m_done;
+};
+}
+
+// Ranges with more items than this are sorted in parts on several threads.
+static const int s_parallelSortThreshold = 8192;
+
+template <typename Iterator, typename LessThan>
+static void stableSort(Iterator begin, Iterator end, LessThan lessThan)
+{
+  const auto size = end - begin;
+  const auto parts = static_cast<int>(
+      qMin<qint64>(QThread::idealThreadCount(), size / s_parallelSortThreshold));
+  if (parts < 2) {
+    std::stable_sort(begin, end, lessThan);
+    return;
+  }
+
+  std::vector<Iterator> bounds;
+  for (auto i = 0; i <= parts; ++i)
+    bounds.push_back(begin + size * i / parts);
+
+  // The parts are sorted on free threads of the global pool, or on this
+  // thread if there are none, so that sorting never waits for a thread.
+  QSemaphore done;
+  for (auto i = 1; i < parts; ++i) {
+    auto runnable = new SortRunnable<Iterator, LessThan>(
+        bounds.at(i), bounds.at(i + 1), lessThan, &done);
+    if (!QThreadPool::globalInstance()->tryStart(runnable)) {
+      runnable->run();
+      delete runnable;
+    }
+  }
+  std::stable_sort(bounds.at(0), bounds.at(1), lessThan);
+  done.acquire(parts - 1);
+
+  // Merging the parts in order keeps the sort stable.
+  for (auto i = 1; i < parts; ++i)
+    std::inplace_merge(begin, bounds.at(i), bounds.at(i + 1), lessThan);
+}
+
+// Sorts the items by the keys extracted from them into a typed column, so
+// that the comparisons do not convert QVariants.
+template <typename T>
+static QVariantList sortedByColumn(const QVariantList &items,
+                                   const QVector<QVariant> &keys,
+                                   T (*extract)(const QVariant &))
+{
+  std::vector<std::pair<T, int>> column;
+  column.reserve(keys.size());
+  for (auto i = 0; i < keys.size(); ++i)
+    column.emplace_back(extract(keys.at(i)), i);
+
+  stableSort(column.begin(), column.end(),
+             [](const std::pair<T, int> &l, const std::pair<T, int> &r) {
+               return l.first < r.first;
+             });
+
+  QVariantList outList;
+  outList.reserve(items.size());
+  for (const auto &entry : column)
+    outList << items.at(entry.second);
+  return outList;
+}
+
+template <typename T> static T extractValue(const QVariant &v)
+{
+  return v.value<T>();
+}
+
+static QString extractString(const QVariant &v) { return getSafeString(v); }
+
 struct DictSortLessThan {
-  bool operator()(const QPair<QVariant, QVariant> &lp,
-                  const QPair<QVariant, QVariant> &rp) const
+  bool operator()(const std::pair<QVariant, int> &lp,
+                  const std::pair<QVariant, int> &rp) const
   {
-    const auto l = lp.first;
-    const auto r = rp.first;
+    const auto &l = lp.first;
+    const auto &r = rp.first;
     switch (l.userType()) {
     case QMetaType::UnknownType:
       return (r.isValid());
@@ -319,6 +422,23 @@ struct DictSortLessThan {
   }
 };
 
+// Returns the type shared by all @p keys, treating SafeString as QString, or
+// UnknownType if they differ.
+static int commonKeyType(const QVector<QVariant> &keys)
+{
+  auto type = static_cast<int>(QMetaType::UnknownType);
+  for (const auto &key : keys) {
+    auto keyType = key.userType();
+    if (keyType == qMetaTypeId<Grantlee::SafeString>())
+      keyType = QMetaType::QString;
+    if (keyType == QMetaType::UnknownType
+        || (type != QMetaType::UnknownType && keyType != type))
+      return QMetaType::UnknownType;
+    type = keyType;
+  }
+  return type;
+}
+
 QVariant DictSortFilter::doFilter(const QVariant &input,
                                   const QVariant &argument,
                                   bool autoescape) const
@@ -328,32 +448,58 @@ QVariant DictSortFilter::doFilter(const QVariant &input,
   if (!input.canConvert<QVariantList>())
     return {};
 
-  QList<QPair<QVariant, QVariant>> keyList;
+  // The key is parsed once, not for each item.
+  const Variable v(getSafeString(argument));
+  QVector<LookupKey> lookups;
+  if (v.literal().isValid()) {
+    lookups.append(LookupKey(v.literal().value<QString>()));
+  } else {
+    for (const QString &lookup : v.lookups())
+      lookups.append(LookupKey(lookup));
+  }
+
+  QVariantList items;
+  QVector<QVariant> keys;
   const auto inList = input.value<QSequentialIterable>();
   for (const QVariant &item : inList) {
     auto var = item;
+    for (const auto &key : qAsConst(lookups))
+      var = key.lookup(var);
+    items << item;
+    keys << var;
+  }
 
-    const Variable v(getSafeString(argument));
-
-    if (v.literal().isValid()) {
-      var = MetaType::lookup(var, v.literal().value<QString>());
-    } else {
-      const auto lookups = v.lookups();
-      for (const QString &lookup : lookups) {
-        var = MetaType::lookup(var, lookup);
-      }
-    }
-    keyList << qMakePair(var, item);
+  switch (commonKeyType(keys)) {
+  case QMetaType::Int:
+  case QMetaType::LongLong:
+    return sortedByColumn(items, keys, extractValue<qlonglong>);
+  case QMetaType::UInt:
+  case QMetaType::ULongLong:
+    return sortedByColumn(items, keys, extractValue<qulonglong>);
+  case QMetaType::Float:
+  case QMetaType::Double:
+    return sortedByColumn(items, keys, extractValue<double>);
+  case QMetaType::QString:
+    return sortedByColumn(items, keys, extractString);
+  case QMetaType::QDate:
+    return sortedByColumn(items, keys, extractValue<QDate>);
+  case QMetaType::QDateTime:
+    return sortedByColumn(items, keys, extractValue<QDateTime>);
+  case QMetaType::QTime:
+    return sortedByColumn(items, keys, extractValue<QTime>);
   }
 
-  DictSortLessThan lt;
-  std::stable_sort(keyList.begin(), keyList.end(), lt);
+  // Keys of mixed or other types are compared as before.
+  std::vector<std::pair<QVariant, int>> keyList;
+  keyList.reserve(keys.size());
+  for (auto i = 0; i < keys.size(); ++i)
+    keyList.emplace_back(keys.at(i), i);
+
+  stableSort(keyList.begin(), keyList.end(), DictSortLessThan());
 
   QVariantList outList;
-  auto it = keyList.constBegin();
-  const auto end = keyList.constEnd();
-  for (; it != end; ++it) {
-    outList << it->second;
-  }
+  outList.reserve(items.size());
+  for (const auto &entry : keyList)
+    outList << items.at(entry.second);
   return outList;
 }
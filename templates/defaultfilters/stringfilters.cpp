@@ -20,18 +20,19 @@
 
 #include "stringfilters.h"
 
+#include "regexcache_p.h"
 #include "util.h"
 
 #include <QtCore/QRegularExpression>
 #include <QtCore/QVariant>
 
-QVariant AddSlashesFilter::doFilter(const QVariant &input,
-                                    const QVariant &argument,
-                                    bool autoescape) const
+SafeString AddSlashesFilter::filterString(const SafeString &input,
+                                          const QVariant &argument,
+                                          bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  auto safeString = getSafeString(input);
+  auto safeString = input;
   safeString.get()
       .replace(QLatin1Char('\\'), QStringLiteral("\\\\"))
       .get()
@@ -41,19 +42,19 @@ QVariant AddSlashesFilter::doFilter(const QVariant &input,
   return safeString;
 }
 
-QVariant CapFirstFilter::doFilter(const QVariant &input,
-                                  const QVariant &argument,
-                                  bool autoescape) const
+SafeString CapFirstFilter::filterString(const SafeString &input,
+                                        const QVariant &argument,
+                                        bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  auto safeString = getSafeString(input);
+  auto safeString = input;
   if (safeString.get().isEmpty())
-    return QString();
+    return {};
 
-  return QVariant(safeString.get().at(0).toUpper()
-                  + static_cast<QString>(
-                      safeString.get().right(safeString.get().size() - 1)));
+  return QString(safeString.get().at(0).toUpper()
+                 + static_cast<QString>(
+                     safeString.get().right(safeString.get().size() - 1)));
 }
 
 EscapeJsFilter::EscapeJsFilter() = default;
@@ -92,13 +93,13 @@ static QList<QPair<QString, QString>> getJsEscapes()
   return jsEscapes;
 }
 
-QVariant EscapeJsFilter::doFilter(const QVariant &input,
-                                  const QVariant &argument,
-                                  bool autoescape) const
+SafeString EscapeJsFilter::filterString(const SafeString &input,
+                                        const QVariant &argument,
+                                        bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  QString retString = getSafeString(input);
+  QString retString = input;
 
   static const auto jsEscapes = getJsEscapes();
 
@@ -108,27 +109,30 @@ QVariant EscapeJsFilter::doFilter(const QVariant &input,
   return retString;
 }
 
-QVariant FixAmpersandsFilter::doFilter(const QVariant &input,
-                                       const QVariant &argument,
-                                       bool autoescape) const
+SafeString FixAmpersandsFilter::filterString(const SafeString &input,
+                                             const QVariant &argument,
+                                             bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  auto safeString = getSafeString(input);
+  if (!input.get().contains(QLatin1Char('&')))
+    return input;
 
-  const QRegularExpression fixAmpersandsRegexp(
-      QStringLiteral("&(?!(\\w+|#\\d+);)"));
+  static const auto fixAmpersandsRegexp
+      = cachedRegularExpression(QStringLiteral("&(?!(\\w+|#\\d+);)"));
 
+  auto safeString = input;
   safeString.get().replace(fixAmpersandsRegexp, QStringLiteral("&amp;"));
 
   return safeString;
 }
 
-QVariant CutFilter::doFilter(const QVariant &input, const QVariant &argument,
-                             bool autoescape) const
+SafeString CutFilter::filterString(const SafeString &input,
+                                   const QVariant &argument,
+                                   bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  auto retString = getSafeString(input);
+  auto retString = input;
   auto argString = getSafeString(argument);
 
   auto inputSafe = retString.isSafe();
@@ -140,20 +144,21 @@ QVariant CutFilter::doFilter(const QVariant &input, const QVariant &argument,
   return retString;
 }
 
-QVariant SafeFilter::doFilter(const QVariant &input, const QVariant &argument,
-                              bool autoescape) const
+SafeString SafeFilter::filterString(const SafeString &input,
+                                    const QVariant &argument,
+                                    bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  return markSafe(getSafeString(input));
+  return markSafe(input);
 }
 
-QVariant LineNumbersFilter::doFilter(const QVariant &input,
-                                     const QVariant &argument,
-                                     bool autoescape) const
+SafeString LineNumbersFilter::filterString(const SafeString &input,
+                                           const QVariant &argument,
+                                           bool autoescape) const
 {
   Q_UNUSED(argument)
-  auto safeString = getSafeString(input);
+  auto safeString = input;
   auto lines = safeString.get().split(QLatin1Char('\n'));
   auto width = QString::number(lines.size()).size();
 
@@ -168,12 +173,13 @@ QVariant LineNumbersFilter::doFilter(const QVariant &input,
   return markSafe(lines.join(QChar::fromLatin1('\n')));
 }
 
-QVariant LowerFilter::doFilter(const QVariant &input, const QVariant &argument,
-                               bool autoescape) const
+SafeString LowerFilter::filterString(const SafeString &input,
+                                     const QVariant &argument,
+                                     bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  return getSafeString(input).get().toLower();
+  return input.get().toLower();
 }
 
 QVariant StringFormatFilter::doFilter(const QVariant &input,
@@ -192,13 +198,14 @@ QVariant StringFormatFilter::doFilter(const QVariant &input,
                     getSafeString(input).isSafe());
 }
 
-QVariant TitleFilter::doFilter(const QVariant &input, const QVariant &argument,
-                               bool autoescape) const
+SafeString TitleFilter::filterString(const SafeString &input,
+                                     const QVariant &argument,
+                                     bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
 
-  QString str = getSafeString(input);
+  QString str = input;
 
   auto it = str.begin();
   const auto end = str.end();
@@ -215,21 +222,19 @@ QVariant TitleFilter::doFilter(const QVariant &input, const QVariant &argument,
   return str;
 }
 
-QVariant TruncateWordsFilter::doFilter(const QVariant &input,
-                                       const QVariant &argument,
-                                       bool autoescape) const
+SafeString TruncateWordsFilter::filterString(const SafeString &input,
+                                             const QVariant &argument,
+                                             bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  auto s = getSafeString(argument);
-
   bool ok;
-  auto numWords = s.get().toInt(&ok);
+  auto numWords = intArgument(argument, &ok);
 
   if (!ok) {
-    return input.value<QString>();
+    return input;
   }
 
-  QString inputString = getSafeString(input);
+  QString inputString = input;
   auto words = inputString.split(QLatin1Char(' '),
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
                                  QString::SkipEmptyParts
@@ -247,101 +252,108 @@ QVariant TruncateWordsFilter::doFilter(const QVariant &input,
   return words.join(QChar::fromLatin1(' '));
 }
 
-QVariant UpperFilter::doFilter(const QVariant &input, const QVariant &argument,
-                               bool autoescape) const
+SafeString UpperFilter::filterString(const SafeString &input,
+                                     const QVariant &argument,
+                                     bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  return getSafeString(input).get().toUpper();
+  return input.get().toUpper();
 }
 
-QVariant WordCountFilter::doFilter(const QVariant &input,
-                                   const QVariant &argument,
-                                   bool autoescape) const
+SafeString WordCountFilter::filterString(const SafeString &input,
+                                         const QVariant &argument,
+                                         bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  return QString::number(
-      getSafeString(input).get().split(QLatin1Char(' ')).size());
+  return QString::number(input.get().split(QLatin1Char(' ')).size());
 }
 
-QVariant LJustFilter::doFilter(const QVariant &input, const QVariant &argument,
-                               bool autoescape) const
+SafeString LJustFilter::filterString(const SafeString &input,
+                                     const QVariant &argument,
+                                     bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  return getSafeString(input).get().leftJustified(
-      getSafeString(argument).get().toInt());
+  return input.get().leftJustified(intArgument(argument));
 }
 
-QVariant RJustFilter::doFilter(const QVariant &input, const QVariant &argument,
-                               bool autoescape) const
+SafeString RJustFilter::filterString(const SafeString &input,
+                                     const QVariant &argument,
+                                     bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  return getSafeString(input).get().rightJustified(
-      getSafeString(argument).get().toInt());
+  return input.get().rightJustified(intArgument(argument));
 }
 
-QVariant CenterFilter::doFilter(const QVariant &input, const QVariant &argument,
-                                bool autoescape) const
+SafeString CenterFilter::filterString(const SafeString &input,
+                                      const QVariant &argument,
+                                      bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  QString value = getSafeString(input);
+  QString value = input;
   const auto valueWidth = value.size();
-  const auto width = getSafeString(argument).get().toInt();
+  const auto width = intArgument(argument);
   const auto totalPadding = width - valueWidth;
   const auto rightPadding = totalPadding >> 1;
 
   return value.leftJustified(valueWidth + rightPadding).rightJustified(width);
 }
 
-QVariant EscapeFilter::doFilter(const QVariant &input, const QVariant &argument,
-                                bool autoescape) const
+SafeString EscapeFilter::filterString(const SafeString &input,
+                                      const QVariant &argument,
+                                      bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  return markForEscaping(getSafeString(input));
+  return markForEscaping(input);
 }
 
-QVariant ForceEscapeFilter::doFilter(const QVariant &input,
-                                     const QVariant &argument,
-                                     bool autoescape) const
+SafeString ForceEscapeFilter::filterString(const SafeString &input,
+                                           const QVariant &argument,
+                                           bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  return markSafe(escape(getSafeString(input)));
+  return markSafe(escape(input));
 }
 
-QVariant RemoveTagsFilter::doFilter(const QVariant &input,
-                                    const QVariant &argument,
-                                    bool autoescape) const
+SafeString RemoveTagsFilter::filterString(const SafeString &input,
+                                          const QVariant &argument,
+                                          bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  const auto tags = getSafeString(argument).get().split(QLatin1Char(' '));
-  const auto tagRe
-      = QStringLiteral("(%1)").arg(tags.join(QChar::fromLatin1('|')));
-  const QRegularExpression startTag(
-      QStringLiteral("<%1(/?>|(\\s+[^>]*>))").arg(tagRe));
-  const QRegularExpression endTag(QStringLiteral("</%1>").arg(tagRe));
-
-  auto value = getSafeString(input);
+  auto value = input;
   const auto safeInput = value.isSafe();
-  value.get().remove(startTag);
-  value.get().remove(endTag);
+  if (value.get().contains(QLatin1Char('<'))) {
+    // The argument is usually a constant, so the patterns built from it are
+    // compiled once and then found in the cache.
+    const auto tags = stringArgument(argument).split(QLatin1Char(' '));
+    const auto tagRe
+        = QStringLiteral("(%1)").arg(tags.join(QChar::fromLatin1('|')));
+    const auto startTag = cachedRegularExpression(
+        QStringLiteral("<%1(/?>|(\\s+[^>]*>))").arg(tagRe));
+    const auto endTag
+        = cachedRegularExpression(QStringLiteral("</%1>").arg(tagRe));
+
+    value.get().remove(startTag);
+    value.get().remove(endTag);
+  }
   if (safeInput)
     return markSafe(value);
   return value;
 }
 
-QVariant StripTagsFilter::doFilter(const QVariant &input,
-                                   const QVariant &argument,
-                                   bool autoescape) const
+SafeString StripTagsFilter::filterString(const SafeString &input,
+                                         const QVariant &argument,
+                                         bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
   static QRegularExpression tagRe(QStringLiteral("<[^>]*>"),
                                   QRegularExpression::InvertedGreedinessOption);
 
-  QString value = getSafeString(input);
+  QString value = input;
   value.remove(tagRe);
   return value;
 }
@@ -425,12 +437,12 @@ QVariant SafeSequenceFilter::doFilter(const QVariant &input,
   return list;
 }
 
-QVariant LineBreaksFilter::doFilter(const QVariant &input,
-                                    const QVariant &argument,
-                                    bool autoescape) const
+SafeString LineBreaksFilter::filterString(const SafeString &input,
+                                          const QVariant &argument,
+                                          bool autoescape) const
 {
   Q_UNUSED(argument)
-  auto inputString = getSafeString(input);
+  auto inputString = input;
   static const QRegularExpression re(QStringLiteral("\n{2,}"));
   QStringList output;
 
@@ -472,21 +484,55 @@ static QString nofailStringToAscii(const QString &input)
   return output;
 }
 
-QVariant SlugifyFilter::doFilter(const QVariant &input,
-                                 const QVariant &argument,
-                                 bool autoescape) const
+static bool isAsciiWordChar(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+         || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool isAsciiSpace(char c)
+{
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Equivalent to removing "[^\w\s-]", trimming, lowering the case and
+// replacing "[-\s]+" with a hyphen, without compiling regular expressions.
+static QString asciiSlug(const QString &input)
+{
+  QString output;
+  output.reserve(input.size());
+
+  auto separator = false;
+  auto hyphen = false;
+  for (const auto &ch : input) {
+    const auto c = ch.toLatin1();
+    if (isAsciiWordChar(c)) {
+      // Whitespace at the start is trimmed, hyphens are not.
+      if (hyphen || (separator && !output.isEmpty()))
+        output.append(QLatin1Char('-'));
+      separator = hyphen = false;
+      output.append(ch.toLower());
+    } else if (c == '-') {
+      separator = hyphen = true;
+    } else if (isAsciiSpace(c)) {
+      separator = true;
+    }
+  }
+  // Whitespace at the end is trimmed, hyphens are not.
+  if (hyphen)
+    output.append(QLatin1Char('-'));
+  return output;
+}
+
+SafeString SlugifyFilter::filterString(const SafeString &input,
+                                       const QVariant &argument,
+                                       bool autoescape) const
 {
   Q_UNUSED(argument)
   Q_UNUSED(autoescape)
-  QString inputString = getSafeString(input);
+  QString inputString = input;
   inputString = inputString.normalized(QString::NormalizationForm_KD);
-  inputString = nofailStringToAscii(inputString);
-  inputString
-      = inputString.remove(QRegularExpression(QStringLiteral("[^\\w\\s-]")))
-            .trimmed()
-            .toLower();
-  return markSafe(inputString.replace(
-      QRegularExpression(QStringLiteral("[-\\s]+")), QChar::fromLatin1('-')));
+  return markSafe(asciiSlug(nofailStringToAscii(inputString)));
 }
 
 QVariant FileSizeFormatFilter::doFilter(const QVariant &input,
@@ -584,13 +630,13 @@ QVariant FileSizeFormatFilter::doFilter(const QVariant &input,
   return ret;
 }
 
-QVariant TruncateCharsFilter::doFilter(const QVariant &input,
-                                       const QVariant &argument,
-                                       bool autoescape) const
+SafeString TruncateCharsFilter::filterString(const SafeString &input,
+                                             const QVariant &argument,
+                                             bool autoescape) const
 {
   Q_UNUSED(autoescape)
-  QString retString = getSafeString(input);
-  int count = getSafeString(argument).get().toInt();
+  QString retString = input;
+  int count = intArgument(argument);
 
   if (retString.length() < count)
     return retString;
@@ -27,77 +27,85 @@
 
 using namespace Grantlee;
 
-class AddSlashesFilter : public Filter
+class AddSlashesFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class CapFirstFilter : public Filter
+class CapFirstFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class EscapeJsFilter : public Filter
+class EscapeJsFilter : public StringFilter
 {
 public:
   EscapeJsFilter();
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 
 private:
   QList<QPair<QString, QString>> m_jsEscapes;
 };
 
-class FixAmpersandsFilter : public Filter
+class FixAmpersandsFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class CutFilter : public Filter
+class CutFilter : public StringFilter
 {
 public:
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class SafeFilter : public Filter
+class SafeFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class LineNumbersFilter : public Filter
+class LineNumbersFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class LowerFilter : public Filter
+class LowerFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
 class StringFormatFilter : public Filter
@@ -109,100 +117,111 @@ public:
                     bool autoescape = {}) const override;
 };
 
-class TitleFilter : public Filter
+class TitleFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class TruncateWordsFilter : public Filter
+class TruncateWordsFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class UpperFilter : public Filter
+class UpperFilter : public StringFilter
 {
 public:
   // &amp; may be safe, but it will be changed to &AMP; which is not safe.
   bool isSafe() const override { return false; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class WordCountFilter : public Filter
+class WordCountFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class LJustFilter : public Filter
+class LJustFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class RJustFilter : public Filter
+class RJustFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class CenterFilter : public Filter
+class CenterFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class EscapeFilter : public Filter
+class EscapeFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class ForceEscapeFilter : public Filter
+class ForceEscapeFilter : public StringFilter
 {
 public:
   bool isSafe() const override { return true; }
 
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class RemoveTagsFilter : public Filter
+class RemoveTagsFilter : public StringFilter
 {
 public:
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
-class StripTagsFilter : public Filter
+class StripTagsFilter : public StringFilter
 {
 public:
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 };
 
 class WordWrapFilter : public Filter
@@ -232,11 +251,12 @@ public:
   bool isSafe() const override { return true; }
 };
 
-class LineBreaksFilter : public Filter
+class LineBreaksFilter : public StringFilter
 {
 public:
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 
   bool isSafe() const override { return true; }
 };
@@ -250,11 +270,12 @@ public:
   bool isSafe() const override { return true; }
 };
 
-class SlugifyFilter : public Filter
+class SlugifyFilter : public StringFilter
 {
 public:
-  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 
   bool isSafe() const override { return true; }
 };
@@ -269,12 +290,12 @@ public:
   bool isSafe() const override { return true; }
 };
 
-class TruncateCharsFilter : public Filter
+class TruncateCharsFilter : public StringFilter
 {
 public:
-  QVariant doFilter(const QVariant &input,
-                    const QVariant &argument = QVariant(),
-                    bool autoescape = {}) const override;
+  SafeString filterString(const SafeString &input,
+                          const QVariant &argument = {},
+                          bool autoescape = {}) const override;
 
   bool isSafe() const override { return true; }
 };
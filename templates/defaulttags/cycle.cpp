@@ -21,6 +21,7 @@
 #include "cycle.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "rendercontext.h"
 #include "util.h"
@@ -117,3 +118,9 @@ void CycleNode::render(OutputStream *stream, Context *c) const
   }
   (*stream) << value;
 }
+
+qint64 CycleNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(CycleNode) - sizeof(Node)
+         + heapSize(m_list) + heapSize(m_name);
+}
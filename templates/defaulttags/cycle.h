@@ -21,6 +21,7 @@
 #ifndef CYCLENODE_H
 #define CYCLENODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -73,7 +74,7 @@ typedef RingIterator<FilterExpression> FilterExpressionRotator;
 
 Q_DECLARE_METATYPE(FilterExpressionRotator)
 
-class CycleNode : public Node
+class CycleNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -82,6 +83,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   const QList<FilterExpression> m_list;
   FilterExpressionRotator m_variableIterator;
@@ -55,7 +55,8 @@ class DefaultTagLibrary : public QObject, public TagLibraryInterface
 {
   Q_OBJECT
   Q_INTERFACES(Grantlee::TagLibraryInterface)
-  Q_PLUGIN_METADATA(IID "org.grantlee.TagLibraryInterface")
+  Q_PLUGIN_METADATA(
+      IID "org.grantlee.TagLibraryInterface" FILE "defaulttags.json")
 public:
   DefaultTagLibrary(QObject *parent = {}) : QObject(parent) {}
 
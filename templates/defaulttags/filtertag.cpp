@@ -22,6 +22,7 @@
 
 #include "../lib/exception.h"
 #include "filterexpression.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "util.h"
 
@@ -80,3 +81,9 @@ void FilterNode::render(OutputStream *stream, Context *c) const
   m_fe.resolve(stream, c);
   c->pop();
 }
+
+qint64 FilterNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(FilterNode) - sizeof(Node)
+         + m_fe.memoryUsage() + heapSize(m_filterList);
+}
@@ -21,6 +21,7 @@
 #ifndef FILTERTAG_H
 #define FILTERTAG_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -33,7 +34,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class FilterNode : public Node
+class FilterNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -43,6 +44,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   FilterExpression m_fe;
   NodeList m_filterList;
@@ -21,6 +21,7 @@
 #include "firstof.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "util.h"
 
@@ -55,3 +56,9 @@ void FirstOfNode::render(OutputStream *stream, Context *c) const
     }
   }
 }
+
+qint64 FirstOfNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(FirstOfNode) - sizeof(Node)
+         + heapSize(m_variableList);
+}
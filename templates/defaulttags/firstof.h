@@ -21,6 +21,7 @@
 #ifndef FIRSTOFNODE_H
 #define FIRSTOFNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -33,7 +34,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class FirstOfNode : public Node
+class FirstOfNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -42,6 +43,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   QList<FilterExpression> m_variableList;
 };
@@ -21,11 +21,18 @@
 #include "for.h"
 
 #include "../lib/exception.h"
+#include "generator.h"
+#include "memoryusage_p.h"
 #include "metaenumvariable_p.h"
+#include "modelindexlookup_p.h"
 #include "parser.h"
 
+#include <QtCore/QAbstractItemModel>
 #include <QtCore/QSequentialIterable>
 
+#include <limits>
+#include <memory>
+
 ForNodeFactory::ForNodeFactory() = default;
 
 Node *ForNodeFactory::getNode(const QString &tagContent, Parser *p) const
@@ -111,27 +118,144 @@ void ForNode::setEmptyList(const NodeList &emptyList)
 static const char forloop[] = "forloop";
 static const char parentloop[] = "parentloop";
 
-void ForNode::insertLoopVariables(Context *c, int listSize, int i)
+void ForNode::insertLoopVariables(Context *c, int listSize, int i, bool last)
 {
   auto forloopHash = c->lookup(QStringLiteral("forloop")).value<QVariantHash>();
   // some magic variables injected into the context while rendering.
   forloopHash.insert(QStringLiteral("counter0"), i);
   forloopHash.insert(QStringLiteral("counter"), i + 1);
-  forloopHash.insert(QStringLiteral("revcounter"), listSize - i);
-  forloopHash.insert(QStringLiteral("revcounter0"), listSize - i - 1);
+  if (listSize < 0) {
+    // The size of generated sequences is not known in advance.
+    forloopHash.remove(QStringLiteral("revcounter"));
+    forloopHash.remove(QStringLiteral("revcounter0"));
+  } else {
+    forloopHash.insert(QStringLiteral("revcounter"), listSize - i);
+    forloopHash.insert(QStringLiteral("revcounter0"), listSize - i - 1);
+  }
   forloopHash.insert(QStringLiteral("first"), (i == 0));
-  forloopHash.insert(QStringLiteral("last"), (i == listSize - 1));
+  forloopHash.insert(QStringLiteral("last"), last);
   c->insert(QLatin1String(forloop), forloopHash);
 }
 
 void ForNode::renderLoop(OutputStream *stream, Context *c) const
 {
-  for (auto j = 0; j < m_loopNodeList.size(); j++) {
-    m_loopNodeList[j]->render(stream, c);
+  m_loopNodeList.render(stream, c);
+}
+
+void ForNode::insertItem(Context *c, const QVariant &v) const
+{
+  if (m_loopVars.size() > 1) {
+    if (v.userType() == qMetaTypeId<QVariantList>()) {
+      auto vList = v.value<QVariantList>();
+      auto varsSize = qMin(m_loopVars.size(), vList.size());
+      auto j = 0;
+      for (; j < varsSize; ++j) {
+        c->insert(m_loopVars.at(j), vList.at(j));
+      }
+      // If any of the named vars don't have an item in the context,
+      // insert an invalid object for them.
+      for (; j < m_loopVars.size(); ++j) {
+        c->insert(m_loopVars.at(j), QVariant());
+      }
+
+    } else {
+      // We don't have a hash, but we have to unpack several values
+      // from each
+      // item
+      // in the list. And each item in the list is not itself a list.
+      // Probably have a list of objects that we're taking properties
+      // from.
+      for (const QString &loopVar : m_loopVars) {
+        c->push();
+        c->insert(QStringLiteral("var"), v);
+        auto resolvedFE
+            = FilterExpression(QStringLiteral("var.") + loopVar, nullptr)
+                  .resolve(c);
+        c->pop();
+        c->insert(loopVar, resolvedFE);
+      }
+    }
+  } else {
+    c->insert(m_loopVars[0], v);
+  }
+}
+
+void ForNode::renderItem(OutputStream *stream, Context *c,
+                         const QVariant &v) const
+{
+  insertItem(c, v);
+  renderLoop(stream, c);
+}
+
+/*
+  Fetches rows of @p model until at least @p required rows are available or
+  the model can not provide more, and returns the number of available rows.
+*/
+static int fetchRows(QAbstractItemModel *model, int required)
+{
+  const QModelIndex root;
+  auto rowCount = model->rowCount(root);
+  while (rowCount < required && model->canFetchMore(root)) {
+    model->fetchMore(root);
+    const auto newRowCount = model->rowCount(root);
+    // Guard against models which claim to have more rows but do not
+    // deliver them.
+    if (newRowCount <= rowCount)
+      break;
+    rowCount = newRowCount;
   }
+  return rowCount;
 }
 
-void ForNode::render(OutputStream *stream, Context *c) const
+bool ForNode::renderModel(OutputStream *stream, Context *c,
+                          QAbstractItemModel *model) const
+{
+  const QModelIndex root;
+
+  // The role names and column headers are read once for the loop.
+  const ModelIndexLookup lookup(model);
+
+  if (m_isReversed == IsReversed) {
+    const auto rowCount = fetchRows(model, std::numeric_limits<int>::max());
+    for (auto i = 0; i < rowCount; ++i) {
+      insertLoopVariables(c, rowCount, i, i == rowCount - 1);
+      renderItem(stream, c,
+                 QVariant::fromValue(model->index(rowCount - i - 1, 0, root)));
+    }
+    return rowCount > 0;
+  }
+
+  // A model which can fetch more rows when the loop starts is iterated
+  // lazily. Its size is not known in advance, so forloop.revcounter and
+  // forloop.revcounter0 are not defined for any of its rows.
+  const auto listSize = model->canFetchMore(root) ? -1 : model->rowCount(root);
+
+  auto i = 0;
+  // Always have one row more than the current one available if possible, so
+  // that forloop.last can be determined.
+  auto rowCount = fetchRows(model, 2);
+  for (; i < rowCount; ++i) {
+    insertLoopVariables(c, listSize, i, i == rowCount - 1);
+    renderItem(stream, c, QVariant::fromValue(model->index(i, 0, root)));
+    rowCount = fetchRows(model, i + 3);
+  }
+  return i > 0;
+}
+
+bool ForNode::renderGenerator(OutputStream *stream, Context *c,
+                              AbstractGenerator *generator) const
+{
+  auto i = 0;
+  while (generator->hasNext()) {
+    const auto v = generator->next();
+    insertLoopVariables(c, -1, i, !generator->hasNext());
+    renderItem(stream, c, v);
+    ++i;
+  }
+  return i > 0;
+}
+
+void ForNode::pushLoop(Context *c)
 {
   QVariantHash forloopHash;
 
@@ -144,25 +268,63 @@ void ForNode::render(OutputStream *stream, Context *c) const
     c->insert(QLatin1String(forloop), forloopHash);
   }
 
-  auto unpack = m_loopVars.size() > 1;
-
   c->push();
+}
 
-  auto varFE = m_filterExpression.resolve(c);
+void ForNode::render(OutputStream *stream, Context *c) const
+{
+  pushLoop(c);
+  renderValue(stream, c, m_filterExpression.resolve(c));
+}
 
+void ForNode::renderValue(OutputStream *stream, Context *c,
+                          QVariant varFE) const
+{
   if (varFE.userType() == qMetaTypeId<MetaEnumVariable>()) {
     const auto mev = varFE.value<MetaEnumVariable>();
 
-    if (mev.value != -1) {
+    const auto keyCount = mev.enumerator.keyCount();
+    if (mev.value != -1 || keyCount < 1) {
       c->pop();
       return m_emptyNodeList.render(stream, c);
     }
 
-    QVariantList list;
-    for (auto row = 0; row < mev.enumerator.keyCount(); ++row) {
-      list << QVariant::fromValue(MetaEnumVariable(mev.enumerator, row));
+    for (auto i = 0; i < keyCount; ++i) {
+      const auto row = m_isReversed == IsReversed ? keyCount - i - 1 : i;
+      insertLoopVariables(c, keyCount, i, i == keyCount - 1);
+      renderItem(stream, c,
+                 QVariant::fromValue(MetaEnumVariable(mev.enumerator, row)));
+    }
+    c->pop();
+    return;
+  }
+
+  if (varFE.canConvert<QObject *>()) {
+    const auto object = varFE.value<QObject *>();
+
+    if (auto model = qobject_cast<QAbstractItemModel *>(object)) {
+      const auto rendered = renderModel(stream, c, model);
+      c->pop();
+      if (!rendered)
+        m_emptyNodeList.render(stream, c);
+      return;
+    }
+
+    if (auto generator = qobject_cast<AbstractGenerator *>(object)) {
+      generator->reset();
+      if (m_isReversed != IsReversed) {
+        const auto rendered = renderGenerator(stream, c, generator);
+        c->pop();
+        if (!rendered)
+          m_emptyNodeList.render(stream, c);
+        return;
+      }
+      // Reversing requires the complete sequence.
+      QVariantList list;
+      while (generator->hasNext())
+        list.append(generator->next());
+      varFE = list;
     }
-    varFE = list;
   }
 
   if (!varFE.canConvert<QVariantList>()) {
@@ -183,45 +345,101 @@ void ForNode::render(OutputStream *stream, Context *c) const
   for (auto it = m_isReversed == IsReversed ? iter.end() - 1 : iter.begin();
        m_isReversed == IsReversed ? it != iter.begin() - 1 : it != iter.end();
        m_isReversed == IsReversed ? --it : ++it) {
-    const auto v = *it;
-    insertLoopVariables(c, listSize, i);
-
-    if (unpack) {
-      if (v.userType() == qMetaTypeId<QVariantList>()) {
-        auto vList = v.value<QVariantList>();
-        auto varsSize = qMin(m_loopVars.size(), vList.size());
-        auto j = 0;
-        for (; j < varsSize; ++j) {
-          c->insert(m_loopVars.at(j), vList.at(j));
-        }
-        // If any of the named vars don't have an item in the context,
-        // insert an invalid object for them.
-        for (; j < m_loopVars.size(); ++j) {
-          c->insert(m_loopVars.at(j), QVariant());
-        }
-
-      } else {
-        // We don't have a hash, but we have to unpack several values
-        // from each
-        // item
-        // in the list. And each item in the list is not itself a list.
-        // Probably have a list of objects that we're taking properties
-        // from.
-        for (const QString &loopVar : m_loopVars) {
-          c->push();
-          c->insert(QStringLiteral("var"), v);
-          auto resolvedFE
-              = FilterExpression(QStringLiteral("var.") + loopVar, nullptr)
-                    .resolve(c);
-          c->pop();
-          c->insert(loopVar, resolvedFE);
-        }
-      }
-    } else {
-      c->insert(m_loopVars[0], v);
-    }
-    renderLoop(stream, c);
+    insertLoopVariables(c, listSize, i, i == listSize - 1);
+    renderItem(stream, c, *it);
     ++i;
   }
   c->pop();
 }
+
+qint64 ForNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(ForNode) - sizeof(Node)
+         + heapSize(m_loopVars) + m_filterExpression.memoryUsage()
+         + heapSize(m_loopNodeList) + heapSize(m_emptyNodeList);
+}
+
+/*
+  Iterates a list for a RenderProgram, as ForNode::renderValue does.
+*/
+class ForLoopIteration : public RenderLoopIteration
+{
+public:
+  ForLoopIteration(const ForNode *node, const QVariant &list)
+      : m_node(node), m_list(list),
+        m_iterable(m_list.value<QSequentialIterable>()),
+        m_size(m_iterable.size()), m_index(0),
+        m_isReversed(node->m_isReversed == ForNode::IsReversed),
+        m_it(m_isReversed && m_size > 0 ? m_iterable.end() - 1
+                                        : m_iterable.begin())
+  {
+  }
+
+  bool isEmpty() const { return m_size < 1; }
+
+  bool next(Context *c) override
+  {
+    if (m_index == m_size) {
+      c->pop();
+      return false;
+    }
+    if (m_index > 0) {
+      if (m_isReversed)
+        --m_it;
+      else
+        ++m_it;
+    }
+    ForNode::insertLoopVariables(c, m_size, m_index, m_index == m_size - 1);
+    m_node->insertItem(c, *m_it);
+    ++m_index;
+    return true;
+  }
+
+private:
+  const ForNode *const m_node;
+  const QVariant m_list;
+  const QSequentialIterable m_iterable;
+  const int m_size;
+  int m_index;
+  const bool m_isReversed;
+  QSequentialIterable::const_iterator m_it;
+};
+
+bool ForNode::compile(RenderProgram *program) const
+{
+  program->appendLoop(this, m_loopNodeList, m_emptyNodeList);
+  return true;
+}
+
+RenderLoopIteration *ForNode::begin(OutputStream *stream, Context *c,
+                                    bool *rendered) const
+{
+  pushLoop(c);
+  const auto varFE = m_filterExpression.resolve(c);
+
+  // Enumerators, models and generators are iterated by the node.
+  auto iteratedByNode = varFE.userType() == qMetaTypeId<MetaEnumVariable>();
+  if (!iteratedByNode && varFE.canConvert<QObject *>()) {
+    const auto object = varFE.value<QObject *>();
+    iteratedByNode = qobject_cast<QAbstractItemModel *>(object)
+                     || qobject_cast<AbstractGenerator *>(object);
+  }
+  if (iteratedByNode) {
+    renderValue(stream, c, varFE);
+    *rendered = true;
+    return nullptr;
+  }
+
+  if (!varFE.canConvert<QVariantList>()) {
+    c->pop();
+    return nullptr;
+  }
+
+  std::unique_ptr<ForLoopIteration> iteration(
+      new ForLoopIteration(this, varFE));
+  if (iteration->isEmpty()) {
+    c->pop();
+    return nullptr;
+  }
+  return iteration.release();
+}
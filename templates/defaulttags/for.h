@@ -21,7 +21,16 @@
 #ifndef FORNODE_H
 #define FORNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
+#include "renderprogram_p.h"
+
+class QAbstractItemModel;
+
+namespace Grantlee
+{
+class AbstractGenerator;
+}
 
 using namespace Grantlee;
 
@@ -34,7 +43,10 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class ForNode : public Node
+class ForNode : public Node,
+                public RenderLoop,
+                public NodeMemoryUsage,
+                public CompilableNode
 {
   Q_OBJECT
 public:
@@ -48,9 +60,26 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
+  RenderLoopIteration *begin(OutputStream *stream, Context *c,
+                             bool *rendered) const override;
+
 private:
-  static void insertLoopVariables(Context *c, int listSize, int i);
+  friend class ForLoopIteration;
+
+  static void pushLoop(Context *c);
+  static void insertLoopVariables(Context *c, int listSize, int i, bool last);
+  void renderValue(OutputStream *stream, Context *c, QVariant varFE) const;
   void renderLoop(OutputStream *stream, Context *c) const;
+  void insertItem(Context *c, const QVariant &v) const;
+  void renderItem(OutputStream *stream, Context *c, const QVariant &v) const;
+  bool renderModel(OutputStream *stream, Context *c,
+                   QAbstractItemModel *model) const;
+  bool renderGenerator(OutputStream *stream, Context *c,
+                       AbstractGenerator *generator) const;
 
   QStringList m_loopVars;
   FilterExpression m_filterExpression;
@@ -23,6 +23,7 @@
 
 #include "../lib/exception.h"
 #include "parser.h"
+#include "renderprogram_p.h"
 
 IfNodeFactory::IfNodeFactory() = default;
 
@@ -101,3 +102,35 @@ void IfNode::render(OutputStream *stream, Context *c) const
     }
   }
 }
+
+qint64 IfNode::memoryUsage() const
+{
+  auto size = nodeSize() + sizeof(IfNode) - sizeof(Node)
+              + heapSize(mConditionNodelists);
+  for (const auto &pair : mConditionNodelists) {
+    if (pair.first)
+      size += pair.first->memoryUsage();
+    size += heapSize(pair.second);
+  }
+  return size;
+}
+
+bool IfNode::compile(RenderProgram *program) const
+{
+  QVector<QPair<RenderProgram::Condition, NodeList>> branches;
+  for (const auto &pair : mConditionNodelists) {
+    RenderProgram::Condition condition;
+    if (const auto token = pair.first) {
+      condition = [token](Context *c) -> bool {
+        try {
+          return Grantlee::variantIsTrue(token->evaluate(c));
+        } catch (const Grantlee::Exception &) {
+          return false;
+        }
+      };
+    }
+    branches.append(qMakePair(condition, pair.second));
+  }
+  program->appendBranches(branches);
+  return true;
+}
@@ -21,7 +21,9 @@
 #ifndef IFNODE_H
 #define IFNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
+#include "renderprogram_p.h"
 
 #include <QtCore/QSharedPointer>
 
@@ -38,7 +40,9 @@ public:
 
 class IfToken;
 
-class IfNode : public Node
+class IfNode : public Node,
+               public NodeMemoryUsage,
+               public CompilableNode
 {
   Q_OBJECT
 public:
@@ -50,6 +54,10 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
 private:
   QVector<QPair<QSharedPointer<IfToken>, NodeList>> mConditionNodelists;
 };
@@ -27,6 +27,7 @@
 
 #include "../lib/exception.h"
 #include "filterexpression.h"
+#include "memoryusage_p.h"
 #include "node.h"
 #include "util.h"
 
@@ -144,6 +145,8 @@ public:
 
   QVariant evaluate(Grantlee::Context *c) const;
 
+  qint64 memoryUsage() const;
+
   int lbp() const { return mLbp; }
 
   int mLbp;
@@ -176,6 +179,19 @@ void IfToken::nud(IfParser *parser)
           .arg(mTokenName));
 }
 
+qint64 IfToken::memoryUsage() const
+{
+  // The object and the control block of the QSharedPointer are allocated
+  // together.
+  auto size = qint64(sizeof(IfToken)) + 2 * sizeof(void *)
+              + Grantlee::heapSize(mTokenName) + mFe.memoryUsage();
+  if (mArgs.first)
+    size += mArgs.first->memoryUsage();
+  if (mArgs.second)
+    size += mArgs.second->memoryUsage();
+  return size;
+}
+
 void IfToken::led(QSharedPointer<IfToken> left, IfParser *parser)
 {
   switch (mOpCode) {
@@ -20,6 +20,7 @@
 
 #include "ifchanged.h"
 
+#include "memoryusage_p.h"
 #include "parser.h"
 
 #include <QtCore/QDateTime>
@@ -128,3 +129,10 @@ void IfChangedNode::render(OutputStream *stream, Context *c) const
     m_falseList.render(stream, c);
   }
 }
+
+qint64 IfChangedNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(IfChangedNode) - sizeof(Node)
+         + heapSize(m_trueList) + heapSize(m_falseList)
+         + heapSize(m_filterExpressions) + heapSize(m_id);
+}
@@ -21,6 +21,7 @@
 #ifndef IFCHANGEDNODE_H
 #define IFCHANGEDNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -34,7 +35,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class IfChangedNode : public Node
+class IfChangedNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -46,6 +47,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   NodeList m_trueList;
   NodeList m_falseList;
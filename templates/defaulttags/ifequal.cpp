@@ -21,6 +21,7 @@
 #include "ifequal.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "util.h"
 
@@ -100,3 +101,10 @@ void IfEqualNode::render(OutputStream *stream, Context *c) const
   else
     m_falseList.render(stream, c);
 }
+
+qint64 IfEqualNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(IfEqualNode) - sizeof(Node)
+         + m_var1.memoryUsage() + m_var2.memoryUsage()
+         + heapSize(m_trueList) + heapSize(m_falseList);
+}
@@ -21,6 +21,7 @@
 #ifndef IFEQUALNODE_H
 #define IFEQUALNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -46,7 +47,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class IfEqualNode : public Node
+class IfEqualNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -58,6 +59,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   FilterExpression m_var1;
   FilterExpression m_var2;
@@ -22,6 +22,7 @@
 
 #include "engine.h"
 #include "exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "util.h"
 
@@ -72,3 +73,9 @@ void MediaFinderNode::render(OutputStream *stream, Context *c) const
     }
   }
 }
+
+qint64 MediaFinderNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(MediaFinderNode) - sizeof(Node)
+         + heapSize(m_mediaExpressionList);
+}
@@ -21,6 +21,7 @@
 #ifndef MEDIAFINDER_H
 #define MEDIAFINDER_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -33,7 +34,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class MediaFinderNode : public Node
+class MediaFinderNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -42,6 +43,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   QList<FilterExpression> m_mediaExpressionList;
 };
@@ -21,6 +21,7 @@
 #include "now.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 
 #include <QtCore/QDateTime>
@@ -57,3 +58,9 @@ void NowNode::render(OutputStream *stream, Context *c) const
   Q_UNUSED(c)
   (*stream) << QDateTime::currentDateTime().toString(m_formatString);
 }
+
+qint64 NowNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(NowNode) - sizeof(Node)
+         + heapSize(m_formatString);
+}
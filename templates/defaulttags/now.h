@@ -21,6 +21,7 @@
 #ifndef NOWNODE_H
 #define NOWNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -34,7 +35,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class NowNode : public Node
+class NowNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -42,6 +43,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   QString m_formatString;
 };
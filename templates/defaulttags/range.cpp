@@ -22,6 +22,7 @@
 
 #include "engine.h"
 #include "exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "util.h"
 
@@ -126,3 +127,11 @@ void RangeNode::render(OutputStream *stream, Context *c) const
       c->pop();
   }
 }
+
+qint64 RangeNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(RangeNode) - sizeof(Node)
+         + heapSize(m_list) + heapSize(m_name)
+         + m_startExpression.memoryUsage() + m_stopExpression.memoryUsage()
+         + m_stepExpression.memoryUsage();
+}
@@ -21,6 +21,7 @@
 #ifndef RANGE_H
 #define RANGE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -33,7 +34,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class RangeNode : public Node
+class RangeNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -47,6 +48,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   NodeList m_list;
   QString m_name;
@@ -21,6 +21,7 @@
 #include "regroup.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "util.h"
 
@@ -124,3 +125,10 @@ void RegroupNode::render(OutputStream *stream, Context *c) const
   }
   c->insert(m_varName, contextList);
 }
+
+qint64 RegroupNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(RegroupNode) - sizeof(Node)
+         + m_target.memoryUsage() + m_expression.memoryUsage()
+         + heapSize(m_varName);
+}
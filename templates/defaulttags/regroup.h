@@ -21,6 +21,7 @@
 #ifndef REGROUPNODE_H
 #define REGROUPNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 
 using namespace Grantlee;
@@ -34,7 +35,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class RegroupNode : public Node
+class RegroupNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -44,6 +45,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   FilterExpression m_target;
   FilterExpression m_expression;
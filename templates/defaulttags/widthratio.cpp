@@ -21,6 +21,7 @@
 #include "widthratio.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 
 WidthRatioNodeFactory::WidthRatioNodeFactory() = default;
@@ -81,3 +82,10 @@ void WidthRatioNode::render(OutputStream *stream, Context *c) const
   // TODO put integral streamers in OutputStream?
   (*stream) << QString::number(result);
 }
+
+qint64 WidthRatioNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(WidthRatioNode) - sizeof(Node)
+         + m_valExpr.memoryUsage() + m_maxExpr.memoryUsage()
+         + m_maxWidth.memoryUsage();
+}
@@ -21,7 +21,9 @@
 #include "with.h"
 
 #include "../lib/exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
+#include "renderprogram_p.h"
 
 WithNodeFactory::WithNodeFactory() = default;
 
@@ -81,3 +83,19 @@ void WithNode::render(OutputStream *stream, Context *c) const
   m_list.render(stream, c);
   c->pop();
 }
+
+qint64 WithNode::memoryUsage() const
+{
+  auto size = nodeSize() + sizeof(WithNode) - sizeof(Node)
+              + heapSize(m_list);
+  for (const auto &namedExpression : m_namedExpressions)
+    size += sizeof(namedExpression) + heapSize(namedExpression.first)
+            + namedExpression.second.memoryUsage();
+  return size;
+}
+
+bool WithNode::compile(RenderProgram *program) const
+{
+  program->appendVariables(m_namedExpressions, m_list);
+  return true;
+}
@@ -21,7 +21,9 @@
 #ifndef WITHNODE_H
 #define WITHNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
+#include "renderprogram_p.h"
 
 using namespace Grantlee;
 
@@ -34,7 +36,9 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class WithNode : public Node
+class WithNode : public Node,
+                 public NodeMemoryUsage,
+                 public CompilableNode
 {
   Q_OBJECT
 public:
@@ -46,6 +50,10 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
 private:
   std::vector<std::pair<QString, FilterExpression>> m_namedExpressions;
   NodeList m_list;
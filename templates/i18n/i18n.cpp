@@ -26,6 +26,7 @@
 #include "engine.h"
 #include "exception.h"
 #include "parser.h"
+#include "renderprogram_p.h"
 #include "template.h"
 
 #include <QtCore/QDebug>
@@ -109,16 +110,39 @@ I18nNode::I18nNode(const QString &sourceText,
 {
 }
 
-void I18nNode::render(OutputStream *stream, Context *c) const
+bool I18nNode::isConstantArgumentList(const QList<FilterExpression> &feList)
+{
+  for (const FilterExpression &fe : feList) {
+    if (!fe.variable().isConstant() || !fe.filters().isEmpty())
+      return false;
+  }
+  return true;
+}
+
+QString I18nNode::localize(Context *c) const
 {
   QVariantList args;
   for (const FilterExpression &fe : m_filterExpressionList)
     args.append(fe.resolve(c));
-  const auto resultString = c->localizer()->localizeString(m_sourceText, args);
+  return c->localizer()->localizeString(m_sourceText, args);
+}
+
+void I18nNode::render(OutputStream *stream, Context *c) const
+{
+  const auto resultString = localize(c);
 
   streamValueInContext(stream, resultString, c);
 }
 
+bool I18nNode::compile(RenderProgram *program) const
+{
+  if (!isConstantArgumentList(m_filterExpressionList))
+    return false;
+  program->appendLocalizedText(this,
+                               [this](Context *c) { return localize(c); });
+  return true;
+}
+
 I18nVarNode::I18nVarNode(const QString &sourceText,
                          const QList<Grantlee::FilterExpression> &feList,
                          const QString &resultName, QObject *parent)
@@ -22,6 +22,7 @@
 #define I18NNODE_H
 
 #include "node.h"
+#include "renderprogram_p.h"
 
 namespace Grantlee
 {
@@ -48,15 +49,24 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class I18nNode : public Node
+class I18nNode : public Node, public CompilableNode
 {
   Q_OBJECT
 public:
   I18nNode(const QString &sourceText, const QList<FilterExpression> &feList,
            QObject *parent = {});
   void render(OutputStream *stream, Context *c) const override;
+  bool compile(RenderProgram *program) const override;
+
+  /**
+    Returns whether all of @p feList are constants without filters, so that
+    localizing text with them as arguments only depends on the locale.
+  */
+  static bool isConstantArgumentList(const QList<FilterExpression> &feList);
 
 private:
+  QString localize(Context *c) const;
+
   QString m_sourceText;
   QList<FilterExpression> m_filterExpressionList;
 };
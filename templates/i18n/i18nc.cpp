@@ -20,12 +20,15 @@
 
 #include "i18nc.h"
 
+#include "i18n.h"
+
 #include <QtCore/QStringList>
 
 #include "abstractlocalizer.h"
 #include "engine.h"
 #include "exception.h"
 #include "parser.h"
+#include "renderprogram_p.h"
 #include "template.h"
 
 #include <QtCore/QDebug>
@@ -133,17 +136,30 @@ I18ncNode::I18ncNode(const QString &sourceText, const QString &context,
 {
 }
 
-void I18ncNode::render(OutputStream *stream, Context *c) const
+QString I18ncNode::localize(Context *c) const
 {
   QVariantList args;
   for (const FilterExpression &fe : m_filterExpressionList)
     args.append(fe.resolve(c));
-  auto resultString
-      = c->localizer()->localizeContextString(m_sourceText, m_context, args);
+  return c->localizer()->localizeContextString(m_sourceText, m_context, args);
+}
+
+void I18ncNode::render(OutputStream *stream, Context *c) const
+{
+  auto resultString = localize(c);
 
   streamValueInContext(stream, resultString, c);
 }
 
+bool I18ncNode::compile(RenderProgram *program) const
+{
+  if (!I18nNode::isConstantArgumentList(m_filterExpressionList))
+    return false;
+  program->appendLocalizedText(this,
+                               [this](Context *c) { return localize(c); });
+  return true;
+}
+
 I18ncVarNode::I18ncVarNode(const QString &sourceText, const QString &context,
                            const QList<Grantlee::FilterExpression> &feList,
                            const QString &resultName, QObject *parent)
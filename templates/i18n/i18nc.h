@@ -22,6 +22,7 @@
 #define I18NCNODE_H
 
 #include "node.h"
+#include "renderprogram_p.h"
 
 namespace Grantlee
 {
@@ -48,15 +49,18 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class I18ncNode : public Node
+class I18ncNode : public Node, public CompilableNode
 {
   Q_OBJECT
 public:
   I18ncNode(const QString &sourceText, const QString &context,
             const QList<FilterExpression> &feList, QObject *parent = {});
   void render(OutputStream *stream, Context *c) const override;
+  bool compile(RenderProgram *program) const override;
 
 private:
+  QString localize(Context *c) const;
+
   QString m_sourceText;
   QString m_context;
   QList<FilterExpression> m_filterExpressionList;
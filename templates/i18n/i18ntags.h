@@ -42,7 +42,8 @@ class I18nTagLibrary : public QObject, public TagLibraryInterface
 {
   Q_OBJECT
   Q_INTERFACES(Grantlee::TagLibraryInterface)
-  Q_PLUGIN_METADATA(IID "org.grantlee.TagLibraryInterface")
+  Q_PLUGIN_METADATA(
+      IID "org.grantlee.TagLibraryInterface" FILE "i18ntags.json")
 public:
   I18nTagLibrary() {}
 
@@ -20,6 +20,10 @@
 
 #include "cachingloaderdecorator.h"
 
+#include "enginemetrics_p.h"
+
+#include <QtCore/QMap>
+
 namespace Grantlee
 {
 
@@ -32,17 +36,54 @@ public:
   {
   }
 
+  struct CacheEntry {
+    Template t;
+    qint64 memoryUsage;
+    quint64 lastUsed;
+  };
+
+  // Removes the least recently used Templates until the cache fits in the
+  // budget, keeping at least the Template called @p name.
+  void evict(const QString &name) const;
+
   Q_DECLARE_PUBLIC(CachingLoaderDecorator)
   CachingLoaderDecorator *const q_ptr;
 
   const QSharedPointer<AbstractTemplateLoader> m_wrappedLoader;
 
-  mutable QHash<QString, Template> m_cache;
+  mutable QHash<QString, CacheEntry> m_cache;
+  // The names of the cached Templates from the least to the most recently
+  // used, by the lastUsed of their entry.
+  mutable QMap<quint64, QString> m_recency;
+  mutable quint64 m_lastUsed = 0;
+  mutable qint64 m_memoryUsage = 0;
+  qint64 m_memoryBudget = 0;
+
+  mutable MetricCounter m_hits;
+  mutable MetricCounter m_misses;
+  mutable MetricCounter m_evictions;
 };
 }
 
 using namespace Grantlee;
 
+void CachingLoaderDecoratorPrivate::evict(const QString &name) const
+{
+  auto oldest = m_recency.begin();
+  while (m_memoryBudget > 0 && m_memoryUsage > m_memoryBudget
+         && m_cache.size() > 1) {
+    if (oldest.value() == name) {
+      ++oldest;
+      continue;
+    }
+    const auto it = m_cache.find(oldest.value());
+    m_memoryUsage -= it.value().memoryUsage;
+    m_cache.erase(it);
+    oldest = m_recency.erase(oldest);
+    m_evictions.add();
+  }
+}
+
 CachingLoaderDecorator::CachingLoaderDecorator(
     QSharedPointer<AbstractTemplateLoader> loader)
     : d_ptr(new CachingLoaderDecoratorPrivate(loader, this))
@@ -60,6 +101,9 @@ bool CachingLoaderDecorator::canLoadTemplate(const QString &name) const
 void CachingLoaderDecorator::clear()
 {
   Q_D(CachingLoaderDecorator);
+  d->m_evictions.add(d->m_cache.size());
+  d->m_memoryUsage = 0;
+  d->m_recency.clear();
   return d->m_cache.clear();
 }
 
@@ -75,6 +119,52 @@ bool CachingLoaderDecorator::isEmpty() const
   return d->m_cache.isEmpty();
 }
 
+qint64 CachingLoaderDecorator::hits() const
+{
+  Q_D(const CachingLoaderDecorator);
+  return d->m_hits.value();
+}
+
+qint64 CachingLoaderDecorator::misses() const
+{
+  Q_D(const CachingLoaderDecorator);
+  return d->m_misses.value();
+}
+
+qint64 CachingLoaderDecorator::evictions() const
+{
+  Q_D(const CachingLoaderDecorator);
+  return d->m_evictions.value();
+}
+
+void CachingLoaderDecorator::setMemoryBudget(qint64 bytes)
+{
+  Q_D(CachingLoaderDecorator);
+  d->m_memoryBudget = bytes;
+  d->evict({});
+}
+
+qint64 CachingLoaderDecorator::memoryBudget() const
+{
+  Q_D(const CachingLoaderDecorator);
+  return d->m_memoryBudget;
+}
+
+qint64 CachingLoaderDecorator::memoryUsage() const
+{
+  Q_D(const CachingLoaderDecorator);
+  return d->m_memoryUsage;
+}
+
+QHash<QString, qint64> CachingLoaderDecorator::memoryReport() const
+{
+  Q_D(const CachingLoaderDecorator);
+  QHash<QString, qint64> report;
+  for (auto it = d->m_cache.constBegin(); it != d->m_cache.constEnd(); ++it)
+    report.insert(it.key(), it.value().memoryUsage);
+  return report;
+}
+
 QPair<QString, QString>
 CachingLoaderDecorator::getMediaUri(const QString &fileName) const
 {
@@ -87,14 +177,23 @@ CachingLoaderDecorator::loadByName(const QString &name,
                                    const Grantlee::Engine *engine) const
 {
   Q_D(const CachingLoaderDecorator);
-  const auto it = d->m_cache.constFind(name);
-  if (it != d->m_cache.constEnd()) {
-    return it.value();
+  const auto it = d->m_cache.find(name);
+  if (it != d->m_cache.end()) {
+    d->m_hits.add();
+    d->m_recency.remove(it.value().lastUsed);
+    it.value().lastUsed = ++d->m_lastUsed;
+    d->m_recency.insert(it.value().lastUsed, name);
+    return it.value().t;
   }
+  d->m_misses.add();
 
   const auto t = d->m_wrappedLoader->loadByName(name, engine);
 
-  d->m_cache.insert(name, t);
+  const auto memoryUsage = t ? t->memoryUsage() : 0;
+  d->m_cache.insert(name, {t, memoryUsage, ++d->m_lastUsed});
+  d->m_recency.insert(d->m_lastUsed, name);
+  d->m_memoryUsage += memoryUsage;
+  d->evict(name);
 
   return t;
 }
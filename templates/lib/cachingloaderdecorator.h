@@ -25,6 +25,8 @@
 
 #include "grantlee_templates_export.h"
 
+#include <QtCore/QHash>
+
 namespace Grantlee
 {
 
@@ -103,6 +105,51 @@ public:
    */
   bool isEmpty() const;
 
+  /**
+    Returns the number of Template objects returned from the cache.
+   */
+  qint64 hits() const;
+
+  /**
+    Returns the number of Template objects which were not found in the cache
+    and were loaded by the decorated loader.
+   */
+  qint64 misses() const;
+
+  /**
+    Returns the number of Template objects removed from the cache by
+    @ref clear or to keep the cache within the @ref memoryBudget.
+   */
+  qint64 evictions() const;
+
+  /**
+    Sets the estimated number of bytes the cached Template objects may
+    retain. When a newly loaded Template exceeds the budget, the least
+    recently used Templates are removed from the cache.
+
+    The default budget of 0 does not limit the cache.
+
+    @see Template::memoryUsage
+   */
+  void setMemoryBudget(qint64 bytes);
+
+  /**
+    Returns the memory budget of the cache.
+   */
+  qint64 memoryBudget() const;
+
+  /**
+    Returns the estimated number of bytes retained by the cached Template
+    objects.
+   */
+  qint64 memoryUsage() const;
+
+  /**
+    Returns the estimated number of bytes retained by each cached Template,
+    keyed by the name of the Template.
+   */
+  QHash<QString, qint64> memoryReport() const;
+
 private:
   Q_DECLARE_PRIVATE(CachingLoaderDecorator)
   CachingLoaderDecoratorPrivate *const d_ptr;
@@ -0,0 +1,219 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "compiledtemplate_p.h"
+
+#include "context.h"
+#include "engine.h"
+#include "exception.h"
+#include "memoryusage_p.h"
+#include "metatype.h"
+#include "parser.h"
+#include "template_p.h"
+#include "tracer.h"
+
+#include <QtCore/QElapsedTimer>
+
+namespace Grantlee
+{
+
+class CompiledTemplateLoaderPrivate
+{
+  CompiledTemplateLoaderPrivate(CompiledTemplateLoader *loader)
+      : q_ptr(loader)
+  {
+  }
+
+  struct CompiledTemplate {
+    CompiledRenderFunction render;
+    const CompiledToken *tokens;
+    int tokenCount;
+  };
+
+  Q_DECLARE_PUBLIC(CompiledTemplateLoader)
+  CompiledTemplateLoader *const q_ptr;
+
+  QHash<QString, CompiledTemplate> m_templates;
+};
+}
+
+using namespace Grantlee;
+
+CompiledNode::CompiledNode(CompiledRenderFunction render,
+                           const NodeList &nodes, QObject *parent)
+    : Node(parent), m_render(render), m_nodes(nodes)
+{
+}
+
+void CompiledNode::render(OutputStream *stream, Context *c) const
+{
+  CompiledRenderer renderer(this, stream, c);
+  m_render(renderer);
+}
+
+qint64 CompiledNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(CompiledNode) - sizeof(Node)
+         + heapSize(m_nodes);
+}
+
+CompiledLookupKey::CompiledLookupKey(const QString &name)
+    : d_ptr(new CompiledLookupKeyPrivate(name))
+{
+}
+
+CompiledLookupKey::~CompiledLookupKey() { delete d_ptr; }
+
+CompiledRenderer::CompiledRenderer(const CompiledNode *node,
+                                   OutputStream *stream, Context *c)
+    : m_node(node), m_stream(stream), m_context(c)
+{
+}
+
+Context *CompiledRenderer::context() const { return m_context; }
+
+void CompiledRenderer::write(const QString &text) { (*m_stream) << text; }
+
+QVariant CompiledRenderer::lookup(const QString &name) const
+{
+  return m_context->lookup(name);
+}
+
+QVariant CompiledRenderer::lookup(const QVariant &object,
+                                  const QString &property) const
+{
+  if (!object.isValid())
+    return {};
+  return MetaType::lookup(object, property);
+}
+
+QVariant CompiledRenderer::lookup(const QVariant &object,
+                                  const CompiledLookupKey &property) const
+{
+  if (!object.isValid())
+    return {};
+  return property.d_func()->m_key.lookup(object);
+}
+
+void CompiledRenderer::writeValue(const QVariant &value)
+{
+  if (!value.isValid())
+    return;
+  m_node->streamValueInContext(m_stream, value, m_context);
+}
+
+void CompiledRenderer::renderNode(int index)
+{
+  const auto &nodes = m_node->m_nodes;
+  if (index < 0 || index >= nodes.size())
+    throw Grantlee::Exception(
+        TagSyntaxError,
+        QStringLiteral("The compiled template %1 does not match its tags")
+            .arg(m_node->containerTemplate()->objectName()));
+  nodes.at(index)->render(m_stream, m_context);
+}
+
+CompiledTemplateLoader::CompiledTemplateLoader()
+    : AbstractTemplateLoader(), d_ptr(new CompiledTemplateLoaderPrivate(this))
+{
+}
+
+CompiledTemplateLoader::~CompiledTemplateLoader() { delete d_ptr; }
+
+void CompiledTemplateLoader::addTemplate(const QString &name,
+                                         CompiledRenderFunction render,
+                                         const CompiledToken *tokens,
+                                         int tokenCount)
+{
+  Q_D(CompiledTemplateLoader);
+  d->m_templates.insert(name, {render, tokens, tokenCount});
+}
+
+QStringList CompiledTemplateLoader::templateNames() const
+{
+  Q_D(const CompiledTemplateLoader);
+  auto names = d->m_templates.keys();
+  names.sort();
+  return names;
+}
+
+bool CompiledTemplateLoader::canLoadTemplate(const QString &name) const
+{
+  Q_D(const CompiledTemplateLoader);
+  return d->m_templates.contains(name);
+}
+
+QPair<QString, QString>
+CompiledTemplateLoader::getMediaUri(const QString &fileName) const
+{
+  Q_UNUSED(fileName)
+  // Compiled templates don't make any media available.
+  return {};
+}
+
+Template CompiledTemplateLoader::loadByName(const QString &name,
+                                            Engine const *engine) const
+{
+  Q_D(const CompiledTemplateLoader);
+  const auto it = d->m_templates.constFind(name);
+  if (it == d->m_templates.constEnd())
+    return {};
+
+  QElapsedTimer timer;
+  timer.start();
+
+  auto t = engine->newTemplate(QString(), name);
+
+  QList<Token> tokens;
+  tokens.reserve(it->tokenCount);
+  for (auto i = 0; i < it->tokenCount; ++i) {
+    Token token;
+    token.tokenType = it->tokens[i].tokenType;
+    token.linenumber = it->tokens[i].linenumber;
+    token.content = QString::fromUtf8(it->tokens[i].content);
+    tokens.append(token);
+  }
+
+  try {
+    NodeList nodes;
+    if (!tokens.isEmpty()) {
+      TraceScope scope(engine->tracer(), "compile", "parse");
+      scope.setArgument("template", name);
+      Parser p(tokens, t.data());
+      nodes = p.parse(t.data());
+    }
+    if (it->render) {
+      NodeList root;
+      root.append(new CompiledNode(it->render, nodes, t.data()));
+      t->setNodeList(root);
+    } else {
+      t->setNodeList(nodes);
+    }
+  } catch (Grantlee::Exception &e) {
+    t->d_ptr->setError(e.errorCode(), e.what());
+  }
+
+  if (t->d_ptr->m_metrics)
+    t->d_ptr->m_metrics->compileTimes.record(timer.nsecsElapsed());
+
+  return t;
+}
+
+#include "moc_compiledtemplate_p.cpp"
@@ -0,0 +1,227 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_COMPILEDTEMPLATE_H
+#define GRANTLEE_COMPILEDTEMPLATE_H
+
+#include "templateloader.h"
+
+#include "grantlee_templates_export.h"
+
+namespace Grantlee
+{
+
+class CompiledLookupKeyPrivate;
+class CompiledNode;
+class CompiledTemplateLoaderPrivate;
+
+/// @headerfile compiledtemplate.h grantlee/compiledtemplate.h
+
+/**
+  @brief A Token of a Template compiled by <tt>grantlee-compile</tt>.
+
+  The tags of a compiled Template are stored as tokens, which are parsed
+  when the Template is loaded.
+*/
+struct CompiledToken {
+  int tokenType;       ///< The TokenType of the Token.
+  int linenumber;      ///< The line number the Token starts at.
+  const char *content; ///< The content of the Token, encoded in UTF-8.
+};
+
+/// @headerfile compiledtemplate.h grantlee/compiledtemplate.h
+
+/**
+  @brief The name of a property looked up by a Template compiled by
+  <tt>grantlee-compile</tt>.
+
+  The render functions generated by <tt>grantlee-compile</tt> create each
+  key once, so that the name is classified once instead of on every render.
+
+  This class is only relevant to generated code.
+*/
+class GRANTLEE_TEMPLATES_EXPORT CompiledLookupKey
+{
+public:
+  /**
+    Constructs a key for the property called @p name.
+  */
+  explicit CompiledLookupKey(const QString &name);
+
+  /**
+    Destructor
+  */
+  ~CompiledLookupKey();
+
+private:
+  Q_DISABLE_COPY(CompiledLookupKey)
+  Q_DECLARE_PRIVATE(CompiledLookupKey)
+  CompiledLookupKeyPrivate *const d_ptr;
+
+  friend class CompiledRenderer;
+};
+
+/// @headerfile compiledtemplate.h grantlee/compiledtemplate.h
+
+/**
+  @brief Renders a Template compiled by <tt>grantlee-compile</tt>.
+
+  The render functions generated by <tt>grantlee-compile</tt> write the text
+  of the Template and the variables it looks up with the **%CompiledRenderer**.
+  Tags are rendered by the nodes parsed when the Template was loaded.
+
+  This class is only relevant to generated code.
+*/
+class GRANTLEE_TEMPLATES_EXPORT CompiledRenderer
+{
+public:
+  /**
+    Returns the Context the Template is rendered in.
+  */
+  Context *context() const;
+
+  /**
+    Writes the text @p text without escaping it.
+  */
+  void write(const QString &text);
+
+  /**
+    Returns the value called @p name in the Context.
+  */
+  QVariant lookup(const QString &name) const;
+
+  /**
+    Returns the @p property of @p object, or an invalid QVariant if
+    @p object is invalid.
+  */
+  QVariant lookup(const QVariant &object, const QString &property) const;
+
+  /**
+    Returns the property of @p object named by @p property, or an invalid
+    QVariant if @p object is invalid.
+  */
+  QVariant lookup(const QVariant &object,
+                  const CompiledLookupKey &property) const;
+
+  /**
+    Writes @p value as a variable is written, escaping it if necessary.
+  */
+  void writeValue(const QVariant &value);
+
+  /**
+    Renders the node at @p index of the tags of the Template.
+  */
+  void renderNode(int index);
+
+private:
+  CompiledRenderer(const CompiledNode *node, OutputStream *stream,
+                   Context *c);
+
+  Q_DISABLE_COPY(CompiledRenderer)
+  const CompiledNode *const m_node;
+  OutputStream *const m_stream;
+  Context *const m_context;
+
+  friend class CompiledNode;
+};
+
+/**
+  The signature of the render functions generated by <tt>grantlee-compile</tt>.
+*/
+typedef void (*CompiledRenderFunction)(CompiledRenderer &renderer);
+
+/// @headerfile compiledtemplate.h grantlee/compiledtemplate.h
+
+/**
+  @brief The **%CompiledTemplateLoader** loads Templates compiled to C++ by
+  <tt>grantlee-compile</tt>.
+
+  The <tt>grantlee_compile_templates</tt> CMake function compiles template
+  files into a function which adds them to a **%CompiledTemplateLoader**.
+
+  @code
+    grantlee_compile_templates(myapp
+      FUNCTION addMyTemplates
+      BASE_DIR ${CMAKE_CURRENT_SOURCE_DIR}/templates
+      TEMPLATES templates/page.html templates/item.html
+    )
+  @endcode
+
+  @code
+    void addMyTemplates(Grantlee::CompiledTemplateLoader *loader);
+
+    auto loader = QSharedPointer<Grantlee::CompiledTemplateLoader>::create();
+    addMyTemplates(loader.data());
+    engine->addTemplateLoader(loader);
+  @endcode
+
+  Text and variables are compiled to C++. Tags, and variables which use
+  filters, are parsed when the Template is loaded and rendered by their
+  nodes. Templates which use the @gr_tag{extends}, @gr_tag{block} or
+  @gr_tag{load} tags are parsed entirely when they are loaded.
+
+  Templates are compiled with the Engine::smartTrimEnabled setting given to
+  <tt>grantlee-compile</tt>.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEMPLATES_EXPORT CompiledTemplateLoader
+    : public AbstractTemplateLoader
+{
+public:
+  /**
+    Constructor
+  */
+  CompiledTemplateLoader();
+
+  /**
+    Destructor
+  */
+  ~CompiledTemplateLoader() override;
+
+  /**
+    Adds the Template called @p name, which is rendered by the @p render
+    function and the @p tokenCount @p tokens of its tags. If @p render is
+    null the @p tokens are the whole Template.
+
+    This is called by the functions generated by <tt>grantlee-compile</tt>.
+  */
+  void addTemplate(const QString &name, CompiledRenderFunction render,
+                   const CompiledToken *tokens, int tokenCount);
+
+  /**
+    Returns the names of the Templates in the loader.
+  */
+  QStringList templateNames() const;
+
+  bool canLoadTemplate(const QString &name) const override;
+
+  QPair<QString, QString> getMediaUri(const QString &fileName) const override;
+
+  Template loadByName(const QString &name,
+                      Engine const *engine) const override;
+
+private:
+  Q_DECLARE_PRIVATE(CompiledTemplateLoader)
+  CompiledTemplateLoaderPrivate *const d_ptr;
+};
+}
+
+#endif
@@ -0,0 +1,67 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_COMPILEDTEMPLATE_P_H
+#define GRANTLEE_COMPILEDTEMPLATE_P_H
+
+#include "compiledtemplate.h"
+#include "lookupkey_p.h"
+#include "memoryusage_p.h"
+#include "node.h"
+
+namespace Grantlee
+{
+
+class CompiledLookupKeyPrivate
+{
+public:
+  explicit CompiledLookupKeyPrivate(const QString &name)
+      : m_key(LookupKey::intern(name))
+  {
+  }
+
+  const LookupKey m_key;
+};
+
+/**
+  @internal
+
+  The root node of a compiled Template, which calls its render function.
+*/
+class CompiledNode : public Node, public NodeMemoryUsage
+{
+  Q_OBJECT
+public:
+  CompiledNode(CompiledRenderFunction render, const NodeList &nodes,
+               QObject *parent = {});
+
+  void render(OutputStream *stream, Context *c) const override;
+
+  qint64 memoryUsage() const override;
+
+private:
+  const CompiledRenderFunction m_render;
+  const NodeList m_nodes;
+
+  friend class CompiledRenderer;
+};
+}
+
+#endif
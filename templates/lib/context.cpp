@@ -20,6 +20,7 @@
 
 #include "context.h"
 
+#include "lazyvalue.h"
 #include "nulllocalizer_p.h"
 #include "rendercontext.h"
 #include "util.h"
@@ -35,7 +36,7 @@ class ContextPrivate
   ContextPrivate(Context *context, const QVariantHash &variantHash)
       : q_ptr(context), m_autoescape(true), m_mutating(false),
         m_urlType(Context::AbsoluteUrls), m_renderContext(new RenderContext),
-        m_localizer(new NullLocalizer)
+        m_localizer(new NullLocalizer), m_renderProfiler(nullptr)
   {
     m_variantHashStack.append(variantHash);
   }
@@ -53,6 +54,7 @@ class ContextPrivate
   QString m_relativeMediaPath;
   RenderContext *const m_renderContext;
   QSharedPointer<AbstractLocalizer> m_localizer;
+  RenderProfiler *m_renderProfiler;
 };
 }
 
@@ -104,7 +106,7 @@ QVariant Context::lookup(const QString &str) const
   for (const auto &h : d->m_variantHashStack) {
     auto it = h.constFind(str);
     if (it != h.constEnd()) {
-      auto var = it.value();
+      auto var = LazyValue::resolve(it.value());
       // If the user passed a string into the context, turn it into a
       // Grantlee::SafeString.
       if (var.userType() == qMetaTypeId<QString>()) {
@@ -140,6 +142,13 @@ void Context::insert(const QString &name, const QVariant &variant)
   d->m_variantHashStack[0].insert(name, variant);
 }
 
+void Context::insert(const QString &name, const LazyValue &value)
+{
+  Q_D(Context);
+
+  d->m_variantHashStack[0].insert(name, QVariant::fromValue(value));
+}
+
 void Context::insert(const QString &name, QObject *object)
 {
   Q_D(Context);
@@ -230,3 +239,15 @@ QSharedPointer<AbstractLocalizer> Context::localizer() const
   Q_D(const Context);
   return d->m_localizer;
 }
+
+void Context::setRenderProfiler(RenderProfiler *profiler)
+{
+  Q_D(Context);
+  d->m_renderProfiler = profiler;
+}
+
+RenderProfiler *Context::renderProfiler() const
+{
+  Q_D(const Context);
+  return d->m_renderProfiler;
+}
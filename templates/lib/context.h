@@ -29,7 +29,9 @@
 namespace Grantlee
 {
 
+class LazyValue;
 class RenderContext;
+class RenderProfiler;
 
 class ContextPrivate;
 
@@ -176,6 +178,15 @@ public:
   */
   void insert(const QString &name, const QVariant &variant);
 
+  /**
+    Insert the lazily computed context object @p value identified by @p name
+    into the **%Context**. The value is computed the first time it is looked
+    up.
+
+    @see LazyValue
+  */
+  void insert(const QString &name, const LazyValue &value);
+
   /**
     Pushes a new context.
     @see @ref context_stack
@@ -274,6 +285,23 @@ public:
    */
   RenderContext *renderContext() const;
 
+  /**
+    Sets the @p profiler which records the time spent rendering Templates
+    with this **%Context**. Setting a null pointer, which is the default,
+    disables profiling.
+
+    The **%Context** does not take ownership of the profiler.
+
+    @see RenderProfiler
+  */
+  void setRenderProfiler(RenderProfiler *profiler);
+
+  /**
+    Returns the profiler which records the time spent rendering, or a null
+    pointer if profiling is disabled.
+  */
+  RenderProfiler *renderProfiler() const;
+
 private:
   Q_DECLARE_PRIVATE(Context)
   ContextPrivate *const d_ptr;
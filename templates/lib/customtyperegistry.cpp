@@ -24,6 +24,7 @@
 #include "metaenumvariable_p.h"
 #include "safestring.h"
 
+#include <QtCore/QAbstractItemModel>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QQueue>
 #include <QtCore/QStack>
@@ -33,55 +34,102 @@ Q_LOGGING_CATEGORY(GRANTLEE_CUSTOMTYPE, "grantlee.customtype")
 
 using namespace Grantlee;
 
-CustomTypeRegistry::CustomTypeRegistry()
+CustomTypeRegistry::CustomTypeRegistry() : types(new TypeHash)
 {
   // Grantlee Types
   registerBuiltInMetatype<SafeString>();
   registerBuiltInMetatype<MetaEnumVariable>();
+
+  // Items of models iterated in a {% for %} loop
+  registerBuiltInMetatype<QModelIndex>();
+}
+
+CustomTypeRegistry::~CustomTypeRegistry()
+{
+  delete types.loadAcquire();
+  qDeleteAll(retiredTypes);
+}
+
+bool CustomTypeRegistry::find(int id, CustomTypeInfo *info) const
+{
+  readers.ref();
+  const auto currentTypes = types.loadAcquire();
+  const auto it = currentTypes->constFind(id);
+  const auto found = it != currentTypes->constEnd();
+  if (found)
+    *info = it.value();
+  readers.deref();
+  return found;
+}
+
+void CustomTypeRegistry::publish(TypeHash *newTypes)
+{
+  retiredTypes.append(types.fetchAndStoreOrdered(newTypes));
+
+  // Lookups which start after this read the new hash, so the replaced ones
+  // are freed if no lookup is running.
+  if (readers.fetchAndAddOrdered(0) == 0) {
+    qDeleteAll(retiredTypes);
+    retiredTypes.clear();
+  }
 }
 
 void CustomTypeRegistry::registerLookupOperator(int id,
                                                 MetaType::LookupFunction f)
 {
-  CustomTypeInfo &info = types[id];
+  auto newTypes = new TypeHash(*types.loadAcquire());
+  CustomTypeInfo &info = (*newTypes)[id];
   info.lookupFunction = f;
+  publish(newTypes);
+}
+
+void CustomTypeRegistry::markUnknown(int id)
+{
+  QMutexLocker locker(&mutex);
+  const auto currentTypes = types.loadAcquire();
+  // Another thread may have registered or marked the type meanwhile.
+  if (currentTypes->contains(id))
+    return;
+
+  qCWarning(GRANTLEE_CUSTOMTYPE) << "Don't know how to handle metatype"
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+                                 << QMetaType::typeName(id);
+#else
+                                 << QMetaType(id).name();
+#endif
+
+  // Remember the type without a lookup function, so that it is not reported
+  // again on every access.
+  CustomTypeInfo info;
+  info.unknown = true;
+  auto newTypes = new TypeHash(*currentTypes);
+  newTypes->insert(id, info);
+  publish(newTypes);
 }
 
 QVariant CustomTypeRegistry::lookup(const QVariant &object,
-                                    const QString &property) const
+                                    const QString &property)
 {
   if (!object.isValid())
     return {};
   const auto id = object.userType();
-  MetaType::LookupFunction lf;
 
-  {
-    auto it = types.constFind(id);
-    if (it == types.constEnd()) {
-      qCWarning(GRANTLEE_CUSTOMTYPE) << "Don't know how to handle metatype"
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-                                     << QMetaType::typeName(id);
-#else
-                                     << QMetaType(id).name();
-#endif
-      // :TODO: Print out error message
-      return {};
-    }
+  CustomTypeInfo info;
+  if (!find(id, &info)) {
+    markUnknown(id);
+    return {};
+  }
 
-    const CustomTypeInfo &info = it.value();
-    if (!info.lookupFunction) {
+  const auto lf = info.lookupFunction;
+  if (!lf) {
+    if (!info.unknown)
       qCWarning(GRANTLEE_CUSTOMTYPE) << "No lookup function for metatype"
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
                                      << QMetaType::typeName(id);
 #else
                                      << QMetaType(id).name();
 #endif
-      lf = nullptr;
-      // :TODO: Print out error message
-      return {};
-    }
-
-    lf = info.lookupFunction;
+    return {};
   }
 
   return lf(object, property);
@@ -89,9 +137,6 @@ QVariant CustomTypeRegistry::lookup(const QVariant &object,
 
 bool CustomTypeRegistry::lookupAlreadyRegistered(int id) const
 {
-  auto it = types.constFind(id);
-  if (it != types.constEnd()) {
-    return it.value().lookupFunction != nullptr;
-  }
-  return false;
+  CustomTypeInfo info;
+  return find(id, &info) && info.lookupFunction != nullptr;
 }
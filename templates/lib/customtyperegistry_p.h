@@ -24,21 +24,42 @@
 
 #include "metatype.h"
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QMutex>
+#include <QtCore/QVector>
 
 namespace Grantlee
 {
 
 struct CustomTypeInfo {
 public:
-  CustomTypeInfo() : lookupFunction(nullptr) {}
+  CustomTypeInfo() : lookupFunction(nullptr), unknown(false) {}
 
   Grantlee::MetaType::LookupFunction lookupFunction;
+  // Whether the type was looked up without being registered.
+  bool unknown;
 };
 
+/*
+  Registration happens rarely, typically at startup, while lookups happen
+  for every property access of a custom type while rendering. The registered
+  types are therefore kept in an immutable hash which is replaced as a whole
+  on registration. Lookups only load the current hash and never lock.
+
+  Lookups count themselves in readers while they read a hash. A replaced
+  hash is kept until a registration finds no lookup running, because a
+  concurrent lookup may still be reading it.
+*/
 struct CustomTypeRegistry {
+  typedef QHash<int, CustomTypeInfo> TypeHash;
+
   CustomTypeRegistry();
+  ~CustomTypeRegistry();
 
+  /*
+    The caller must hold the mutex, except during construction.
+  */
   void registerLookupOperator(int id, MetaType::LookupFunction f);
 
   template <typename RealType, typename HandleAs> int registerBuiltInMetatype()
@@ -58,11 +79,18 @@ struct CustomTypeRegistry {
     return registerBuiltInMetatype<Type, Type>();
   }
 
-  QVariant lookup(const QVariant &object, const QString &property) const;
+  QVariant lookup(const QVariant &object, const QString &property);
   bool lookupAlreadyRegistered(int id) const;
 
-  QHash<int, CustomTypeInfo> types;
+  QAtomicPointer<const TypeHash> types;
+  mutable QAtomicInt readers;
+  QVector<const TypeHash *> retiredTypes;
   QMutex mutex;
+
+private:
+  bool find(int id, CustomTypeInfo *info) const;
+  void publish(TypeHash *newTypes);
+  void markUnknown(int id);
 };
 }
 
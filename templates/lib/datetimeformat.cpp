@@ -0,0 +1,334 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "datetimeformat_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+
+using namespace Grantlee;
+
+namespace
+{
+enum Names { ShortDayNames, LongDayNames, ShortMonthNames, LongMonthNames };
+}
+
+// Reads the text quoted at @p *index of @p format, as QLocale does.
+static QString readQuoted(const QString &format, int *index)
+{
+  auto &i = *index;
+  ++i;
+  if (i == format.size())
+    return {};
+  if (format.at(i) == QLatin1Char('\'')) {
+    ++i;
+    return QStringLiteral("'");
+  }
+  QString result;
+  while (i < format.size()) {
+    if (format.at(i) == QLatin1Char('\'')) {
+      if (i + 1 < format.size() && format.at(i + 1) == QLatin1Char('\'')) {
+        result.append(QLatin1Char('\''));
+        i += 2;
+      } else {
+        break;
+      }
+    } else {
+      result.append(format.at(i++));
+    }
+  }
+  if (i < format.size())
+    ++i;
+  return result;
+}
+
+static bool containsAmPm(const QString &format)
+{
+  auto i = 0;
+  while (i < format.size()) {
+    if (format.at(i) == QLatin1Char('\'')) {
+      readQuoted(format, &i);
+      continue;
+    }
+    if (format.at(i).toLower() == QLatin1Char('a'))
+      return true;
+    ++i;
+  }
+  return false;
+}
+
+static void appendNumber(QString *result, int number, int width)
+{
+  const auto digits = QString::number(number);
+  for (auto i = digits.size(); i < width; ++i)
+    result->append(QLatin1Char('0'));
+  result->append(digits);
+}
+
+DateTimeFormat::DateTimeFormat() : m_parsed(false), m_twelveHour(false) {}
+
+DateTimeFormat::DateTimeFormat(const QLocale &locale, const QString &format,
+                               Fields fields)
+    : m_locale(locale), m_format(format), m_parsed(false),
+      m_twelveHour(false)
+{
+  // Numbers are written with ASCII digits.
+  if (QString(locale.zeroDigit()) != QLatin1String("0"))
+    return;
+
+  const bool formatDate = fields & DateFields;
+  const bool formatTime = fields & TimeFields;
+  m_twelveHour = formatTime && containsAmPm(format);
+
+  auto i = 0;
+  while (i < format.size()) {
+    const auto c = format.at(i);
+    if (c == QLatin1Char('\'')) {
+      appendText(readQuoted(format, &i));
+      continue;
+    }
+
+    auto repeat = 1;
+    while (i + repeat < format.size() && format.at(i + repeat) == c)
+      ++repeat;
+
+    auto used = false;
+    if (formatDate) {
+      switch (c.unicode()) {
+      case 'y':
+        used = true;
+        if (repeat >= 4) {
+          repeat = 4;
+          append(c, repeat);
+        } else if (repeat >= 2) {
+          repeat = 2;
+          append(c, repeat);
+        } else {
+          appendText(QString(c));
+        }
+        break;
+      case 'M':
+      case 'd':
+        used = true;
+        repeat = qMin(repeat, 4);
+        append(c, repeat);
+        break;
+      }
+    }
+    if (!used && formatTime) {
+      switch (c.unicode()) {
+      case 'h':
+      case 'H':
+      case 'm':
+      case 's':
+        used = true;
+        repeat = qMin(repeat, 2);
+        append(c, repeat);
+        break;
+      case 'z':
+        // A single z is written differently by different versions of Qt.
+        if (repeat < 3)
+          return;
+        used = true;
+        repeat = 3;
+        append(c, repeat);
+        break;
+      case 'a':
+      case 'A': {
+        used = true;
+        const auto next = i + 1 < format.size() ? format.at(i + 1) : QChar();
+        // Mixed case AM/PM is not written the same by all versions of Qt.
+        if (next.toLower() == QLatin1Char('p')
+            && next.isUpper() != c.isUpper())
+          return;
+        repeat = next.toLower() == QLatin1Char('p') ? 2 : 1;
+        append(c, 1);
+        break;
+      }
+      case 't':
+        return;
+      }
+    }
+    if (!used)
+      appendText(QString(repeat, c));
+    i += repeat;
+  }
+
+  m_amText = locale.amText();
+  m_pmText = locale.pmText();
+  m_parsed = true;
+}
+
+void DateTimeFormat::append(const QChar &letter, int count)
+{
+  const auto l = letter.toLatin1();
+  if (l == 'd' && count > 2 && m_names[ShortDayNames].isEmpty()) {
+    for (auto day = 1; day <= 7; ++day) {
+      m_names[ShortDayNames].append(
+          m_locale.dayName(day, QLocale::ShortFormat));
+      m_names[LongDayNames].append(m_locale.dayName(day, QLocale::LongFormat));
+    }
+  } else if (l == 'M' && count > 2 && m_names[ShortMonthNames].isEmpty()) {
+    for (auto month = 1; month <= 12; ++month) {
+      m_names[ShortMonthNames].append(
+          m_locale.monthName(month, QLocale::ShortFormat));
+      m_names[LongMonthNames].append(
+          m_locale.monthName(month, QLocale::LongFormat));
+    }
+  }
+  m_fields.append(Field{l, count, {}});
+}
+
+void DateTimeFormat::appendText(const QString &text)
+{
+  if (!m_fields.isEmpty() && m_fields.last().letter == 0)
+    m_fields.last().text.append(text);
+  else
+    m_fields.append(Field{0, 0, text});
+}
+
+QString DateTimeFormat::format(const QDate &date, const QTime &time) const
+{
+  QString result;
+  for (const auto &field : m_fields) {
+    switch (field.letter) {
+    case 0:
+      result.append(field.text);
+      break;
+    case 'y':
+      if (field.count == 4)
+        appendNumber(&result, date.year(), 4);
+      else
+        appendNumber(&result, date.year() % 100, 2);
+      break;
+    case 'M':
+      if (field.count > 2)
+        result.append(m_names[field.count == 3 ? ShortMonthNames
+                                               : LongMonthNames]
+                          .at(date.month() - 1));
+      else
+        appendNumber(&result, date.month(), field.count);
+      break;
+    case 'd':
+      if (field.count > 2)
+        result.append(
+            m_names[field.count == 3 ? ShortDayNames : LongDayNames].at(
+                date.dayOfWeek() - 1));
+      else
+        appendNumber(&result, date.day(), field.count);
+      break;
+    case 'h': {
+      auto hour = time.hour();
+      if (m_twelveHour) {
+        if (hour > 12)
+          hour -= 12;
+        else if (hour == 0)
+          hour = 12;
+      }
+      appendNumber(&result, hour, field.count);
+      break;
+    }
+    case 'H':
+      appendNumber(&result, time.hour(), field.count);
+      break;
+    case 'm':
+      appendNumber(&result, time.minute(), field.count);
+      break;
+    case 's':
+      appendNumber(&result, time.second(), field.count);
+      break;
+    case 'z':
+      appendNumber(&result, time.msec(), 3);
+      break;
+    case 'a':
+      result.append(time.hour() < 12 ? m_amText.toLower()
+                                      : m_pmText.toLower());
+      break;
+    case 'A':
+      result.append(time.hour() < 12 ? m_amText.toUpper()
+                                      : m_pmText.toUpper());
+      break;
+    }
+  }
+  return result;
+}
+
+QString DateTimeFormat::toString(const QDate &date) const
+{
+  if (!m_parsed || !date.isValid() || date.year() < 1 || date.year() > 9999)
+    return m_locale.toString(date, m_format);
+  return format(date, {});
+}
+
+QString DateTimeFormat::toString(const QTime &time) const
+{
+  if (!m_parsed || !time.isValid())
+    return m_locale.toString(time, m_format);
+  return format({}, time);
+}
+
+QString DateTimeFormat::toString(const QDateTime &dateTime) const
+{
+  if (!m_parsed || !dateTime.isValid())
+    return m_locale.toString(dateTime, m_format);
+  const auto date = dateTime.date();
+  if (date.year() < 1 || date.year() > 9999)
+    return m_locale.toString(dateTime, m_format);
+  return format(date, dateTime.time());
+}
+
+namespace
+{
+struct DateTimeFormatCache {
+  QMutex mutex;
+  QHash<QPair<QPair<QString, bool>, QPair<QString, int>>, DateTimeFormat>
+      formats;
+};
+}
+
+Q_GLOBAL_STATIC(DateTimeFormatCache, dateTimeFormatCache)
+
+// Formats given by variable arguments could otherwise grow the cache without
+// bound.
+static const int s_maxCachedFormats = 256;
+
+DateTimeFormat Grantlee::cachedDateTimeFormat(const QLocale &locale,
+                                              const QString &format,
+                                              DateTimeFormat::Fields fields)
+{
+  // The system locale may name its days and months differently than the
+  // locale of the same name.
+  const auto key
+      = qMakePair(qMakePair(locale.bcp47Name(), locale == QLocale::system()),
+                  qMakePair(format, static_cast<int>(fields)));
+
+  auto cache = dateTimeFormatCache();
+  QMutexLocker locker(&cache->mutex);
+  const auto it = cache->formats.constFind(key);
+  if (it != cache->formats.constEnd())
+    return it.value();
+
+  const DateTimeFormat dateTimeFormat(locale, format, fields);
+  if (cache->formats.size() >= s_maxCachedFormats)
+    cache->formats.clear();
+  cache->formats.insert(key, dateTimeFormat);
+  return dateTimeFormat;
+}
@@ -0,0 +1,94 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_DATETIMEFORMAT_P_H
+#define GRANTLEE_DATETIMEFORMAT_P_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QLocale>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace Grantlee
+{
+
+/**
+  @internal
+
+  A date and time format string of a QLocale, parsed once into the fields it
+  writes.
+
+  The fields use the names and AM/PM texts of the locale and the same rules
+  as QLocale::toString. Formats with fields which are not implemented here,
+  such as time zones, and dates outside of the years 1 to 9999 are formatted
+  by QLocale instead.
+*/
+class GRANTLEE_TEMPLATES_EXPORT DateTimeFormat
+{
+public:
+  /**
+    The fields which are written, as for formatting a QDate, a QTime or a
+    QDateTime. Letters of other fields are written literally.
+  */
+  enum Fields { DateFields = 1, TimeFields = 2, DateTimeFields = 3 };
+
+  DateTimeFormat();
+  DateTimeFormat(const QLocale &locale, const QString &format, Fields fields);
+
+  QString toString(const QDate &date) const;
+  QString toString(const QTime &time) const;
+  QString toString(const QDateTime &dateTime) const;
+
+private:
+  struct Field {
+    // The letter of the field, or 0 for literal text.
+    char letter;
+    int count;
+    QString text;
+  };
+
+  void append(const QChar &letter, int count);
+  void appendText(const QString &text);
+  QString format(const QDate &date, const QTime &time) const;
+
+  QLocale m_locale;
+  QString m_format;
+  QVector<Field> m_fields;
+  QStringList m_names[4];
+  QString m_amText;
+  QString m_pmText;
+  bool m_parsed;
+  bool m_twelveHour;
+};
+
+/**
+  @internal
+
+  Returns the DateTimeFormat for @p format and @p fields in @p locale from a
+  cache which is shared by all threads.
+*/
+GRANTLEE_TEMPLATES_EXPORT DateTimeFormat cachedDateTimeFormat(
+    const QLocale &locale, const QString &format,
+    DateTimeFormat::Fields fields = DateTimeFormat::DateTimeFields);
+}
+
+#endif
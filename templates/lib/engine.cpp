@@ -21,6 +21,7 @@
 #include "engine.h"
 #include "engine_p.h"
 
+#include "cachingloaderdecorator.h"
 #include "exception.h"
 #include "grantlee_config_p.h"
 #include "grantlee_version.h"
@@ -29,9 +30,11 @@
 #endif
 #include "template_p.h"
 #include "templateloader.h"
+#include "tracer.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QJsonObject>
 #include <QtCore/QPluginLoader>
 #include <QtCore/QTextStream>
 
@@ -56,6 +59,7 @@ Engine::~Engine()
   qDeleteAll(d_ptr->m_scriptableLibraries);
 #endif
   d_ptr->m_libraries.clear();
+  d_ptr->m_pluginIndex.save();
   delete d_ptr;
 }
 
@@ -69,6 +73,7 @@ void Engine::addTemplateLoader(QSharedPointer<AbstractTemplateLoader> loader)
 {
   Q_D(Engine);
   d->m_loaders << loader;
+  d->m_loaderCounters << QSharedPointer<LoaderCounters>::create();
 }
 
 QPair<QString, QString> Engine::mediaUri(const QString &fileName) const
@@ -111,6 +116,18 @@ QStringList Engine::pluginPaths() const
   return d->m_pluginDirs;
 }
 
+void Engine::setPluginCacheFile(const QString &fileName)
+{
+  Q_D(Engine);
+  d->m_pluginIndex.setCacheFile(fileName);
+}
+
+QString Engine::pluginCacheFile() const
+{
+  Q_D(const Engine);
+  return d->m_pluginIndex.cacheFile();
+}
+
 QStringList Engine::defaultLibraries() const
 {
   Q_D(const Engine);
@@ -167,6 +184,15 @@ void Engine::loadDefaultLibraries()
     if (d->m_libraries.contains(libName))
       continue;
 
+    // The Parser loads the library when one of its tags or filters is used.
+    QStringList tags;
+    QStringList filters;
+    if (canDeferLibrary(libName, &tags, &filters))
+      continue;
+
+    if (d->loadStaticLibrary(libName))
+      continue;
+
     uint minorVersion = GRANTLEE_VERSION_MINOR;
     while (acceptableVersion<GRANTLEE_MIN_PLUGIN_VERSION>(minorVersion)) {
 #ifdef QT_QML_LIB
@@ -203,6 +229,10 @@ TagLibraryInterface *Engine::loadLibrary(const QString &name)
   if (d->m_libraries.contains(name))
     return d->m_libraries.value(name).data();
 
+  auto staticLibrary = d->loadStaticLibrary(name);
+  if (staticLibrary)
+    return staticLibrary.data();
+
   uint minorVersion = GRANTLEE_VERSION_MINOR;
   while (acceptableVersion<GRANTLEE_MIN_PLUGIN_VERSION>(minorVersion)) {
     auto library = d->loadLibrary(name, minorVersion);
@@ -218,6 +248,68 @@ TagLibraryInterface *Engine::loadLibrary(const QString &name)
   return nullptr;
 }
 
+bool Engine::canDeferLibrary(const QString &name, QStringList *tags,
+                             QStringList *filters)
+{
+  Q_D(Engine);
+
+#ifdef QT_QML_LIB
+  if (name == QLatin1String(s_scriptableLibName))
+    return false;
+#endif
+
+  if (d->m_libraries.contains(name))
+    return false;
+
+  // Static plugins declare their content in the same metadata, which is
+  // read without creating the plugin instance.
+  const auto plugins = QPluginLoader::staticPlugins();
+  for (const auto &staticPlugin : plugins) {
+    const auto metaData = staticPlugin.metaData()
+                              .value(QStringLiteral("MetaData"))
+                              .toObject();
+    if (metaData.value(QStringLiteral("name")).toString() != name)
+      continue;
+
+    const auto declaration = PluginIndex::readDeclaration(metaData);
+    if (!declaration.hasDeclaration)
+      return false;
+    *tags = declaration.tags;
+    *filters = declaration.filters;
+    return true;
+  }
+
+  uint minorVersion = GRANTLEE_VERSION_MINOR;
+  while (acceptableVersion<GRANTLEE_MIN_PLUGIN_VERSION>(minorVersion)) {
+#ifdef QT_QML_LIB
+    // Scripted libraries first in the search path take precedence and do
+    // not declare their content.
+    if (d->m_scriptableTagLibrary
+        && !d->getScriptLibraryName(name, minorVersion).isEmpty())
+      return false;
+#endif
+
+    for (const auto &dir : qAsConst(d->m_pluginDirs)) {
+      const auto pluginDirString = d->pluginDirectory(dir, minorVersion);
+      const auto fileName = d->findCppLibrary(pluginDirString, name);
+      if (fileName.isEmpty())
+        continue;
+
+      const auto declaration
+          = d->m_pluginIndex.declaration(pluginDirString, fileName);
+      if (!declaration.hasDeclaration)
+        return false;
+      *tags = declaration.tags;
+      *filters = declaration.filters;
+      return true;
+    }
+    if (minorVersion == 0)
+      break;
+    minorVersion--;
+  }
+  return false;
+}
+
 TagLibraryInterface *EnginePrivate::loadLibrary(const QString &name,
                                                 uint minorVersion)
 {
@@ -233,32 +325,56 @@ TagLibraryInterface *EnginePrivate::loadLibrary(const QString &name,
 }
 
 EnginePrivate::EnginePrivate(Engine *engine)
-    : q_ptr(engine)
+    : q_ptr(engine), m_metrics(QSharedPointer<EngineMetricsData>::create()),
+      m_tracer(nullptr)
 #ifdef QT_QML_LIB
       ,
       m_scriptableTagLibrary(nullptr)
 #endif
       ,
-      m_smartTrimEnabled(false)
+      m_smartTrimEnabled(false), m_bytecodeEnabled(false)
 {
 }
 
+QString EnginePrivate::pluginDirectory(const QString &pluginDir,
+                                       uint minorVersion) const
+{
+  return pluginDir + QStringLiteral("/grantlee/")
+         + QString::number(GRANTLEE_VERSION_MAJOR) + QLatin1Char('.')
+         + QString::number(minorVersion) + QLatin1Char('/');
+}
+
+QString EnginePrivate::findCppLibrary(const QString &pluginDirString,
+                                      const QString &name)
+{
+  const auto files = m_pluginIndex.entries(pluginDirString);
+
+  auto findFile = [&files](const QString &prefix) -> QString {
+    for (const auto &file : files) {
+      if (file.startsWith(prefix))
+        return file;
+    }
+    return {};
+  };
+
+#if PLUGINS_PREFER_DEBUG_POSTFIX
+  const auto fileName = findFile(name + QLatin1Char('d'));
+  if (!fileName.isEmpty())
+    return fileName;
+#endif
+  return findFile(name);
+}
+
 QString EnginePrivate::getScriptLibraryName(const QString &name,
-                                            uint minorVersion) const
-{
-  auto pluginIndex = 0;
-  const QString prefix
-      = QStringLiteral("/grantlee/") + QString::number(GRANTLEE_VERSION_MAJOR)
-        + QLatin1Char('.') + QString::number(minorVersion) + QLatin1Char('/');
-  while (m_pluginDirs.size() > pluginIndex) {
-    const auto nextDir = m_pluginDirs.at(pluginIndex++);
-    const QString libFileName = nextDir + prefix + name + QStringLiteral(".qs");
-
-    const QFile file(libFileName);
-    if (!file.exists())
-      continue;
-    return libFileName;
+                                            uint minorVersion)
+{
+  const QString libFileName = name + QStringLiteral(".qs");
+  for (const auto &dir : qAsConst(m_pluginDirs)) {
+    const auto pluginDirString = pluginDirectory(dir, minorVersion);
+    if (m_pluginIndex.entries(pluginDirString).contains(libFileName))
+      return pluginDirString + libFileName;
   }
+  const auto prefix = pluginDirectory(QString(), minorVersion);
   auto it = m_loaders.constBegin();
   const auto end = m_loaders.constEnd();
   for (; it != end; ++it) {
@@ -288,6 +404,10 @@ EnginePrivate::loadScriptableLibrary(const QString &name, uint minorVersion)
   if (libFileName.isEmpty())
     return nullptr;
 
+  // Getting the tags and filters of the library evaluates its script.
+  TraceScope scope(m_tracer, "library", "evaluateScript");
+  scope.setArgument("library", libFileName);
+
   const auto it = m_scriptableLibraries.constFind(libFileName);
   if (it != m_scriptableLibraries.constEnd()) {
     auto library = it.value();
@@ -310,39 +430,42 @@ EnginePrivate::loadScriptableLibrary(const QString &name, uint minorVersion)
 #endif
 
 PluginPointer<TagLibraryInterface>
-EnginePrivate::loadCppLibrary(const QString &name, uint minorVersion)
+EnginePrivate::loadStaticLibrary(const QString &name)
 {
-  auto pluginIndex = 0;
-
-  while (m_pluginDirs.size() > pluginIndex) {
-    const auto nextDir = m_pluginDirs.at(pluginIndex++);
-    const QString pluginDirString
-        = nextDir + QStringLiteral("/grantlee/")
-          + QString::number(GRANTLEE_VERSION_MAJOR) + QLatin1Char('.')
-          + QString::number(minorVersion) + QLatin1Char('/');
-
-    const QDir pluginDir(pluginDirString);
-
-    if (!pluginDir.exists())
+  // Static plugins are identified by the name in their metadata, which
+  // does not require any access to the plugin paths.
+  const auto plugins = QPluginLoader::staticPlugins();
+  for (const auto &staticPlugin : plugins) {
+    const auto metaData = staticPlugin.metaData()
+                              .value(QStringLiteral("MetaData"))
+                              .toObject();
+    if (metaData.value(QStringLiteral("name")).toString() != name)
       continue;
 
-    auto list = pluginDir.entryList(QStringList(name
-#if PLUGINS_PREFER_DEBUG_POSTFIX
-                                                + QLatin1Char('d')
-#endif
-                                                + QLatin1Char('*')));
+    TraceScope scope(m_tracer, "library", "loadLibrary");
+    scope.setArgument("library", name);
+    auto plugin = PluginPointer<TagLibraryInterface>(staticPlugin.instance());
+    if (plugin) {
+      m_libraries.insert(name, plugin);
+      return plugin;
+    }
+  }
+  return nullptr;
+}
 
-    if (list.isEmpty()) {
-#if PLUGINS_PREFER_DEBUG_POSTFIX
-      list = pluginDir.entryList(QStringList(name + QLatin1Char('*')));
-      if (list.isEmpty())
-        continue;
-#else
+PluginPointer<TagLibraryInterface>
+EnginePrivate::loadCppLibrary(const QString &name, uint minorVersion)
+{
+  for (const auto &dir : qAsConst(m_pluginDirs)) {
+    const auto pluginDirString = pluginDirectory(dir, minorVersion);
+    const auto fileName = findCppLibrary(pluginDirString, name);
+    if (fileName.isEmpty())
       continue;
-#endif
-    }
 
-    auto pluginPath = pluginDir.absoluteFilePath(list.first());
+    auto pluginPath = QDir(pluginDirString).absoluteFilePath(fileName);
+
+    TraceScope scope(m_tracer, "library", "loadLibrary");
+    scope.setArgument("library", name);
     auto plugin = PluginPointer<TagLibraryInterface>(pluginPath);
 
     if (plugin) {
@@ -360,15 +483,27 @@ Template Engine::loadByName(const QString &name) const
 {
   Q_D(const Engine);
 
-  for (auto &loader : d->m_loaders) {
-    if (!loader->canLoadTemplate(name))
+  TraceScope scope(d->m_tracer, "load", "loadByName");
+  scope.setArgument("template", name);
+
+  for (auto i = 0; i < d->m_loaders.size(); ++i) {
+    const auto &loader = d->m_loaders.at(i);
+    const auto &counters = d->m_loaderCounters.at(i);
+    TraceScope probeScope(d->m_tracer, "load", "probeLoader");
+    probeScope.setArgument("template", name);
+    probeScope.setArgument("loader", QString::number(i));
+    if (!loader->canLoadTemplate(name)) {
+      counters->misses.add();
       continue;
+    }
 
     const auto t = loader->loadByName(name, this);
 
     if (t) {
+      counters->hits.add();
       return t;
     }
+    counters->misses.add();
   }
   auto t = Template(new TemplateImpl(this));
   t->setObjectName(name);
@@ -382,10 +517,52 @@ Template Engine::newTemplate(const QString &content, const QString &name) const
   Q_D(const Engine);
   auto t = Template(new TemplateImpl(this, d->m_smartTrimEnabled));
   t->setObjectName(name);
+  t->d_ptr->m_metrics = d->m_metrics;
+  t->d_ptr->m_renderTimes = d->m_metrics->renderTimes(name);
+  t->d_ptr->m_bytecodeEnabled = d->m_bytecodeEnabled;
   t->setContent(content);
   return t;
 }
 
+EngineMetrics Engine::metrics() const
+{
+  Q_D(const Engine);
+  auto metrics = d->m_metrics->snapshot();
+
+  for (auto i = 0; i < d->m_loaders.size(); ++i) {
+    EngineMetrics::LoaderMetrics loaderMetrics;
+    loaderMetrics.loader = d->m_loaders.at(i);
+    loaderMetrics.hits = d->m_loaderCounters.at(i)->hits.value();
+    loaderMetrics.misses = d->m_loaderCounters.at(i)->misses.value();
+    if (const auto cache = dynamic_cast<const CachingLoaderDecorator *>(
+            loaderMetrics.loader.data())) {
+      loaderMetrics.cacheHits = cache->hits();
+      loaderMetrics.cacheMisses = cache->misses();
+      loaderMetrics.evictions = cache->evictions();
+    }
+    metrics.loaders.append(loaderMetrics);
+  }
+  return metrics;
+}
+
+void Engine::setMetricsCallback(MetricsCallback callback)
+{
+  Q_D(Engine);
+  d->m_metrics->callback = callback;
+}
+
+void Engine::setTracer(Tracer *tracer)
+{
+  Q_D(Engine);
+  d->m_tracer = tracer;
+}
+
+Tracer *Engine::tracer() const
+{
+  Q_D(const Engine);
+  return d->m_tracer;
+}
+
 void Engine::setSmartTrimEnabled(bool enabled)
 {
   Q_D(Engine);
@@ -397,3 +574,15 @@ bool Engine::smartTrimEnabled() const
   Q_D(const Engine);
   return d->m_smartTrimEnabled;
 }
+
+void Engine::setBytecodeEnabled(bool enabled)
+{
+  Q_D(Engine);
+  d->m_bytecodeEnabled = enabled;
+}
+
+bool Engine::bytecodeEnabled() const
+{
+  Q_D(const Engine);
+  return d->m_bytecodeEnabled;
+}
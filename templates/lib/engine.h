@@ -21,12 +21,16 @@
 #ifndef GRANTLEE_ENGINE_H
 #define GRANTLEE_ENGINE_H
 
+#include "enginemetrics.h"
 #include "template.h"
 #include "templateloader.h"
 
+#include <functional>
+
 namespace Grantlee
 {
 class TagLibraryInterface;
+class Tracer;
 
 class EnginePrivate;
 
@@ -167,6 +171,26 @@ public:
   */
   QStringList pluginPaths() const;
 
+  /**
+    Sets the file used to persist the index of the plugin directories to
+    @p fileName.
+
+    The plugin directories are listed once per **%Engine** and the tags and
+    filters declared by each plugin are read from its metadata. With a cache
+    file, the index is reused by later processes for as long as the plugin
+    directories are not modified, so that creating an **%Engine** does not
+    need to scan the plugin directories again.
+
+    The cache file is written when the **%Engine** is destroyed. By default
+    no cache file is used.
+  */
+  void setPluginCacheFile(const QString &fileName);
+
+  /**
+    Returns the file used to persist the index of the plugin directories.
+  */
+  QString pluginCacheFile() const;
+
   /**
     Returns a URI for a media item with the name @p name.
 
@@ -231,6 +255,61 @@ public:
    */
   void setSmartTrimEnabled(bool enabled);
 
+  /**
+    Returns whether newly loaded templates are compiled to bytecode.
+
+    @see bytecode
+
+    This is false by default.
+  */
+  bool bytecodeEnabled() const;
+
+  /**
+    Sets whether newly loaded templates are compiled to bytecode, which is
+    rendered by a single loop instead of by each Node.
+
+    @see bytecode
+  */
+  void setBytecodeEnabled(bool enabled);
+
+  /**
+    The type of the callback which is called after each render of a
+    Template created by the **%Engine**, with the name of the Template, the
+    time taken to render it in nanoseconds and the Error raised, if any.
+  */
+  typedef std::function<void(const QString &templateName, qint64 renderTime,
+                             Grantlee::Error error)>
+      MetricsCallback;
+
+  /**
+    Returns a snapshot of the metrics recorded for the Templates created by
+    the **%Engine**.
+  */
+  EngineMetrics metrics() const;
+
+  /**
+    Sets the @p callback to call after each render of a Template created by
+    the **%Engine**. The callback is called in the thread which rendered the
+    Template, so it must be threadsafe if Templates are rendered in several
+    threads. It should be set before any Template is rendered.
+  */
+  void setMetricsCallback(MetricsCallback callback);
+
+  /**
+    Sets the @p tracer which records the loading, compiling and rendering of
+    Templates created by the **%Engine**. Setting a null pointer, which is
+    the default, disables tracing.
+
+    The **%Engine** does not take ownership of the tracer.
+  */
+  void setTracer(Tracer *tracer);
+
+  /**
+    Returns the tracer set on the **%Engine**, or a null pointer if tracing is
+    disabled.
+  */
+  Tracer *tracer() const;
+
 #ifndef Q_QDOC
   /**
     @internal
@@ -248,6 +327,17 @@ public:
     Templates wishing to load a library should use the @gr_tag{load} tag.
   */
   TagLibraryInterface *loadLibrary(const QString &name);
+
+  /**
+    @internal
+
+    Returns whether loading the library specified by @p name can be deferred
+    until one of its tags or filters is used. If so, the names of the tags
+    and filters declared by the library are returned in @p tags and
+    @p filters.
+  */
+  bool canDeferLibrary(const QString &name, QStringList *tags,
+                       QStringList *filters);
 #endif
 
 private:
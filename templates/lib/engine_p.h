@@ -22,7 +22,9 @@
 #define GRANTLEE_ENGINE_P_H
 
 #include "engine.h"
+#include "enginemetrics_p.h"
 #include "filter.h"
+#include "pluginindex_p.h"
 #include "pluginpointer_p.h"
 #include "taglibraryinterface.h"
 
@@ -85,13 +87,17 @@ class EnginePrivate
   EnginePrivate(Engine *engine);
 
   TagLibraryInterface *loadLibrary(const QString &name, uint minorVersion);
-  QString getScriptLibraryName(const QString &name, uint minorVersion) const;
+  QString getScriptLibraryName(const QString &name, uint minorVersion);
 #ifdef QT_QML_LIB
   ScriptableLibraryContainer *loadScriptableLibrary(const QString &name,
                                                     uint minorVersion);
 #endif
+  PluginPointer<TagLibraryInterface> loadStaticLibrary(const QString &name);
   PluginPointer<TagLibraryInterface> loadCppLibrary(const QString &name,
                                                     uint minorVersion);
+  QString pluginDirectory(const QString &pluginDir, uint minorVersion) const;
+  QString findCppLibrary(const QString &pluginDirString,
+                         const QString &name);
 
   Q_DECLARE_PUBLIC(Engine)
   Engine *const q_ptr;
@@ -102,12 +108,17 @@ class EnginePrivate
 #endif
 
   QList<QSharedPointer<AbstractTemplateLoader>> m_loaders;
+  QList<QSharedPointer<LoaderCounters>> m_loaderCounters;
+  const QSharedPointer<EngineMetricsData> m_metrics;
   QStringList m_pluginDirs;
   QStringList m_defaultLibraries;
+  PluginIndex m_pluginIndex;
+  Tracer *m_tracer;
 #ifdef QT_QML_LIB
   ScriptableTagLibrary *m_scriptableTagLibrary;
 #endif
   bool m_smartTrimEnabled;
+  bool m_bytecodeEnabled;
 };
 }
 
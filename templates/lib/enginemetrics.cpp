@@ -0,0 +1,134 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "enginemetrics_p.h"
+
+using namespace Grantlee;
+
+// The upper bounds of the histogram buckets in nanoseconds, from 10
+// microseconds to 1 second.
+static const qint64 s_bucketBounds[] = {
+    10000,    50000,    100000,    500000,    1000000,    5000000,
+    10000000, 50000000, 100000000, 500000000, 1000000000,
+};
+
+int Grantlee::metricsShard()
+{
+  static QAtomicInt nextShard;
+  thread_local const int shard
+      = nextShard.fetchAndAddRelaxed(1) % MetricsShards;
+  return shard;
+}
+
+qint64 MetricCounter::value() const
+{
+  qint64 sum = 0;
+  for (const auto &shard : m_shards)
+    sum += shard.value.loadAcquire();
+  return sum;
+}
+
+void MetricHistogram::record(qint64 nsecs)
+{
+  auto &shard = m_shards[metricsShard()];
+  shard.count.fetchAndAddRelaxed(1);
+  shard.totalTime.fetchAndAddRelaxed(nsecs);
+
+  auto bucket = 0;
+  while (bucket < Buckets - 1 && nsecs > s_bucketBounds[bucket])
+    ++bucket;
+  shard.buckets[bucket].fetchAndAddRelaxed(1);
+}
+
+MetricsHistogram MetricHistogram::value() const
+{
+  static_assert(sizeof(s_bucketBounds) / sizeof(*s_bucketBounds)
+                    == Buckets - 1,
+                "The last bucket has no upper bound");
+
+  MetricsHistogram result;
+  result.bounds.reserve(Buckets - 1);
+  for (auto bound : s_bucketBounds)
+    result.bounds.append(bound);
+  result.buckets.fill(0, Buckets);
+
+  for (const auto &shard : m_shards) {
+    result.count += shard.count.loadAcquire();
+    result.totalTime += shard.totalTime.loadAcquire();
+    for (auto i = 0; i < Buckets; ++i)
+      result.buckets[i] += shard.buckets[i].loadAcquire();
+  }
+  return result;
+}
+
+static thread_local EngineMetricsData *s_activeMetrics = nullptr;
+
+RenderMetricsScope::RenderMetricsScope(EngineMetricsData *metrics)
+    : m_previous(s_activeMetrics)
+{
+  s_activeMetrics = metrics;
+}
+
+RenderMetricsScope::~RenderMetricsScope() { s_activeMetrics = m_previous; }
+
+EngineMetricsData *RenderMetricsScope::active() { return s_activeMetrics; }
+
+QSharedPointer<MetricHistogram>
+EngineMetricsData::renderTimes(const QString &name)
+{
+  QMutexLocker locker(&m_mutex);
+  const auto recorded = m_renderTimes.contains(name)
+                        || m_renderTimes.size() < MaxRenderTimeNames;
+  auto &histogram = m_renderTimes[recorded ? name : QString()];
+  if (!histogram)
+    histogram = QSharedPointer<MetricHistogram>::create();
+  return histogram;
+}
+
+void EngineMetricsData::recordRenderError(Error error)
+{
+  if (error > NoError && error < ErrorCount)
+    m_renderErrors[error].add();
+}
+
+EngineMetrics EngineMetricsData::snapshot() const
+{
+  EngineMetrics metrics;
+  metrics.compileTimes = compileTimes.value();
+
+  for (auto i = 1; i < ErrorCount; ++i) {
+    const auto count = m_renderErrors[i].value();
+    if (count > 0)
+      metrics.renderErrors.insert(static_cast<Error>(i), count);
+  }
+
+  {
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_renderTimes.constBegin(); it != m_renderTimes.constEnd();
+         ++it) {
+      const auto histogram = it.value()->value();
+      if (histogram.count > 0)
+        metrics.renderTimes.insert(it.key(), histogram);
+    }
+  }
+
+  metrics.customTypeLookups = customTypeLookups.value();
+  return metrics;
+}
@@ -0,0 +1,159 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_ENGINEMETRICS_H
+#define GRANTLEE_ENGINEMETRICS_H
+
+#include "exception.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+
+namespace Grantlee
+{
+
+class AbstractTemplateLoader;
+
+/// @headerfile enginemetrics.h grantlee/enginemetrics.h
+
+/**
+  @brief A histogram of durations recorded by the Engine.
+
+  The duration of each recorded event is counted in the first bucket whose
+  upper bound is not exceeded. The last bucket counts the events which
+  exceed all of the @ref bounds.
+*/
+struct MetricsHistogram {
+  /**
+    The number of recorded events.
+  */
+  qint64 count = 0;
+
+  /**
+    The sum of the recorded durations in nanoseconds.
+  */
+  qint64 totalTime = 0;
+
+  /**
+    The inclusive upper bounds of the buckets in nanoseconds.
+  */
+  QVector<qint64> bounds;
+
+  /**
+    The number of events in each bucket. There is one more bucket than
+    there are @ref bounds.
+  */
+  QVector<qint64> buckets;
+};
+
+/// @headerfile enginemetrics.h grantlee/enginemetrics.h
+
+/**
+  @brief A snapshot of the metrics recorded by an Engine.
+
+  The Engine records metrics about loading, compiling and rendering its
+  Templates at all times. The counters are cheap enough to be left enabled
+  in production, and are aggregated when Engine::metrics is called.
+
+  @code
+    const auto metrics = engine->metrics();
+    qDebug() << "compiled" << metrics.compileTimes.count;
+    for (auto it = metrics.renderTimes.begin();
+         it != metrics.renderTimes.end(); ++it) {
+      qDebug() << it.key() << it.value().count << it.value().totalTime;
+    }
+  @endcode
+
+  @see Engine::metrics
+*/
+struct EngineMetrics {
+  /**
+    The use of a template loader by the Engine.
+  */
+  struct LoaderMetrics {
+    /**
+      The loader the metrics were recorded for.
+    */
+    QSharedPointer<AbstractTemplateLoader> loader;
+
+    /**
+      The number of Templates provided by the loader.
+    */
+    qint64 hits = 0;
+
+    /**
+      The number of times the loader did not provide a requested Template.
+    */
+    qint64 misses = 0;
+
+    /**
+      The number of Templates returned from the cache if the loader is a
+      CachingLoaderDecorator.
+    */
+    qint64 cacheHits = 0;
+
+    /**
+      The number of Templates which were not found in the cache if the
+      loader is a CachingLoaderDecorator.
+    */
+    qint64 cacheMisses = 0;
+
+    /**
+      The number of Templates removed from the cache if the loader is a
+      CachingLoaderDecorator.
+    */
+    qint64 evictions = 0;
+  };
+
+  /**
+    The time taken to compile each Template. The count of the histogram is
+    the number of Templates compiled.
+  */
+  MetricsHistogram compileTimes;
+
+  /**
+    The time taken to render Templates by the name of the Template. Up to
+    1024 names are recorded. Renders of Templates with further names are
+    recorded under an empty name.
+  */
+  QHash<QString, MetricsHistogram> renderTimes;
+
+  /**
+    The number of renders which failed by the Error raised.
+  */
+  QMap<Error, qint64> renderErrors;
+
+  /**
+    The use of each loader in the order of Engine::templateLoaders.
+  */
+  QVector<LoaderMetrics> loaders;
+
+  /**
+    The number of variable lookups which fell through to the introspection
+    functions registered with the MetaType system while Templates of the
+    Engine were rendered.
+  */
+  qint64 customTypeLookups = 0;
+};
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_ENGINEMETRICS_P_H
+#define GRANTLEE_ENGINEMETRICS_P_H
+
+#include "engine.h"
+#include "enginemetrics.h"
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QMutex>
+
+namespace Grantlee
+{
+
+/*
+  Counters are split into shards so that threads rendering at the same time
+  do not contend for the same cache line. Each thread always uses the same
+  shard, and the shards are summed when the counter is read.
+*/
+enum { MetricsShards = 8 };
+
+int metricsShard();
+
+class MetricCounter
+{
+public:
+  void add(qint64 value = 1)
+  {
+    m_shards[metricsShard()].value.fetchAndAddRelaxed(value);
+  }
+
+  qint64 value() const;
+
+private:
+  struct Shard {
+    QAtomicInteger<qint64> value;
+    char padding[64 - sizeof(QAtomicInteger<qint64>)];
+  };
+  Shard m_shards[MetricsShards];
+};
+
+class MetricHistogram
+{
+public:
+  void record(qint64 nsecs);
+
+  MetricsHistogram value() const;
+
+private:
+  enum { Buckets = 12 };
+
+  struct Shard {
+    QAtomicInteger<qint64> count;
+    QAtomicInteger<qint64> totalTime;
+    QAtomicInteger<qint64> buckets[Buckets];
+    char padding[64];
+  };
+  Shard m_shards[MetricsShards];
+};
+
+/*
+  The metrics of an Engine. They are shared with the Templates created by the
+  Engine, which may outlive it.
+*/
+class EngineMetricsData
+{
+public:
+  /*
+    Returns the histogram of render times of the Templates called @p name.
+    The histogram is looked up once when a Template is compiled, so that
+    rendering does not need to lock.
+
+    At most MaxRenderTimeNames names get their own histogram. Templates with
+    other names share the histogram of the empty name, so that an Engine
+    which creates Templates with generated names uses bounded memory.
+  */
+  QSharedPointer<MetricHistogram> renderTimes(const QString &name);
+
+  void recordRenderError(Error error);
+
+  EngineMetrics snapshot() const;
+
+  MetricHistogram compileTimes;
+  MetricCounter customTypeLookups;
+  Engine::MetricsCallback callback;
+
+  enum { MaxRenderTimeNames = 1024 };
+
+private:
+  enum { ErrorCount = CompileFunctionError + 1 };
+
+  MetricCounter m_renderErrors[ErrorCount];
+
+  mutable QMutex m_mutex;
+  QHash<QString, QSharedPointer<MetricHistogram>> m_renderTimes;
+};
+
+/*
+  The use of a template loader by an Engine.
+*/
+struct LoaderCounters {
+  MetricCounter hits;
+  MetricCounter misses;
+};
+
+/*
+  Makes @p metrics the metrics of the Engine whose Template is rendered on
+  the current thread while the scope exists. Lookups made during the render
+  are counted in them.
+*/
+class RenderMetricsScope
+{
+public:
+  explicit RenderMetricsScope(EngineMetricsData *metrics);
+  ~RenderMetricsScope();
+
+  /*
+    Returns the metrics of the Template rendered on the current thread, or
+    a null pointer if none is rendered.
+  */
+  static EngineMetricsData *active();
+
+private:
+  Q_DISABLE_COPY(RenderMetricsScope)
+
+  EngineMetricsData *const m_previous;
+};
+}
+
+#endif
@@ -20,6 +20,8 @@
 
 #include "filter.h"
 
+#include "util.h"
+
 using namespace Grantlee;
 
 Filter::~Filter() = default;
@@ -46,3 +48,23 @@ SafeString Filter::conditionalEscape(const SafeString &input) const
 }
 
 bool Filter::isSafe() const { return false; }
+
+StringFilter::~StringFilter() = default;
+
+QVariant StringFilter::doFilter(const QVariant &input,
+                                const QVariant &argument,
+                                bool autoescape) const
+{
+  return QVariant::fromValue(
+      filterString(getSafeString(input), argument, autoescape));
+}
+
+QString StringFilter::stringArgument(const QVariant &argument)
+{
+  return getSafeString(argument).get();
+}
+
+int StringFilter::intArgument(const QVariant &argument, bool *ok)
+{
+  return getSafeString(argument).get().toInt(ok);
+}
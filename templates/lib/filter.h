@@ -112,6 +112,69 @@ private:
   OutputStream *m_stream;
 #endif
 };
+
+/// @headerfile filter.h grantlee/filter.h
+
+/**
+  @brief Base class for filters which transform strings.
+
+  Most filters take the string value of their input and return a string. Such
+  filters can implement the **%StringFilter** interface instead of @ref
+  Filter::doFilter. The input is passed as a SafeString and the result is
+  returned as one, so that a chain of string filters such as
+
+  @code
+    {{ name|lower|truncatewords:5|escape }}
+  @endcode
+
+  is evaluated by FilterExpression without converting the string to and from
+  a QVariant between the filters.
+
+  The @ref stringArgument and @ref intArgument methods convert the argument of
+  the filter.
+
+  @see @ref filters
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEMPLATES_EXPORT StringFilter : public Filter
+{
+public:
+  /**
+    Destructor.
+  */
+  ~StringFilter() override;
+
+  /**
+    Reimplement to filter the string @p input given @p argument.
+
+    @p autoescape determines whether the autoescape feature is currently on or
+    off.
+
+    @see @ref autoescaping
+  */
+  virtual SafeString filterString(const SafeString &input,
+                                  const QVariant &argument = {},
+                                  bool autoescape = {}) const = 0;
+
+  /**
+    Calls @ref filterString with the string value of @p input.
+  */
+  QVariant doFilter(const QVariant &input, const QVariant &argument = {},
+                    bool autoescape = {}) const override;
+
+protected:
+  /**
+    Returns the string value of @p argument.
+  */
+  static QString stringArgument(const QVariant &argument);
+
+  /**
+    Returns @p argument converted to an integer. If @p ok is not null, it is
+    set to whether the conversion succeeded.
+  */
+  static int intArgument(const QVariant &argument, bool *ok = nullptr);
+};
 }
 
 #endif
@@ -24,8 +24,10 @@
 
 #include "exception.h"
 #include "filter.h"
+#include "memoryusage_p.h"
 #include "metatype.h"
 #include "parser.h"
+#include "renderprofiler_p.h"
 #include "util.h"
 
 using ArgFilter = QPair<QSharedPointer<Grantlee::Filter>, Grantlee::Variable>;
@@ -37,8 +39,16 @@ class FilterExpressionPrivate
 {
   FilterExpressionPrivate(FilterExpression *fe) : q_ptr(fe) {}
 
+  QVariant resolveArgument(int index, Context *c) const;
+  QVariant runFilter(int index, const QVariant &input, OutputStream *stream,
+                     Context *c) const;
+  SafeString runStringFilter(int index, const SafeString &input,
+                             OutputStream *stream, Context *c) const;
+
   Variable m_variable;
   QVector<ArgFilter> m_filters;
+  // The filters which are StringFilters, or null.
+  QVector<const StringFilter *> m_stringFilters;
   QStringList m_filterNames;
 
   Q_DECLARE_PUBLIC(FilterExpression)
@@ -127,6 +137,7 @@ FilterExpression::FilterExpression(const QString &varString, Parser *parser)
 
         d->m_filterNames << subString;
         d->m_filters << qMakePair(f, Variable());
+        d->m_stringFilters << dynamic_cast<const StringFilter *>(f.data());
 
       } else if (subString.startsWith(QLatin1Char(FILTER_ARGUMENT_SEPARATOR))) {
         if (d->m_filters.isEmpty()
@@ -198,52 +209,109 @@ FilterExpression &FilterExpression::operator=(const FilterExpression &other)
     return *this;
   d_ptr->m_variable = other.d_ptr->m_variable;
   d_ptr->m_filters = other.d_ptr->m_filters;
+  d_ptr->m_stringFilters = other.d_ptr->m_stringFilters;
   d_ptr->m_filterNames = other.d_ptr->m_filterNames;
   return *this;
 }
 
-QVariant FilterExpression::resolve(OutputStream *stream, Context *c) const
+QVariant FilterExpressionPrivate::resolveArgument(int index, Context *c) const
 {
-  Q_D(const FilterExpression);
-  auto var = d->m_variable.resolve(c);
+  const auto &argVar = m_filters.at(index).second;
+  auto arg = argVar.resolve(c);
+
+  if (arg.isValid()) {
+    Grantlee::SafeString argString;
+    if (arg.userType() == qMetaTypeId<Grantlee::SafeString>()) {
+      argString = arg.value<Grantlee::SafeString>();
+    } else if (arg.userType() == qMetaTypeId<QString>()) {
+      argString = Grantlee::SafeString(arg.value<QString>());
+    }
+    if (argVar.isConstant()) {
+      argString = markSafe(argString);
+    }
+    if (!argString.get().isEmpty()) {
+      arg = argString;
+    }
+  }
+  return arg;
+}
 
-  auto it = d->m_filters.constBegin();
-  const auto end = d->m_filters.constEnd();
-  for (; it != end; ++it) {
-    auto filter = it->first;
-    filter->setStream(stream);
-    const auto argVar = it->second;
-    auto arg = argVar.resolve(c);
-
-    if (arg.isValid()) {
-      Grantlee::SafeString argString;
-      if (arg.userType() == qMetaTypeId<Grantlee::SafeString>()) {
-        argString = arg.value<Grantlee::SafeString>();
-      } else if (arg.userType() == qMetaTypeId<QString>()) {
-        argString = Grantlee::SafeString(arg.value<QString>());
-      }
-      if (argVar.isConstant()) {
-        argString = markSafe(argString);
-      }
-      if (!argString.get().isEmpty()) {
-        arg = argString;
-      }
+QVariant FilterExpressionPrivate::runFilter(int index, const QVariant &input,
+                                            OutputStream *stream,
+                                            Context *c) const
+{
+  const auto &filter = m_filters.at(index).first;
+  filter->setStream(stream);
+  const auto arg = resolveArgument(index, c);
+
+  const auto varString = getSafeString(input);
+
+  QVariant var;
+  if (const auto profiler = c->renderProfiler()) {
+    ProfileScope scope(profiler, filter.data(), m_filterNames.at(index));
+    var = filter->doFilter(input, arg, c->autoEscape());
+  } else {
+    var = filter->doFilter(input, arg, c->autoEscape());
+  }
+
+  if (var.userType() == qMetaTypeId<Grantlee::SafeString>()
+      || var.userType() == qMetaTypeId<QString>()) {
+    if (filter->isSafe() && varString.isSafe()) {
+      var = markSafe(getSafeString(var));
+    } else if (varString.needsEscape()) {
+      var = markForEscaping(getSafeString(var));
+    } else {
+      var = getSafeString(var);
     }
+  }
+  return var;
+}
 
-    const auto varString = getSafeString(var);
+SafeString FilterExpressionPrivate::runStringFilter(int index,
+                                                    const SafeString &input,
+                                                    OutputStream *stream,
+                                                    Context *c) const
+{
+  const auto filter = m_stringFilters.at(index);
+  m_filters.at(index).first->setStream(stream);
+  const auto arg = resolveArgument(index, c);
+
+  SafeString result;
+  if (const auto profiler = c->renderProfiler()) {
+    ProfileScope scope(profiler, filter, m_filterNames.at(index));
+    result = filter->filterString(input, arg, c->autoEscape());
+  } else {
+    result = filter->filterString(input, arg, c->autoEscape());
+  }
 
-    var = filter->doFilter(var, arg, c->autoEscape());
+  // The same rules as in runFilter, applied to the unboxed string.
+  if (filter->isSafe() && input.isSafe())
+    return markSafe(result);
+  if (input.needsEscape())
+    return markForEscaping(result);
+  return result;
+}
 
-    if (var.userType() == qMetaTypeId<Grantlee::SafeString>()
-        || var.userType() == qMetaTypeId<QString>()) {
-      if (filter->isSafe() && varString.isSafe()) {
-        var = markSafe(getSafeString(var));
-      } else if (varString.needsEscape()) {
-        var = markForEscaping(getSafeString(var));
-      } else {
-        var = getSafeString(var);
-      }
+QVariant FilterExpression::resolve(OutputStream *stream, Context *c) const
+{
+  Q_D(const FilterExpression);
+  auto var = d->m_variable.resolve(c);
+
+  const auto size = d->m_filters.size();
+  auto i = 0;
+  while (i < size) {
+    if (!d->m_stringFilters.at(i)) {
+      var = d->runFilter(i, var, stream, c);
+      ++i;
+      continue;
     }
+
+    // Consecutive string filters pass the SafeString from one to the next
+    // without wrapping it in a QVariant.
+    auto str = getSafeString(var);
+    for (; i < size && d->m_stringFilters.at(i); ++i)
+      str = d->runStringFilter(i, str, stream, c);
+    var = QVariant::fromValue(str);
   }
   (*stream) << getSafeString(var).get();
   return var;
@@ -273,3 +341,14 @@ QStringList FilterExpression::filters() const
   Q_D(const FilterExpression);
   return d->m_filterNames;
 }
+
+qint64 FilterExpression::memoryUsage() const
+{
+  Q_D(const FilterExpression);
+  auto size = qint64(sizeof(FilterExpressionPrivate))
+              + d->m_variable.memoryUsage() + heapSize(d->m_filters)
+              + heapSize(d->m_stringFilters) + heapSize(d->m_filterNames);
+  for (const auto &filter : d->m_filters)
+    size += filter.second.memoryUsage();
+  return size;
+}
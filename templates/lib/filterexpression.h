@@ -191,6 +191,13 @@ public:
   QStringList filters() const;
 #endif
 
+  /**
+    Returns an estimate of the memory in bytes retained by this
+    **%FilterExpression** on the heap. The filters themselves are shared by
+    all Templates of an Engine and are not included.
+  */
+  qint64 memoryUsage() const;
+
 private:
   Q_DECLARE_PRIVATE(FilterExpression)
   FilterExpressionPrivate *const d_ptr;
@@ -0,0 +1,111 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_GENERATOR_H
+#define GRANTLEE_GENERATOR_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QVariant>
+
+namespace Grantlee
+{
+
+/// @headerfile generator.h grantlee/generator.h
+
+/**
+  @brief Interface for producing the items of a @gr_tag{for} loop on demand.
+
+  Rendering a loop over a QVariantList requires all of the items to exist
+  before rendering starts. An **%AbstractGenerator** instead produces one
+  item at a time, so that huge or unbounded sequences can be rendered in
+  bounded memory.
+
+  @code
+    class CounterGenerator : public Grantlee::AbstractGenerator
+    {
+    public:
+      void reset() override { m_current = 0; }
+      bool hasNext() override { return m_current < 1000000; }
+      QVariant next() override { return m_current++; }
+
+    private:
+      int m_current = 0;
+    };
+
+    CounterGenerator generator;
+    c.insert("numbers", &generator);
+    t->render(&c);
+  @endcode
+
+  The Context does not take ownership of the generator, which must outlive
+  the renders which use it.
+
+  Because the number of items is not known in advance, the
+  <tt>forloop.revcounter</tt> and <tt>forloop.revcounter0</tt> variables are
+  not available while iterating over a generator. A <tt>reversed</tt> loop
+  collects all items before rendering.
+
+  Instances of QAbstractItemModel may also be iterated directly in a
+  @gr_tag{for} loop. Each item is a QModelIndex whose role names and column
+  headers may be looked up in the template, as well as its <tt>row</tt> and
+  <tt>column</tt> if the model has no role or header of those names. They are read once when the
+  loop starts. If the model can fetch more rows when the loop starts, rows
+  are fetched incrementally with QAbstractItemModel::fetchMore, one batch
+  ahead of the current row. <tt>forloop.revcounter</tt> and
+  <tt>forloop.revcounter0</tt> are then not available for any row, while
+  <tt>forloop.last</tt> is.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEMPLATES_EXPORT AbstractGenerator : public QObject
+{
+  Q_OBJECT
+public:
+  /**
+    Constructor
+  */
+  explicit AbstractGenerator(QObject *parent = {});
+
+  /**
+    Destructor
+  */
+  ~AbstractGenerator() override;
+
+  /**
+    Restarts the sequence. This is called each time a loop starts iterating
+    over the generator. The base implementation does nothing.
+  */
+  virtual void reset();
+
+  /**
+    Returns whether another item is available.
+  */
+  virtual bool hasNext() = 0;
+
+  /**
+    Returns the next item and advances the generator.
+  */
+  virtual QVariant next() = 0;
+};
+}
+
+#endif
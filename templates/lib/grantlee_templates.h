@@ -23,23 +23,29 @@
 
 #include "grantlee/abstractlocalizer.h"
 #include "grantlee/cachingloaderdecorator.h"
+#include "grantlee/compiledtemplate.h"
 #include "grantlee/context.h"
 #include "grantlee/engine.h"
+#include "grantlee/enginemetrics.h"
 #include "grantlee/exception.h"
 #include "grantlee/filter.h"
 #include "grantlee/filterexpression.h"
+#include "grantlee/generator.h"
 #include "grantlee/grantlee_version.h"
+#include "grantlee/lazyvalue.h"
 #include "grantlee/metatype.h"
 #include "grantlee/node.h"
 #include "grantlee/outputstream.h"
 #include "grantlee/parser.h"
 #include "grantlee/qtlocalizer.h"
 #include "grantlee/rendercontext.h"
+#include "grantlee/renderprofiler.h"
 #include "grantlee/safestring.h"
 #include "grantlee/taglibraryinterface.h"
 #include "grantlee/template.h"
 #include "grantlee/templateloader.h"
 #include "grantlee/token.h"
+#include "grantlee/tracer.h"
 #include "grantlee/typeaccessor.h"
 #include "grantlee/util.h"
 #include "grantlee/variable.h"
@@ -0,0 +1,87 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "lazyvalue.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+
+#include <utility>
+
+namespace Grantlee
+{
+
+class LazyValuePrivate
+{
+public:
+  LazyValuePrivate(std::function<QVariant()> function)
+      : m_function(std::move(function))
+  {
+  }
+
+  std::function<QVariant()> m_function;
+  QMutex m_mutex;
+  QAtomicInt m_evaluated;
+  QVariant m_value;
+};
+}
+
+using namespace Grantlee;
+
+LazyValue::LazyValue() {}
+
+LazyValue::LazyValue(std::function<QVariant()> function)
+    : d(function ? new LazyValuePrivate(std::move(function)) : nullptr)
+{
+}
+
+bool LazyValue::isValid() const { return !d.isNull(); }
+
+bool LazyValue::isEvaluated() const
+{
+  return d && d->m_evaluated.loadAcquire();
+}
+
+QVariant LazyValue::value() const
+{
+  if (!d)
+    return {};
+
+  if (d->m_evaluated.loadAcquire())
+    return d->m_value;
+
+  QMutexLocker locker(&d->m_mutex);
+  if (!d->m_evaluated.loadAcquire()) {
+    // A thunk may produce another thunk. Flatten it so that callers always
+    // receive a concrete value.
+    d->m_value = resolve(d->m_function());
+    // Release anything captured by the function as early as possible.
+    d->m_function = nullptr;
+    d->m_evaluated.storeRelease(1);
+  }
+  return d->m_value;
+}
+
+QVariant LazyValue::resolve(const QVariant &input)
+{
+  if (input.userType() != qMetaTypeId<LazyValue>())
+    return input;
+  return input.value<LazyValue>().value();
+}
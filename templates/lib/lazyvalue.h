@@ -0,0 +1,108 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_LAZYVALUE_H
+#define GRANTLEE_LAZYVALUE_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVariant>
+
+#include <functional>
+
+namespace Grantlee
+{
+
+class LazyValuePrivate;
+
+/// @headerfile lazyvalue.h grantlee/lazyvalue.h
+
+/**
+  @brief A value which is computed only when a Template first accesses it.
+
+  Some values are expensive to compute, but are only used by some branches of
+  a Template. A **%LazyValue** wraps a function which is called the first time
+  the value is looked up, and whose result is reused for every later access.
+
+  @code
+    Context c;
+    c.insert("books", LazyValue([&db] {
+      return QVariant::fromValue(db.allBooks());
+    }));
+
+    // db.allBooks() is only called if the template uses "books".
+    t->render(&c);
+  @endcode
+
+  A **%LazyValue** may be inserted into a Context, or be nested inside
+  containers and QObject properties. Context::lookup and MetaType::lookup
+  evaluate it transparently.
+
+  Copies of a **%LazyValue** share the computed result. The function is called
+  at most once, even if the value is accessed concurrently from several
+  threads. The function must not access its own value.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEMPLATES_EXPORT LazyValue
+{
+public:
+  /**
+    Constructs an invalid **%LazyValue** which evaluates to an invalid
+    QVariant.
+  */
+  LazyValue();
+
+  /**
+    Constructs a **%LazyValue** which evaluates to the result of @p function.
+  */
+  explicit LazyValue(std::function<QVariant()> function);
+
+  /**
+    Returns whether this **%LazyValue** holds a function.
+  */
+  bool isValid() const;
+
+  /**
+    Returns whether the function has already been called.
+  */
+  bool isEvaluated() const;
+
+  /**
+    Returns the result of the function, calling it if this is the first
+    access.
+  */
+  QVariant value() const;
+
+  /**
+    Returns the evaluated content of @p input if it holds a **%LazyValue**,
+    or @p input otherwise.
+  */
+  static QVariant resolve(const QVariant &input);
+
+private:
+  QSharedPointer<LazyValuePrivate> d;
+};
+}
+
+Q_DECLARE_METATYPE(Grantlee::LazyValue)
+
+#endif
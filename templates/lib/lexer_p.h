@@ -21,6 +21,7 @@
 #ifndef GRANTLEE_LEXER_P_H
 #define GRANTLEE_LEXER_P_H
 
+#include "grantlee_test_export.h"
 #include "textprocessingmachine_p.h"
 #include "token.h"
 
@@ -29,7 +30,7 @@
 namespace Grantlee
 {
 
-class Lexer
+class GRANTLEE_TESTS_EXPORT Lexer
 {
 public:
   Lexer(const QString &templateString);
@@ -0,0 +1,56 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_LOCALIZERREVISION_P_H
+#define GRANTLEE_LOCALIZERREVISION_P_H
+
+#include "grantlee_test_export.h"
+
+namespace Grantlee
+{
+
+class AbstractLocalizer;
+
+/*
+  Returns a number which identifies the current translations of the
+  @p localizer, or -1 if they may not be cached.
+
+  Only the localizers of Grantlee have revisions, which change whenever
+  loading or unloading catalogs or translators can change the localized
+  text. Subclasses of them may localize differently, so they do not.
+*/
+GRANTLEE_TESTS_EXPORT int localizerRevision(const AbstractLocalizer *localizer);
+
+/*
+  Starts recording whether the text localized on this thread may be cached
+  with the localizerRevision.
+*/
+GRANTLEE_TESTS_EXPORT void beginCacheableTranslation();
+
+/*
+  Returns false if text localized on this thread since
+  beginCacheableTranslation was left to the translators of the application.
+  They may be installed in QCoreApplication at any time, so that text may
+  not be cached.
+*/
+GRANTLEE_TESTS_EXPORT bool endCacheableTranslation();
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "lookupkey_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMetaObject>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+using namespace Grantlee;
+
+namespace
+{
+struct AtomTable {
+  QMutex mutex;
+  QHash<QString, int> ids;
+  QVector<LookupKey> atoms;
+};
+}
+
+Q_GLOBAL_STATIC(AtomTable, atomTable)
+
+// The number of atoms. Atoms are never removed, so templates generated with
+// many distinct names must not grow the table forever.
+static const int s_maxAtoms = 4096;
+
+// The number of cached property indexes of each thread.
+static const int s_maxPropertyIndexes = 16384;
+
+static LookupKey::Builtin classifyBuiltin(const QString &segment)
+{
+  if (segment == QLatin1String("size"))
+    return LookupKey::Size;
+  if (segment == QLatin1String("count"))
+    return LookupKey::Count;
+  if (segment == QLatin1String("items"))
+    return LookupKey::Items;
+  if (segment == QLatin1String("keys"))
+    return LookupKey::Keys;
+  if (segment == QLatin1String("values"))
+    return LookupKey::Values;
+  if (segment == QLatin1String("children"))
+    return LookupKey::Children;
+  if (segment == QLatin1String("objectName"))
+    return LookupKey::ObjectName;
+  return LookupKey::NotBuiltin;
+}
+
+LookupKey::LookupKey(const QString &segment)
+    : name(segment), utf8Name(segment.toUtf8()), variantName(segment),
+      builtin(classifyBuiltin(segment))
+{
+  index = segment.toInt(&isIndex);
+}
+
+LookupKey LookupKey::intern(const QString &segment)
+{
+  auto table = atomTable();
+  QMutexLocker locker(&table->mutex);
+  const auto it = table->ids.constFind(segment);
+  if (it != table->ids.constEnd())
+    return table->atoms.at(it.value());
+
+  LookupKey key(segment);
+  if (table->atoms.size() < s_maxAtoms) {
+    key.atom = table->atoms.size();
+    table->ids.insert(segment, key.atom);
+    table->atoms.append(key);
+  }
+  return key;
+}
+
+static int findPropertyIndex(const QMetaObject *metaObject, const char *name)
+{
+  for (auto i = 0; i < metaObject->propertyCount(); ++i) {
+    if (qstrcmp(metaObject->property(i).name(), name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+int LookupKey::propertyIndex(const QMetaObject *metaObject) const
+{
+  if (atom < 0)
+    return findPropertyIndex(metaObject, utf8Name.constData());
+
+  // The properties of a meta object do not change, so the index is found
+  // once for each class and atom.
+  thread_local QHash<QPair<const QMetaObject *, int>, int> s_indexes;
+  const auto cacheKey = qMakePair(metaObject, atom);
+  const auto it = s_indexes.constFind(cacheKey);
+  if (it != s_indexes.constEnd())
+    return it.value();
+
+  if (s_indexes.size() >= s_maxPropertyIndexes)
+    s_indexes.clear();
+  const auto index = findPropertyIndex(metaObject, utf8Name.constData());
+  s_indexes.insert(cacheKey, index);
+  return index;
+}
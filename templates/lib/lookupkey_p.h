@@ -0,0 +1,94 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_LOOKUPKEY_P_H
+#define GRANTLEE_LOOKUPKEY_P_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+struct QMetaObject;
+
+namespace Grantlee
+{
+
+/*
+  A single segment of a Variable lookup such as "size" in "list.size",
+  classified once so that MetaType::lookup does not need to compare or parse
+  strings each time the Variable is resolved.
+*/
+class GRANTLEE_TEMPLATES_EXPORT LookupKey
+{
+public:
+  enum Builtin {
+    NotBuiltin,
+    Size,
+    Count,
+    Items,
+    Keys,
+    Values,
+    Children,
+    ObjectName
+  };
+
+  LookupKey() = default;
+
+  /*
+    Classifies @p segment without interning it. This is used for lookups
+    which are only performed once.
+  */
+  explicit LookupKey(const QString &segment);
+
+  /*
+    Returns the atom for @p segment from a global table. All keys for the
+    same segment share an atom id and the data of their name, UTF-8 name and
+    QVariant name. The table is capped, and segments which do not fit get a
+    key without an atom.
+  */
+  static LookupKey intern(const QString &segment);
+
+  /*
+    Looks up the property of @p object named by this key, as
+    MetaType::lookup does.
+  */
+  QVariant lookup(const QVariant &object) const;
+
+  /*
+    Returns the index of the first property of @p metaObject named by this
+    key, or -1. The index is cached per thread for keys with an atom.
+  */
+  int propertyIndex(const QMetaObject *metaObject) const;
+
+  QString name;
+  QByteArray utf8Name;
+  // The name as a QVariant, for the lookup of associative containers.
+  QVariant variantName;
+  // The id of the interned segment, or -1.
+  int atom = -1;
+  int index = -1;
+  bool isIndex = false;
+  Builtin builtin = NotBuiltin;
+};
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_MEMORYUSAGE_P_H
+#define GRANTLEE_MEMORYUSAGE_P_H
+
+#include "filterexpression.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+namespace Grantlee
+{
+
+class Node;
+
+/*
+  Estimates of the heap memory retained by Qt types, used to report the
+  memory retained by compiled Templates. They do not need to be exact, but
+  should grow with the amount of data retained.
+*/
+
+// The header of the shared data of QString, QByteArray and the containers.
+static const qint64 s_arrayDataSize = 3 * sizeof(void *);
+
+// QObjectPrivate is not public, but is at least this large.
+static const qint64 s_objectSize = sizeof(QObject) + 16 * sizeof(void *);
+
+inline qint64 heapSize(const QString &str)
+{
+  if (str.capacity() == 0)
+    return 0;
+  return s_arrayDataSize + (str.capacity() + 1) * qint64(sizeof(QChar));
+}
+
+inline qint64 heapSize(const QVariant &variant)
+{
+  if (variant.userType() == qMetaTypeId<QString>())
+    return heapSize(variant.value<QString>());
+  return 0;
+}
+
+template <typename Container> qint64 heapSize(const Container &container)
+{
+  if (container.isEmpty())
+    return 0;
+  const qint64 elementSize
+      = qMax(sizeof(typename Container::value_type), sizeof(void *));
+  return s_arrayDataSize + container.size() * elementSize;
+}
+
+inline qint64 heapSize(const QStringList &list)
+{
+  auto size = heapSize<QList<QString>>(list);
+  for (const auto &str : list)
+    size += heapSize(str);
+  return size;
+}
+
+inline qint64 heapSize(const QList<FilterExpression> &list)
+{
+  auto size = heapSize<QList<FilterExpression>>(list);
+  for (const auto &fe : list)
+    size += fe.memoryUsage();
+  return size;
+}
+
+/*
+  Implemented by Nodes which retain more memory than the Node base class.
+  This is not a virtual method of Node, so that the vtable of Node stays
+  compatible with plugins built against older releases.
+*/
+class GRANTLEE_TEMPLATES_EXPORT NodeMemoryUsage
+{
+public:
+  virtual ~NodeMemoryUsage();
+
+  /*
+    Returns the memory retained by the Node, including nodeSize, but
+    excluding its child nodes.
+  */
+  virtual qint64 memoryUsage() const = 0;
+
+  /*
+    Returns the memory retained by the Node base class.
+  */
+  static qint64 nodeSize();
+};
+
+/*
+  Returns the memory retained by @p node, excluding its child nodes. This
+  is the nodeSize of Nodes which do not implement NodeMemoryUsage.
+*/
+GRANTLEE_TEMPLATES_EXPORT qint64 nodeMemoryUsage(const Node *node);
+}
+
+#endif
@@ -22,6 +22,9 @@
 #include "metatype.h"
 
 #include "customtyperegistry_p.h"
+#include "enginemetrics_p.h"
+#include "lazyvalue.h"
+#include "lookupkey_p.h"
 #include "metaenumvariable_p.h"
 
 #include <QtCore/QAssociativeIterable>
@@ -31,7 +34,6 @@
 using namespace Grantlee;
 
 Q_GLOBAL_STATIC(CustomTypeRegistry, customTypes)
-
 void Grantlee::MetaType::internalLock() { return customTypes()->mutex.lock(); }
 
 void Grantlee::MetaType::internalUnlock()
@@ -48,11 +50,11 @@ void Grantlee::MetaType::registerLookUpOperator(int id, LookupFunction f)
 }
 
 static QVariant doQobjectLookUp(const QObject *const object,
-                                const QString &property)
+                                const LookupKey &key)
 {
   if (!object)
     return {};
-  if (property == QStringLiteral("children")) {
+  if (key.builtin == LookupKey::Children) {
     const auto &childList = object->children();
     if (childList.isEmpty())
       return {};
@@ -65,21 +67,18 @@ static QVariant doQobjectLookUp(const QObject *const object,
     return children;
   }
 
-  if (property == QStringLiteral("objectName")) {
+  if (key.builtin == LookupKey::ObjectName) {
     return object->objectName();
   }
   // Can't be const because of invokeMethod.
   auto metaObj = object->metaObject();
+  const auto propertyName = key.utf8Name.constData();
 
-  QMetaProperty mp;
-  for (auto i = 0; i < metaObj->propertyCount(); ++i) {
-    // TODO only read-only properties should be allowed here.
-    // This might also handle the variant messing I hit before.
-    mp = metaObj->property(i);
-
-    if (QString::fromUtf8(mp.name()) != property)
-      continue;
-
+  // TODO only read-only properties should be allowed here.
+  // This might also handle the variant messing I hit before.
+  const auto propertyIndex = key.propertyIndex(metaObj);
+  if (propertyIndex >= 0) {
+    const auto mp = metaObj->property(propertyIndex);
     if (mp.isEnumType()) {
       MetaEnumVariable mev(mp.enumerator(), mp.read(object).value<int>());
       return QVariant::fromValue(mev);
@@ -91,12 +90,12 @@ static QVariant doQobjectLookUp(const QObject *const object,
   for (auto i = 0; i < metaObj->enumeratorCount(); ++i) {
     me = metaObj->enumerator(i);
 
-    if (QLatin1String(me.name()) == property) {
+    if (qstrcmp(me.name(), propertyName) == 0) {
       MetaEnumVariable mev(me);
       return QVariant::fromValue(mev);
     }
 
-    const auto value = me.keyToValue(property.toLatin1().constData());
+    const auto value = me.keyToValue(propertyName);
 
     if (value < 0)
       continue;
@@ -105,45 +104,50 @@ static QVariant doQobjectLookUp(const QObject *const object,
 
     return QVariant::fromValue(mev);
   }
-  return object->property(property.toUtf8().constData());
+  return object->property(propertyName);
 }
 
-QVariant Grantlee::MetaType::lookup(const QVariant &object,
-                                    const QString &property)
+static QVariant doLookUp(const QVariant &object, const LookupKey &key)
 {
   if (object.canConvert<QObject *>()) {
-    return doQobjectLookUp(object.value<QObject *>(), property);
+    return doQobjectLookUp(object.value<QObject *>(), key);
   }
   if (object.canConvert<QVariantList>()) {
     auto iter = object.value<QSequentialIterable>();
-    if (property == QStringLiteral("size")
-        || property == QStringLiteral("count")) {
+    if (key.builtin == LookupKey::Size || key.builtin == LookupKey::Count) {
       return iter.size();
     }
 
-    auto ok = false;
-    const auto listIndex = property.toInt(&ok);
-
-    if (!ok || listIndex >= iter.size()) {
+    if (!key.isIndex || key.index < 0 || key.index >= iter.size()) {
       return {};
     }
 
-    return iter.at(listIndex);
+    return iter.at(key.index);
   }
   if (object.canConvert<QVariantHash>()) {
+    // A QVariantHash is searched by the name of the key without creating an
+    // iterable or converting the name.
+    const auto isHash = object.userType() == qMetaTypeId<QVariantHash>();
+    if (isHash) {
+      const auto hash = static_cast<const QVariantHash *>(object.constData());
+      const auto it = hash->constFind(key.name);
+      if (it != hash->constEnd())
+        return it.value();
+      if (key.builtin == LookupKey::NotBuiltin)
+        return {};
+    }
 
     auto iter = object.value<QAssociativeIterable>();
 
-    if (iter.find(property) != iter.end()) {
-      return iter.value(property);
+    if (!isHash && iter.find(key.variantName) != iter.end()) {
+      return iter.value(key.variantName);
     }
 
-    if (property == QStringLiteral("size")
-        || property == QStringLiteral("count")) {
+    switch (key.builtin) {
+    case LookupKey::Size:
+    case LookupKey::Count:
       return iter.size();
-    }
-
-    if (property == QStringLiteral("items")) {
+    case LookupKey::Items: {
       auto it = iter.begin();
       const auto end = iter.end();
       QVariantList list;
@@ -152,8 +156,7 @@ QVariant Grantlee::MetaType::lookup(const QVariant &object,
       }
       return list;
     }
-
-    if (property == QStringLiteral("keys")) {
+    case LookupKey::Keys: {
       auto it = iter.begin();
       const auto end = iter.end();
       QVariantList list;
@@ -162,8 +165,7 @@ QVariant Grantlee::MetaType::lookup(const QVariant &object,
       }
       return list;
     }
-
-    if (property == QStringLiteral("values")) {
+    case LookupKey::Values: {
       auto it = iter.begin();
       const auto end = iter.end();
       QVariantList list;
@@ -172,6 +174,9 @@ QVariant Grantlee::MetaType::lookup(const QVariant &object,
       }
       return list;
     }
+    default:
+      break;
+    }
 
     return {};
   }
@@ -179,7 +184,8 @@ QVariant Grantlee::MetaType::lookup(const QVariant &object,
   if (mo) {
     QMetaType mt(object.userType());
     if (mt.flags().testFlag(QMetaType::IsGadget)) {
-      const auto idx = mo->indexOfProperty(property.toUtf8().constData());
+      const auto propertyName = key.utf8Name.constData();
+      const auto idx = mo->indexOfProperty(propertyName);
       if (idx >= 0) {
         const auto mp = mo->property(idx);
 
@@ -197,12 +203,12 @@ QVariant Grantlee::MetaType::lookup(const QVariant &object,
       for (auto i = 0; i < mo->enumeratorCount(); ++i) {
         me = mo->enumerator(i);
 
-        if (QLatin1String(me.name()) == property) {
+        if (qstrcmp(me.name(), propertyName) == 0) {
           MetaEnumVariable mev(me);
           return QVariant::fromValue(mev);
         }
 
-        const auto value = me.keyToValue(property.toLatin1().constData());
+        const auto value = me.keyToValue(propertyName);
 
         if (value < 0) {
           continue;
@@ -214,7 +220,22 @@ QVariant Grantlee::MetaType::lookup(const QVariant &object,
     }
   }
 
-  return customTypes()->lookup(object, property);
+  if (const auto metrics = RenderMetricsScope::active())
+    metrics->customTypeLookups.add();
+  return customTypes()->lookup(object, key.name);
+}
+
+QVariant Grantlee::MetaType::lookup(const QVariant &object,
+                                    const QString &property)
+{
+  return LookupKey(property).lookup(object);
+}
+
+QVariant LookupKey::lookup(const QVariant &object) const
+{
+  // Lazy values may appear both as the object being introspected and as the
+  // result of the lookup, for example as values of a hash.
+  return LazyValue::resolve(doLookUp(LazyValue::resolve(object), *this));
 }
 
 bool Grantlee::MetaType::lookupAlreadyRegistered(int id)
@@ -0,0 +1,77 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_MODELINDEXLOOKUP_P_H
+#define GRANTLEE_MODELINDEXLOOKUP_P_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+class QAbstractItemModel;
+class QModelIndex;
+class QVariant;
+
+namespace Grantlee
+{
+
+/**
+  @internal
+
+  Maps the role names and horizontal header labels of a model to the role
+  or column which looking them up on an index of the model returns.
+
+  The @gr_tag{for} tag creates one while it iterates a model, so that the
+  names are read once for the loop instead of once for each lookup on each
+  row. Lookups on top level indexes of the model use the most recently
+  created **%ModelIndexLookup** of the current thread until it is destroyed.
+*/
+class GRANTLEE_TEMPLATES_EXPORT ModelIndexLookup
+{
+public:
+  explicit ModelIndexLookup(const QAbstractItemModel *model);
+  ~ModelIndexLookup();
+
+  /**
+    Returns the lookup of the current thread for @p model, or a null
+    pointer if there is none.
+  */
+  static const ModelIndexLookup *active(const QAbstractItemModel *model);
+
+  /**
+    Sets @p result to the data of the role or column called @p property of
+    the row of @p index. Returns false if the model has no role or column
+    called @p property.
+  */
+  bool lookUp(const QModelIndex &index, const QString &property,
+              QVariant *result) const;
+
+private:
+  Q_DISABLE_COPY(ModelIndexLookup)
+
+  const QAbstractItemModel *const m_model;
+  const ModelIndexLookup *const m_previous;
+  QHash<QString, int> m_roles;
+  QHash<QString, int> m_columns;
+};
+}
+
+#endif
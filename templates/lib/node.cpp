@@ -20,8 +20,11 @@
 
 #include "node.h"
 
+#include "memoryusage_p.h"
 #include "metaenumvariable_p.h"
 #include "nodebuiltins_p.h"
+#include "renderprofiler_p.h"
+#include "renderprogram_p.h"
 #include "template.h"
 #include "util.h"
 
@@ -34,9 +37,18 @@ namespace Grantlee
 
 class NodePrivate
 {
-  NodePrivate(Node *node) : q_ptr(node) {}
+  NodePrivate(Node *node) : q_ptr(node), m_lineNumber(-1) {}
   Q_DECLARE_PUBLIC(Node)
   Node *const q_ptr;
+
+  int m_lineNumber;
+
+public:
+  static void streamValueInContext(const Node *node, OutputStream *stream,
+                                   const QVariant &input, Context *c)
+  {
+    node->streamValueInContext(stream, input, c);
+  }
 };
 
 class AbstractNodeFactoryPrivate
@@ -85,6 +97,38 @@ Node::Node(QObject *parent) : QObject(parent), d_ptr(new NodePrivate(this)) {}
 
 Node::~Node() { delete d_ptr; }
 
+NodeMemoryUsage::~NodeMemoryUsage() = default;
+
+qint64 NodeMemoryUsage::nodeSize()
+{
+  return s_objectSize + sizeof(Node) - sizeof(QObject) + sizeof(NodePrivate);
+}
+
+qint64 Grantlee::nodeMemoryUsage(const Node *node)
+{
+  if (const auto usage = dynamic_cast<const NodeMemoryUsage *>(node))
+    return usage->memoryUsage();
+  return NodeMemoryUsage::nodeSize();
+}
+
+void Grantlee::streamNodeValue(const Node *node, OutputStream *stream,
+                               const QVariant &input, Context *c)
+{
+  NodePrivate::streamValueInContext(node, stream, input, c);
+}
+
+int Node::lineNumber() const
+{
+  Q_D(const Node);
+  return d->m_lineNumber;
+}
+
+void Node::setLineNumber(int line)
+{
+  Q_D(Node);
+  d->m_lineNumber = line;
+}
+
 void Node::streamValueInContext(OutputStream *stream, const QVariant &input,
                                 Context *c) const
 {
@@ -175,8 +219,24 @@ bool NodeList::containsNonText() const { return m_containsNonText; }
 
 void NodeList::render(OutputStream *stream, Context *c) const
 {
+  const auto profiler = c->renderProfiler();
+  if (!profiler) {
+    for (auto i = 0; i < this->size(); ++i) {
+      this->at(i)->render(stream, c);
+    }
+    return;
+  }
+
   for (auto i = 0; i < this->size(); ++i) {
-    this->at(i)->render(stream, c);
+    const auto node = this->at(i);
+    // Text is not worth a frame of its own. Its time is attributed to the
+    // enclosing node.
+    if (qobject_cast<TextNode *>(node)) {
+      node->render(stream, c);
+      continue;
+    }
+    ProfileScope scope(profiler, node);
+    node->render(stream, c);
   }
 }
 
@@ -110,6 +110,19 @@ public:
   { // krazy:exclude:inline
     return false;
   }
+
+  /**
+    @internal
+
+    Returns the line of the Template at which this **%Node** starts, or -1
+    if it is not known.
+  */
+  int lineNumber() const;
+
+  /**
+    @internal
+  */
+  void setLineNumber(int line);
 #endif
 
 protected:
@@ -128,6 +141,8 @@ protected:
   TemplateImpl *containerTemplate() const;
 
 private:
+  friend class RenderProfilerPrivate;
+
   Q_DECLARE_PRIVATE(Node)
   NodePrivate *const d_ptr;
 };
@@ -20,6 +20,10 @@
 
 #include "nodebuiltins_p.h"
 
+#include "memoryusage_p.h"
+#include "renderprogram_p.h"
+#include "util.h"
+
 using namespace Grantlee;
 
 TextNode::TextNode(const QString &content, QObject *parent)
@@ -27,6 +31,18 @@ TextNode::TextNode(const QString &content, QObject *parent)
 {
 }
 
+qint64 TextNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(TextNode) - sizeof(Node)
+         + heapSize(m_content);
+}
+
+bool TextNode::compile(RenderProgram *program) const
+{
+  program->appendText(m_content);
+  return true;
+}
+
 VariableNode::VariableNode(const FilterExpression &fe, QObject *parent)
     : Node(parent), m_filterExpression(fe)
 {
@@ -40,4 +56,24 @@ void VariableNode::render(OutputStream *stream, Context *c) const
   streamValueInContext(stream, v, c);
 }
 
+qint64 VariableNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(VariableNode) - sizeof(Node)
+         + m_filterExpression.memoryUsage();
+}
+
+bool VariableNode::compile(RenderProgram *program) const
+{
+  const auto &variable = m_filterExpression.variable();
+  if (variable.isLocalized() && variable.isConstant()
+      && m_filterExpression.filters().isEmpty()) {
+    program->appendLocalizedText(this, [this](Context *c) -> QString {
+      return getSafeString(m_filterExpression.resolve(c));
+    });
+    return true;
+  }
+  program->appendVariable(this, m_filterExpression);
+  return true;
+}
+
 #include "moc_nodebuiltins_p.cpp"
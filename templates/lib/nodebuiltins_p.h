@@ -21,7 +21,9 @@
 #ifndef NODE_BUILTINS_H
 #define NODE_BUILTINS_H
 
+#include "memoryusage_p.h"
 #include "node.h"
+#include "renderprogram_p.h"
 
 namespace Grantlee
 {
@@ -32,7 +34,9 @@ namespace Grantlee
   A Node for plain text. Plain text is everything between variables, comments
   and template tags.
 */
-class GRANTLEE_TEMPLATES_EXPORT TextNode : public Node
+class GRANTLEE_TEMPLATES_EXPORT TextNode : public Node,
+                                           public NodeMemoryUsage,
+                                           public CompilableNode
 {
   Q_OBJECT
 public:
@@ -44,6 +48,10 @@ public:
     (*stream) << m_content;
   }
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
 private:
   const QString m_content;
 };
@@ -53,7 +61,9 @@ private:
 
   A node for a variable or filter expression substitution.
 */
-class GRANTLEE_TEMPLATES_EXPORT VariableNode : public Node
+class GRANTLEE_TEMPLATES_EXPORT VariableNode : public Node,
+                                               public NodeMemoryUsage,
+                                               public CompilableNode
 {
   Q_OBJECT
 public:
@@ -61,6 +71,10 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
 private:
   FilterExpression m_filterExpression;
 };
@@ -51,6 +51,17 @@ public:
   NodeList parse(QObject *parent, const QStringList &stopAt);
 
   void openLibrary(TagLibraryInterface *library);
+  void deferLibrary(const QString &name, const QStringList &tags,
+                    const QStringList &filters);
+  bool loadDeferredLibrary(const QString &libraryName);
+
+  /**
+    Returns the filter called @p name, loading the library which provides it
+    if it was deferred, or a null pointer if there is none.
+  */
+  QSharedPointer<Filter> filter(const QString &name);
+
+  Engine *engine() const;
   Q_DECLARE_PUBLIC(Parser)
   Parser *const q_ptr;
 
@@ -59,32 +70,100 @@ public:
   QHash<QString, AbstractNodeFactory *> m_nodeFactories;
   QHash<QString, QSharedPointer<Filter>> m_filters;
 
+  // The library which provides each tag or filter not yet loaded.
+  QHash<QString, QString> m_deferredTags;
+  QHash<QString, QString> m_deferredFilters;
+
   NodeList m_nodeList;
 };
 }
 
-void ParserPrivate::openLibrary(TagLibraryInterface *library)
+Engine *ParserPrivate::engine() const
 {
-  Q_Q(Parser);
+  Q_Q(const Parser);
 
   auto ti = qobject_cast<TemplateImpl *>(q->parent());
 
   auto cengine = ti->engine();
   Q_ASSERT(cengine);
-  auto engine = const_cast<Engine *>(cengine);
+  return const_cast<Engine *>(cengine);
+}
+
+void ParserPrivate::openLibrary(TagLibraryInterface *library)
+{
+  auto engine = this->engine();
 
   auto factories = library->nodeFactories();
   for (auto nodeIt = factories.begin(), nodeEnd = factories.end();
        nodeIt != nodeEnd; ++nodeIt) {
     nodeIt.value()->setEngine(engine);
     m_nodeFactories.insert(nodeIt.key(), nodeIt.value());
+    m_deferredTags.remove(nodeIt.key());
   }
   auto filters = library->filters();
   for (auto filterIt = filters.begin(), filterEnd = filters.end();
        filterIt != filterEnd; ++filterIt) {
     auto f = QSharedPointer<Filter>(filterIt.value());
     m_filters.insert(filterIt.key(), f);
+    m_deferredFilters.remove(filterIt.key());
+  }
+}
+
+void ParserPrivate::deferLibrary(const QString &name, const QStringList &tags,
+                                 const QStringList &filters)
+{
+  for (const auto &tag : tags)
+    m_deferredTags.insert(tag, name);
+  for (const auto &filter : filters)
+    m_deferredFilters.insert(filter, name);
+}
+
+bool ParserPrivate::loadDeferredLibrary(const QString &libraryName)
+{
+  if (libraryName.isEmpty())
+    return false;
+
+  auto library = engine()->loadLibrary(libraryName);
+  if (!library)
+    return false;
+
+  auto engine = this->engine();
+
+  // Only take the tags and filters which were not overridden by libraries
+  // opened after this one was deferred.
+  auto factories = library->nodeFactories();
+  for (auto nodeIt = factories.begin(), nodeEnd = factories.end();
+       nodeIt != nodeEnd; ++nodeIt) {
+    if (m_deferredTags.value(nodeIt.key()) != libraryName) {
+      delete nodeIt.value();
+      continue;
+    }
+    nodeIt.value()->setEngine(engine);
+    m_nodeFactories.insert(nodeIt.key(), nodeIt.value());
   }
+  auto filters = library->filters();
+  for (auto filterIt = filters.begin(), filterEnd = filters.end();
+       filterIt != filterEnd; ++filterIt) {
+    if (m_deferredFilters.value(filterIt.key()) != libraryName) {
+      delete filterIt.value();
+      continue;
+    }
+    m_filters.insert(filterIt.key(), QSharedPointer<Filter>(filterIt.value()));
+  }
+
+  for (auto it = m_deferredTags.begin(); it != m_deferredTags.end();) {
+    if (it.value() == libraryName)
+      it = m_deferredTags.erase(it);
+    else
+      ++it;
+  }
+  for (auto it = m_deferredFilters.begin(); it != m_deferredFilters.end();) {
+    if (it.value() == libraryName)
+      it = m_deferredFilters.erase(it);
+    else
+      ++it;
+  }
+  return true;
 }
 
 Parser::Parser(const QList<Token> &tokenList, QObject *parent)
@@ -92,14 +171,17 @@ Parser::Parser(const QList<Token> &tokenList, QObject *parent)
 {
   Q_D(Parser);
 
-  auto ti = qobject_cast<TemplateImpl *>(parent);
-
-  auto cengine = ti->engine();
-  Q_ASSERT(cengine);
-
-  auto engine = const_cast<Engine *>(cengine);
+  auto engine = d->engine();
   engine->loadDefaultLibraries();
   for (const QString &libraryName : engine->defaultLibraries()) {
+    // Libraries which declare their content are only loaded if the
+    // template uses it.
+    QStringList tags;
+    QStringList filters;
+    if (engine->canDeferLibrary(libraryName, &tags, &filters)) {
+      d->deferLibrary(libraryName, tags, filters);
+      continue;
+    }
     auto library = engine->loadLibrary(libraryName);
     if (!library)
       continue;
@@ -118,11 +200,7 @@ Parser::~Parser()
 void Parser::loadLib(const QString &name)
 {
   Q_D(Parser);
-  auto ti = qobject_cast<TemplateImpl *>(parent());
-  auto cengine = ti->engine();
-  Q_ASSERT(cengine);
-  auto engine = const_cast<Engine *>(cengine);
-  auto library = engine->loadLibrary(name);
+  auto library = d->engine()->loadLibrary(name);
   if (!library)
     return;
   d->openLibrary(library);
@@ -153,13 +231,20 @@ void Parser::skipPast(const QString &tag)
       QStringLiteral("No closing tag found for %1").arg(tag));
 }
 
+QSharedPointer<Filter> ParserPrivate::filter(const QString &name)
+{
+  if (m_deferredFilters.contains(name))
+    loadDeferredLibrary(m_deferredFilters.value(name));
+  return m_filters.value(name);
+}
+
 QSharedPointer<Filter> Parser::getFilter(const QString &name) const
 {
-  Q_D(const Parser);
-  const auto it = d->m_filters.constFind(name);
-  if (it != d->m_filters.constEnd()) {
-    return it.value();
-  }
+  // Loading a deferred library changes the parser state, but not the result
+  // of parsing, so it is done through the non-const private.
+  const auto filter = d_ptr->filter(name);
+  if (filter)
+    return filter;
   throw Grantlee::Exception(UnknownFilterError,
                             QStringLiteral("Unknown filter: %1").arg(name));
 }
@@ -214,8 +299,9 @@ NodeList ParserPrivate::parse(QObject *parent, const QStringList &stopAt)
                                       .arg(q->parent()->objectName()));
       }
 
-      nodeList = extendNodeList(nodeList,
-                                new VariableNode(filterExpression, parent));
+      auto variableNode = new VariableNode(filterExpression, parent);
+      variableNode->setLineNumber(token.linenumber);
+      nodeList = extendNodeList(nodeList, variableNode);
     } else {
       Q_ASSERT(token.tokenType == BlockToken);
       const auto command = token.content.section(QLatin1Char(' '), 0, 0);
@@ -237,6 +323,9 @@ NodeList ParserPrivate::parse(QObject *parent, const QStringList &stopAt)
         throw Grantlee::Exception(EmptyBlockTagError, message);
       }
 
+      if (m_deferredTags.contains(command))
+        loadDeferredLibrary(m_deferredTags.value(command));
+
       auto nodeFactory = m_nodeFactories[command];
 
       // unknown tag.
@@ -265,6 +354,7 @@ NodeList ParserPrivate::parse(QObject *parent, const QStringList &stopAt)
       }
 
       n->setParent(parent);
+      n->setLineNumber(token.linenumber);
 
       nodeList = extendNodeList(nodeList, n);
     }
@@ -0,0 +1,232 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "pluginindex_p.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QPluginLoader>
+#include <QtCore/QSaveFile>
+
+using namespace Grantlee;
+
+static const int s_cacheFormatVersion = 1;
+
+static qint64 lastModified(const QFileInfo &info)
+{
+  if (!info.exists())
+    return -1;
+  return info.lastModified().toMSecsSinceEpoch();
+}
+
+static QStringList toStringList(const QJsonValue &value)
+{
+  QStringList list;
+  const auto array = value.toArray();
+  for (const auto &item : array)
+    list.append(item.toString());
+  return list;
+}
+
+PluginIndex::PluginIndex() : m_loaded(false), m_dirty(false) {}
+
+PluginIndex::~PluginIndex() = default;
+
+void PluginIndex::setCacheFile(const QString &fileName)
+{
+  if (fileName == m_cacheFile)
+    return;
+  m_cacheFile = fileName;
+  m_directories.clear();
+  m_loaded = false;
+  m_dirty = false;
+}
+
+QString PluginIndex::cacheFile() const { return m_cacheFile; }
+
+void PluginIndex::load()
+{
+  m_loaded = true;
+  if (m_cacheFile.isEmpty())
+    return;
+
+  QFile file(m_cacheFile);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  const auto root = QJsonDocument::fromJson(file.readAll()).object();
+  if (root.value(QStringLiteral("version")).toInt() != s_cacheFormatVersion)
+    return;
+
+  const auto directories
+      = root.value(QStringLiteral("directories")).toObject();
+  for (auto it = directories.constBegin(); it != directories.constEnd();
+       ++it) {
+    const auto dirObject = it.value().toObject();
+    DirectoryEntry entry;
+    entry.lastModified = static_cast<qint64>(
+        dirObject.value(QStringLiteral("lastModified")).toDouble());
+    entry.files = toStringList(dirObject.value(QStringLiteral("files")));
+
+    const auto plugins
+        = dirObject.value(QStringLiteral("plugins")).toObject();
+    for (auto pluginIt = plugins.constBegin(); pluginIt != plugins.constEnd();
+         ++pluginIt) {
+      const auto pluginObject = pluginIt.value().toObject();
+      PluginDeclaration declaration;
+      declaration.lastModified = static_cast<qint64>(
+          pluginObject.value(QStringLiteral("lastModified")).toDouble());
+      declaration.hasDeclaration
+          = pluginObject.value(QStringLiteral("hasDeclaration")).toBool();
+      declaration.tags
+          = toStringList(pluginObject.value(QStringLiteral("tags")));
+      declaration.filters
+          = toStringList(pluginObject.value(QStringLiteral("filters")));
+      entry.declarations.insert(pluginIt.key(), declaration);
+    }
+    m_directories.insert(it.key(), entry);
+  }
+}
+
+void PluginIndex::save()
+{
+  if (m_cacheFile.isEmpty() || !m_dirty)
+    return;
+
+  QJsonObject directories;
+  for (auto it = m_directories.constBegin(); it != m_directories.constEnd();
+       ++it) {
+    const auto &entry = it.value();
+    QJsonObject plugins;
+    for (auto pluginIt = entry.declarations.constBegin();
+         pluginIt != entry.declarations.constEnd(); ++pluginIt) {
+      const auto &declaration = pluginIt.value();
+      QJsonObject pluginObject;
+      pluginObject.insert(QStringLiteral("lastModified"),
+                          static_cast<double>(declaration.lastModified));
+      pluginObject.insert(QStringLiteral("hasDeclaration"),
+                          declaration.hasDeclaration);
+      pluginObject.insert(QStringLiteral("tags"),
+                          QJsonArray::fromStringList(declaration.tags));
+      pluginObject.insert(QStringLiteral("filters"),
+                          QJsonArray::fromStringList(declaration.filters));
+      plugins.insert(pluginIt.key(), pluginObject);
+    }
+
+    QJsonObject dirObject;
+    dirObject.insert(QStringLiteral("lastModified"),
+                     static_cast<double>(entry.lastModified));
+    dirObject.insert(QStringLiteral("files"),
+                     QJsonArray::fromStringList(entry.files));
+    dirObject.insert(QStringLiteral("plugins"), plugins);
+    directories.insert(it.key(), dirObject);
+  }
+
+  QJsonObject root;
+  root.insert(QStringLiteral("version"), s_cacheFormatVersion);
+  root.insert(QStringLiteral("directories"), directories);
+
+  QSaveFile file(m_cacheFile);
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  if (file.commit())
+    m_dirty = false;
+}
+
+PluginIndex::DirectoryEntry &PluginIndex::directory(const QString &dirPath)
+{
+  if (!m_loaded)
+    load();
+
+  auto &entry = m_directories[dirPath];
+  if (entry.validated)
+    return entry;
+
+  // Check the directory once per index. Adding or removing plugins changes
+  // the modification time of the directory.
+  entry.validated = true;
+  const QFileInfo info(dirPath);
+  const auto modified = lastModified(info);
+  if (modified == entry.lastModified)
+    return entry;
+
+  entry.lastModified = modified;
+  entry.files.clear();
+  entry.declarations.clear();
+  if (info.isDir()) {
+    entry.files = QDir(dirPath).entryList(QDir::Files | QDir::NoDotAndDotDot,
+                                          QDir::Name | QDir::IgnoreCase);
+  }
+  m_dirty = true;
+  return entry;
+}
+
+QStringList PluginIndex::entries(const QString &dirPath)
+{
+  return directory(dirPath).files;
+}
+
+PluginDeclaration PluginIndex::declaration(const QString &dirPath,
+                                           const QString &fileName)
+{
+  auto &entry = directory(dirPath);
+
+  const auto it = entry.declarations.find(fileName);
+  if (it != entry.declarations.end() && it.value().validated)
+    return it.value();
+
+  const QString filePath = dirPath + fileName;
+  const auto modified = lastModified(QFileInfo(filePath));
+
+  // A plugin may be replaced without changing the directory.
+  if (it != entry.declarations.end() && it.value().lastModified == modified) {
+    it.value().validated = true;
+    return it.value();
+  }
+
+  // This reads the metadata embedded in the plugin file without loading it.
+  auto declaration = readDeclaration(QPluginLoader(filePath)
+                                         .metaData()
+                                         .value(QStringLiteral("MetaData"))
+                                         .toObject());
+  declaration.lastModified = modified;
+  declaration.validated = true;
+
+  entry.declarations.insert(fileName, declaration);
+  m_dirty = true;
+  return declaration;
+}
+
+PluginDeclaration PluginIndex::readDeclaration(const QJsonObject &metaData)
+{
+  PluginDeclaration declaration;
+  const auto tags = metaData.value(QStringLiteral("tags"));
+  const auto filters = metaData.value(QStringLiteral("filters"));
+  declaration.hasDeclaration = tags.isArray() || filters.isArray();
+  declaration.tags = toStringList(tags);
+  declaration.filters = toStringList(filters);
+  return declaration;
+}
@@ -0,0 +1,110 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_PLUGININDEX_P_H
+#define GRANTLEE_PLUGININDEX_P_H
+
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+
+class QJsonObject;
+
+namespace Grantlee
+{
+
+/*
+  The tags and filters a plugin declares in its metadata, for example
+
+    Q_PLUGIN_METADATA(IID "org.grantlee.TagLibraryInterface" FILE "lib.json")
+
+  where lib.json contains { "tags": [ ... ], "filters": [ ... ] }.
+*/
+struct PluginDeclaration {
+  PluginDeclaration()
+      : lastModified(-1), hasDeclaration(false), validated(false)
+  {
+  }
+
+  qint64 lastModified;
+  bool hasDeclaration;
+  // Whether the plugin file was checked for modification by this index.
+  bool validated;
+  QStringList tags;
+  QStringList filters;
+};
+
+/*
+  An index of the content of plugin directories.
+
+  Each directory is listed once and its listing is reused for all library
+  lookups. If a cache file is set, the index is persisted there and reused
+  by later processes as long as the modification time of each directory is
+  unchanged.
+*/
+class PluginIndex
+{
+public:
+  PluginIndex();
+  ~PluginIndex();
+
+  void setCacheFile(const QString &fileName);
+  QString cacheFile() const;
+
+  /*
+    Returns the names of the files in @p dirPath, sorted by name.
+  */
+  QStringList entries(const QString &dirPath);
+
+  /*
+    Returns the tags and filters declared by the plugin @p fileName in
+    @p dirPath, reading the plugin metadata without loading the plugin if
+    it is not already indexed.
+  */
+  PluginDeclaration declaration(const QString &dirPath,
+                                const QString &fileName);
+
+  void save();
+
+  /*
+    Returns the tags and filters declared in the @p metaData of a plugin.
+  */
+  static PluginDeclaration readDeclaration(const QJsonObject &metaData);
+
+private:
+  struct DirectoryEntry {
+    DirectoryEntry() : lastModified(-1), validated(false) {}
+
+    qint64 lastModified;
+    bool validated;
+    QStringList files;
+    QHash<QString, PluginDeclaration> declarations;
+  };
+
+  void load();
+  DirectoryEntry &directory(const QString &dirPath);
+
+  QHash<QString, DirectoryEntry> m_directories;
+  QString m_cacheFile;
+  bool m_loaded;
+  bool m_dirty;
+};
+}
+
+#endif
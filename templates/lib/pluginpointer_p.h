@@ -56,7 +56,16 @@ public:
     m_plugin = qobject_cast<PluginType *>(m_object);
   }
 
-  QString errorString() { return m_pluginLoader->errorString(); }
+  // Wraps the instance of a statically linked plugin.
+  explicit PluginPointer(QObject *object)
+      : m_object(object), m_plugin(qobject_cast<PluginType *>(object))
+  {
+  }
+
+  QString errorString()
+  {
+    return m_pluginLoader ? m_pluginLoader->errorString() : QString();
+  }
 
   QObject *object() { return m_object; }
 
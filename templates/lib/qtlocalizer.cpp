@@ -20,18 +20,47 @@
 
 #include "qtlocalizer.h"
 
+#include "datetimeformat_p.h"
+#include "localizerrevision_p.h"
+#include "nulllocalizer_p.h"
+
+#include <QtCore/QAtomicInt>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDateTime>
 #include <QtCore/QLibraryInfo>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QTranslator>
 #include <QtCore/QVector>
 
 #include <QtCore/QLoggingCategory>
 
+#include <typeinfo>
+
 Q_LOGGING_CATEGORY(GRANTLEE_LOCALIZER, "grantlee.localizer")
 
+using namespace Grantlee;
+
+// The formats of QLocale::FormatType.
+static const int s_formatTypes = 3;
+
 struct Locale {
-  explicit Locale(const QLocale &_locale) : locale(_locale) {}
+  explicit Locale(const QLocale &_locale)
+      : locale(_locale), isSystem(_locale == QLocale::system())
+  {
+    // The system locale may format dates and times through the platform
+    // instead of its format strings.
+    if (isSystem)
+      return;
+    for (auto i = 0; i < s_formatTypes; ++i) {
+      const auto type = static_cast<QLocale::FormatType>(i);
+      dateFormats[i] = DateTimeFormat(locale, locale.dateFormat(type),
+                                      DateTimeFormat::DateFields);
+      timeFormats[i] = DateTimeFormat(locale, locale.timeFormat(type),
+                                      DateTimeFormat::TimeFields);
+      dateTimeFormats[i] = DateTimeFormat(
+          locale, locale.dateTimeFormat(type), DateTimeFormat::DateTimeFields);
+    }
+  }
 
   ~Locale()
   {
@@ -39,10 +68,34 @@ struct Locale {
     qDeleteAll(themeTranslators);
   }
 
+  void clearTranslations()
+  {
+    QWriteLocker locker(&translationsLock);
+    translations.clear();
+  }
+
+  template <typename T>
+  QString format(const DateTimeFormat (&formats)[s_formatTypes],
+                 const T &value, QLocale::FormatType type) const
+  {
+    if (isSystem || !value.isValid() || type < 0 || type >= s_formatTypes)
+      return locale.toString(value, type);
+    return formats[type].toString(value);
+  }
+
   const QLocale locale;
+  const bool isSystem;
+  DateTimeFormat dateFormats[s_formatTypes];
+  DateTimeFormat timeFormats[s_formatTypes];
+  DateTimeFormat dateTimeFormats[s_formatTypes];
   QVector<QTranslator *> externalSystemTranslators; // Not owned by us!
   QVector<QTranslator *> systemTranslators;
   QVector<QTranslator *> themeTranslators;
+
+  // Translations by context, source text and count, cleared when the
+  // translators change.
+  QHash<QPair<QString, QPair<QString, int>>, QString> translations;
+  QReadWriteLock translationsLock;
 };
 
 namespace Grantlee
@@ -50,7 +103,8 @@ namespace Grantlee
 
 class QtLocalizerPrivate
 {
-  QtLocalizerPrivate(QtLocalizer *qq, const QLocale &locale) : q_ptr(qq)
+  QtLocalizerPrivate(QtLocalizer *qq, const QLocale &locale)
+      : q_ptr(qq), m_revision(nextRevision())
   {
     auto localeStruct = new Locale(locale);
     m_availableLocales.insert(locale.name(), localeStruct);
@@ -73,6 +127,26 @@ class QtLocalizerPrivate
     return m_locales.last()->locale;
   }
 
+  const Locale *current() const
+  {
+    return m_locales.isEmpty() ? nullptr : m_locales.last();
+  }
+
+public:
+  static int revision(const QtLocalizer *localizer)
+  {
+    return localizer->d_func()->m_revision;
+  }
+
+private:
+  // Revisions are unique among all localizers, so that text cached for a
+  // deleted localizer is never used for a new one at the same address.
+  static int nextRevision()
+  {
+    static QAtomicInt s_revision;
+    return s_revision.fetchAndAddRelaxed(1) + 1;
+  }
+
   Q_DECLARE_PUBLIC(QtLocalizer)
   QtLocalizer *const q_ptr;
 
@@ -84,11 +158,10 @@ class QtLocalizerPrivate
   QList<Locale *> m_locales;
   QString m_appTranslatorPath;
   QString m_appTranslatorPrefix;
+  int m_revision;
 };
 }
 
-using namespace Grantlee;
-
 static void replacePercentN(QString *result, int n)
 {
   if (n >= 0) {
@@ -114,6 +187,26 @@ static void replacePercentN(QString *result, int n)
   }
 }
 
+static QString translateWith(const QVector<QTranslator *> &translators,
+                             const QByteArray &sourceText,
+                             const QByteArray &disambiguation, int count)
+{
+  for (QTranslator *translator : translators) {
+    auto result = translator->translate("GR_FILENAME", sourceText.constData(),
+                                        disambiguation.constData(), count);
+    if (!result.isEmpty())
+      return result;
+  }
+  return {};
+}
+
+// Caching stops growing at this size, in case counts vary widely.
+static const int s_maxCachedTranslations = 4096;
+
+// Whether text was left to the translators of the application on this
+// thread since beginCacheableTranslation.
+static thread_local bool s_applicationTranslated = false;
+
 QString QtLocalizerPrivate::translate(const QString &input,
                                       const QString &context, int count) const
 {
@@ -126,31 +219,41 @@ QString QtLocalizerPrivate::translate(const QString &input,
   }
 
   auto locale = m_locales.last();
-  for (QTranslator *translator : qAsConst(locale->themeTranslators)) {
-    result = translator->translate("GR_FILENAME", input.toUtf8().constData(),
-                                   context.toUtf8().constData(), count);
+  const auto key = qMakePair(context, qMakePair(input, count));
+  {
+    QReadLocker locker(&locale->translationsLock);
+    const auto it = locale->translations.constFind(key);
+    if (it != locale->translations.constEnd())
+      return it.value();
   }
+
+  const auto sourceText = input.toUtf8();
+  const auto disambiguation = context.toUtf8();
+  result = translateWith(locale->themeTranslators, sourceText, disambiguation,
+                         count);
   if (result.isEmpty()) {
-    auto translators
-        = locale->externalSystemTranslators + locale->systemTranslators;
-    if (translators.isEmpty())
-      return QCoreApplication::translate("GR_FILENAME",
-                                         input.toUtf8().constData(),
-                                         context.toUtf8().constData(), count);
-    for (QTranslator *translator : qAsConst(translators)) {
-      result = translator->translate("GR_FILENAME", input.toUtf8().constData(),
-                                     context.toUtf8().constData(), count);
-      if (!result.isEmpty())
-        break;
+    // The translators of the application may change at any time, so their
+    // translations are not cached.
+    if (locale->externalSystemTranslators.isEmpty()
+        && locale->systemTranslators.isEmpty()) {
+      s_applicationTranslated = true;
+      return QCoreApplication::translate("GR_FILENAME", sourceText.constData(),
+                                         disambiguation.constData(), count);
     }
+    result = translateWith(locale->externalSystemTranslators, sourceText,
+                           disambiguation, count);
+    if (result.isEmpty())
+      result = translateWith(locale->systemTranslators, sourceText,
+                             disambiguation, count);
   }
-  if (!result.isEmpty()) {
-    replacePercentN(&result, count);
-    return result;
-  }
-  auto fallback = input;
-  replacePercentN(&fallback, count);
-  return fallback;
+  if (result.isEmpty())
+    result = input;
+  replacePercentN(&result, count);
+
+  QWriteLocker locker(&locale->translationsLock);
+  if (locale->translations.size() < s_maxCachedTranslations)
+    locale->translations.insert(key, result);
+  return result;
 }
 
 QtLocalizer::QtLocalizer(const QLocale &locale)
@@ -164,12 +267,14 @@ void QtLocalizer::setAppTranslatorPath(const QString &path)
 {
   Q_D(QtLocalizer);
   d->m_appTranslatorPath = path;
+  d->m_revision = QtLocalizerPrivate::nextRevision();
 }
 
 void QtLocalizer::setAppTranslatorPrefix(const QString &prefix)
 {
   Q_D(QtLocalizer);
   d->m_appTranslatorPrefix = prefix;
+  d->m_revision = QtLocalizerPrivate::nextRevision();
 }
 
 void QtLocalizer::installTranslator(QTranslator *translator,
@@ -180,29 +285,40 @@ void QtLocalizer::installTranslator(QTranslator *translator,
     const QLocale namedLocale(localeName);
     d->m_availableLocales.insert(localeName, new Locale(namedLocale));
   }
-  d->m_availableLocales[localeName]->externalSystemTranslators.prepend(
-      translator);
+  auto locale = d->m_availableLocales.value(localeName);
+  locale->externalSystemTranslators.prepend(translator);
+  locale->clearTranslations();
+  d->m_revision = QtLocalizerPrivate::nextRevision();
 }
 
 QString QtLocalizer::localizeDate(const QDate &date,
                                   QLocale::FormatType formatType) const
 {
   Q_D(const QtLocalizer);
-  return d->currentLocale().toString(date, formatType);
+  const auto locale = d->current();
+  if (!locale)
+    return d->currentLocale().toString(date, formatType);
+  return locale->format(locale->dateFormats, date, formatType);
 }
 
 QString QtLocalizer::localizeTime(const QTime &time,
                                   QLocale::FormatType formatType) const
 {
   Q_D(const QtLocalizer);
-  return d->currentLocale().toString(time, formatType);
+  const auto locale = d->current();
+  if (!locale)
+    return d->currentLocale().toString(time, formatType);
+  return locale->format(locale->timeFormats, time, formatType);
 }
 
 QString QtLocalizer::localizeDateTime(const QDateTime &dateTime,
                                       QLocale::FormatType formatType) const
 {
   Q_D(const QtLocalizer);
-  return d->currentLocale().toString(dateTime, formatType);
+  const auto locale = d->current();
+  if (!locale)
+    return d->currentLocale().toString(dateTime, formatType);
+  return locale->format(locale->dateTimeFormats, dateTime, formatType);
 }
 
 QString QtLocalizer::localizeNumber(int number) const
@@ -342,7 +458,9 @@ void QtLocalizer::loadCatalog(const QString &path, const QString &catalog)
     translator->setObjectName(catalog);
 
     it.value()->themeTranslators.prepend(translator);
+    it.value()->clearTranslations();
   }
+  d->m_revision = QtLocalizerPrivate::nextRevision();
 }
 
 void QtLocalizer::unloadCatalog(const QString &catalog)
@@ -360,5 +478,22 @@ void QtLocalizer::unloadCatalog(const QString &catalog)
         ++tranIt;
       }
     }
+    (*it)->clearTranslations();
   }
+  d->m_revision = QtLocalizerPrivate::nextRevision();
 }
+
+int Grantlee::localizerRevision(const AbstractLocalizer *localizer)
+{
+  // The text of a NullLocalizer does not depend on any catalogs.
+  if (typeid(*localizer) == typeid(NullLocalizer))
+    return 0;
+  if (typeid(*localizer) != typeid(QtLocalizer))
+    return -1;
+  return QtLocalizerPrivate::revision(
+      static_cast<const QtLocalizer *>(localizer));
+}
+
+void Grantlee::beginCacheableTranslation() { s_applicationTranslated = false; }
+
+bool Grantlee::endCacheableTranslation() { return !s_applicationTranslated; }
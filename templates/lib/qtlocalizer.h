@@ -51,6 +51,9 @@ class QtLocalizerPrivate;
     fr_display->setText(frText);
   @endcode
 
+  Translations are cached for each locale, so repeated translations of the
+  same string only look up the cache. The cache of a locale is cleared when a
+  catalog or translator is added to or removed from it.
 */
 class GRANTLEE_TEMPLATES_EXPORT QtLocalizer : public AbstractLocalizer
 {
@@ -0,0 +1,63 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "regexcache_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+
+using namespace Grantlee;
+
+namespace
+{
+struct RegexCache {
+  QMutex mutex;
+  QHash<QPair<QString, int>, QRegularExpression> expressions;
+};
+}
+
+Q_GLOBAL_STATIC(RegexCache, regexCache)
+
+// Patterns built from variable arguments could otherwise grow the cache
+// without bound.
+static const int s_maxCachedExpressions = 256;
+
+QRegularExpression
+Grantlee::cachedRegularExpression(const QString &pattern,
+                                  QRegularExpression::PatternOptions options)
+{
+  const auto key = qMakePair(pattern, static_cast<int>(options));
+
+  auto cache = regexCache();
+  QMutexLocker locker(&cache->mutex);
+  const auto it = cache->expressions.constFind(key);
+  if (it != cache->expressions.constEnd())
+    return it.value();
+
+  QRegularExpression re(pattern, options);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+  re.optimize();
+#endif
+  if (cache->expressions.size() >= s_maxCachedExpressions)
+    cache->expressions.clear();
+  cache->expressions.insert(key, re);
+  return re;
+}
@@ -0,0 +1,46 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_REGEXCACHE_P_H
+#define GRANTLEE_REGEXCACHE_P_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QRegularExpression>
+
+namespace Grantlee
+{
+
+/**
+  @internal
+
+  Returns the QRegularExpression for @p pattern and @p options from a cache
+  which is shared by all threads.
+
+  The pattern is compiled and optimized the first time it is requested, so
+  that filters which build a pattern from their argument do not compile it
+  again for each value they filter.
+*/
+GRANTLEE_TEMPLATES_EXPORT QRegularExpression cachedRegularExpression(
+    const QString &pattern, QRegularExpression::PatternOptions options
+                            = QRegularExpression::NoPatternOption);
+}
+
+#endif
@@ -0,0 +1,329 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "renderprofiler.h"
+#include "renderprofiler_p.h"
+
+#include "node.h"
+#include "template.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+
+namespace Grantlee
+{
+
+class RenderProfilerPrivate
+{
+  RenderProfilerPrivate(RenderProfiler *profiler) : q_ptr(profiler)
+  {
+    m_timer.start();
+    reset();
+  }
+
+  ~RenderProfilerPrivate() { forgetNodes(); }
+
+  // Frames are identified by their label and scope rather than by the
+  // address of the template, node or filter, because the memory of deleted
+  // ones is reused by others. The scope is TemplateScope, NodeScope or the
+  // frame which applies a filter, or -1 for a filter applied outside of any
+  // frame. Filters are keyed by their name.
+  using FrameKey = QPair<int, QString>;
+  enum { TemplateScope = -3, NodeScope = -2 };
+
+  struct Frame {
+    RenderProfiler::Entry entry;
+    QString label;
+    int active;
+  };
+
+  struct CallNode {
+    int frame;
+    QHash<int, int> children;
+    qint64 exclusiveTime;
+  };
+
+  // The frame of a node, which is found once for each node rather than for
+  // each render. The entry is removed when the node is destroyed, so that
+  // its address can not be mistaken for another node.
+  struct NodeFrame {
+    int frame;
+    QMetaObject::Connection destroyed;
+  };
+
+  struct ActiveCall {
+    int callNode;
+    int frame;
+    qint64 start;
+    qint64 childTime;
+  };
+
+  void reset();
+  void forgetNodes();
+  int nodeFrame(const Node *node);
+
+  int addFrame(const FrameKey &key, const QString &templateName, int line,
+               const QString &nodeType, const QString &label);
+
+  void beginTemplate(const TemplateImpl *t);
+  void beginNode(const Node *node);
+  void beginFilter(const Filter *filter, const QString &name);
+  void begin(int frame);
+  void end();
+
+  void collapse(int callNode, const QString &prefix, QStringList *lines) const;
+
+  static QString templateName(const TemplateImpl *t);
+
+  Q_DECLARE_PUBLIC(RenderProfiler)
+  RenderProfiler *const q_ptr;
+
+  QElapsedTimer m_timer;
+  QVector<Frame> m_frames;
+  QHash<FrameKey, int> m_frameIds;
+  QHash<const Node *, NodeFrame> m_nodeFrames;
+  // The tree of the recorded stacks. The root at index 0 does not have a
+  // frame.
+  QVector<CallNode> m_callTree;
+  QVector<ActiveCall> m_stack;
+};
+}
+
+using namespace Grantlee;
+
+void RenderProfilerPrivate::reset()
+{
+  Q_ASSERT(m_stack.isEmpty());
+  forgetNodes();
+  m_frames.clear();
+  m_frameIds.clear();
+  m_callTree.clear();
+  m_callTree.append({-1, {}, 0});
+}
+
+int RenderProfilerPrivate::addFrame(const FrameKey &key,
+                                    const QString &templateName, int line,
+                                    const QString &nodeType,
+                                    const QString &label)
+{
+  Frame frame;
+  frame.entry.templateName = templateName;
+  frame.entry.line = line;
+  frame.entry.nodeType = nodeType;
+  frame.entry.calls = 0;
+  frame.entry.inclusiveTime = 0;
+  frame.entry.exclusiveTime = 0;
+  // ';' separates the frames of a stack in the collapsed format.
+  frame.label = label;
+  frame.label.replace(QLatin1Char(';'), QLatin1Char(','));
+  frame.active = 0;
+
+  const auto id = m_frames.size();
+  m_frames.append(frame);
+  m_frameIds.insert(key, id);
+  return id;
+}
+
+void RenderProfilerPrivate::beginTemplate(const TemplateImpl *t)
+{
+  const auto name = templateName(t);
+  const FrameKey key(TemplateScope, name);
+  auto id = m_frameIds.value(key, -1);
+  if (id < 0)
+    id = addFrame(key, name, 0, QStringLiteral("Template"), name);
+  begin(id);
+}
+
+void RenderProfilerPrivate::forgetNodes()
+{
+  for (const auto &nodeFrame : qAsConst(m_nodeFrames))
+    QObject::disconnect(nodeFrame.destroyed);
+  m_nodeFrames.clear();
+}
+
+void RenderProfilerPrivate::beginNode(const Node *node)
+{
+  const auto it = m_nodeFrames.constFind(node);
+  begin(it != m_nodeFrames.constEnd() ? it.value().frame : nodeFrame(node));
+}
+
+int RenderProfilerPrivate::nodeFrame(const Node *node)
+{
+  // Nodes of the same type on the same line of a template share a frame.
+  auto nodeType = QString::fromLatin1(node->metaObject()->className());
+  if (nodeType.startsWith(QLatin1String("Grantlee::")))
+    nodeType = nodeType.mid(10);
+  const auto name = templateName(node->containerTemplate());
+  const auto line = node->lineNumber() + 1;
+  QString label = name;
+  if (line > 0)
+    label += QLatin1Char(':') + QString::number(line);
+  label += QLatin1Char(' ') + nodeType;
+
+  const FrameKey key(NodeScope, label);
+  auto id = m_frameIds.value(key, -1);
+  if (id < 0)
+    id = addFrame(key, name, line, nodeType, label);
+
+  const auto destroyed = QObject::connect(
+      node, &QObject::destroyed, [this, node] { m_nodeFrames.remove(node); });
+  m_nodeFrames.insert(node, {id, destroyed});
+  return id;
+}
+
+void RenderProfilerPrivate::beginFilter(const Filter *filter,
+                                        const QString &name)
+{
+  Q_UNUSED(filter)
+  // Filters are shared by all templates, so they are told apart by the
+  // frame which applies them.
+  const auto parent = m_stack.isEmpty() ? -1 : m_stack.last().frame;
+  const FrameKey key(parent, name);
+  auto id = m_frameIds.value(key, -1);
+  if (id < 0) {
+    const QString nodeType = QLatin1Char('|') + name;
+    QString templateName;
+    QString label;
+    auto line = 0;
+    if (parent >= 0) {
+      templateName = m_frames.at(parent).entry.templateName;
+      line = m_frames.at(parent).entry.line;
+      label = m_frames.at(parent).label + QLatin1Char(' ');
+    }
+    id = addFrame(key, templateName, line, nodeType, label + nodeType);
+  }
+  begin(id);
+}
+
+void RenderProfilerPrivate::begin(int frame)
+{
+  const auto parent = m_stack.isEmpty() ? 0 : m_stack.last().callNode;
+  auto callNode = m_callTree.at(parent).children.value(frame, -1);
+  if (callNode < 0) {
+    callNode = m_callTree.size();
+    m_callTree.append({frame, {}, 0});
+    m_callTree[parent].children.insert(frame, callNode);
+  }
+
+  auto &f = m_frames[frame];
+  ++f.entry.calls;
+  ++f.active;
+
+  m_stack.append({callNode, frame, m_timer.nsecsElapsed(), 0});
+}
+
+void RenderProfilerPrivate::end()
+{
+  Q_ASSERT(!m_stack.isEmpty());
+  const auto call = m_stack.takeLast();
+  const auto elapsed = m_timer.nsecsElapsed() - call.start;
+  const auto exclusive = elapsed - call.childTime;
+
+  auto &f = m_frames[call.frame];
+  f.entry.exclusiveTime += exclusive;
+  // Recursive calls, such as a template including itself, are already
+  // accounted for by the outermost call.
+  if (--f.active == 0)
+    f.entry.inclusiveTime += elapsed;
+
+  m_callTree[call.callNode].exclusiveTime += exclusive;
+
+  if (!m_stack.isEmpty())
+    m_stack.last().childTime += elapsed;
+}
+
+void RenderProfilerPrivate::collapse(int callNode, const QString &prefix,
+                                     QStringList *lines) const
+{
+  const auto &node = m_callTree.at(callNode);
+  QString stack = prefix;
+  if (node.frame >= 0) {
+    if (!stack.isEmpty())
+      stack += QLatin1Char(';');
+    stack += m_frames.at(node.frame).label;
+    if (node.exclusiveTime > 0)
+      lines->append(stack + QLatin1Char(' ')
+                    + QString::number(node.exclusiveTime));
+  }
+  for (auto child : node.children)
+    collapse(child, stack, lines);
+}
+
+QString RenderProfilerPrivate::templateName(const TemplateImpl *t)
+{
+  const auto name = t->objectName();
+  return name.isEmpty() ? QStringLiteral("<unnamed>") : name;
+}
+
+RenderProfiler::RenderProfiler() : d_ptr(new RenderProfilerPrivate(this)) {}
+
+RenderProfiler::~RenderProfiler() { delete d_ptr; }
+
+QVector<RenderProfiler::Entry> RenderProfiler::entries() const
+{
+  Q_D(const RenderProfiler);
+  QVector<Entry> result;
+  result.reserve(d->m_frames.size());
+  for (const auto &frame : d->m_frames)
+    result.append(frame.entry);
+  return result;
+}
+
+QString RenderProfiler::collapsedStacks() const
+{
+  Q_D(const RenderProfiler);
+  QStringList lines;
+  d->collapse(0, QString(), &lines);
+  lines.sort();
+  if (lines.isEmpty())
+    return {};
+  return lines.join(QLatin1Char('\n')) + QLatin1Char('\n');
+}
+
+void RenderProfiler::clear()
+{
+  Q_D(RenderProfiler);
+  d->reset();
+}
+
+void RenderProfiler::beginTemplate(const TemplateImpl *t)
+{
+  Q_D(RenderProfiler);
+  d->beginTemplate(t);
+}
+
+void RenderProfiler::beginNode(const Node *node)
+{
+  Q_D(RenderProfiler);
+  d->beginNode(node);
+}
+
+void RenderProfiler::beginFilter(const Filter *filter, const QString &name)
+{
+  Q_D(RenderProfiler);
+  d->beginFilter(filter, name);
+}
+
+void RenderProfiler::end()
+{
+  Q_D(RenderProfiler);
+  d->end();
+}
@@ -0,0 +1,159 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_RENDERPROFILER_H
+#define GRANTLEE_RENDERPROFILER_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace Grantlee
+{
+
+class Filter;
+class Node;
+class TemplateImpl;
+
+class RenderProfilerPrivate;
+
+/// @headerfile renderprofiler.h grantlee/renderprofiler.h
+
+/**
+  @brief The **%RenderProfiler** records where time is spent rendering
+  Templates.
+
+  Profiling is enabled by setting a **%RenderProfiler** on the Context used to
+  render a Template. The time spent in each Template, Node and Filter is then
+  attributed to the name of the Template, the line of the Node and the type
+  of the Node.
+
+  @code
+    RenderProfiler profiler;
+    c.setRenderProfiler(&profiler);
+    t->render(&c);
+
+    for (const auto &entry : profiler.entries()) {
+      qDebug() << entry.templateName << entry.line << entry.nodeType
+               << entry.calls << entry.inclusiveTime << entry.exclusiveTime;
+    }
+  @endcode
+
+  The recorded call stacks can be exported in the collapsed format used by
+  flame graph tools such as <tt>flamegraph.pl</tt> and speedscope.
+
+  @code
+    QFile file("render.folded");
+    file.open(QIODevice::WriteOnly);
+    file.write(profiler.collapsedStacks().toUtf8());
+  @endcode
+
+  When no **%RenderProfiler** is set, which is the default, rendering is not
+  measured. A **%RenderProfiler** must only be used by one thread at a time.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEMPLATES_EXPORT RenderProfiler
+{
+public:
+  /**
+    The time spent in one Template, Node or Filter.
+  */
+  struct Entry {
+    /**
+      The name of the Template containing the Node.
+    */
+    QString templateName;
+
+    /**
+      The line of the Node in the Template, starting at 1, or 0 if it is
+      not known.
+    */
+    int line;
+
+    /**
+      The type of the Node, for example <tt>"ForNode"</tt>. Templates are
+      recorded with the type <tt>"Template"</tt> and filters with the name
+      of the filter prefixed by <tt>'|'</tt>.
+    */
+    QString nodeType;
+
+    /**
+      The number of times the Node was rendered.
+    */
+    int calls;
+
+    /**
+      The time in nanoseconds spent rendering the Node, including the time
+      spent in its children.
+    */
+    qint64 inclusiveTime;
+
+    /**
+      The time in nanoseconds spent rendering the Node, excluding the time
+      spent in its children.
+    */
+    qint64 exclusiveTime;
+  };
+
+  /**
+    Constructor.
+  */
+  RenderProfiler();
+
+  /**
+    Destructor.
+  */
+  ~RenderProfiler();
+
+  /**
+    Returns the time recorded for each Template, Node and Filter.
+  */
+  QVector<Entry> entries() const;
+
+  /**
+    Returns the recorded call stacks in the collapsed format used by flame
+    graph tools. Each line contains the frames of a stack separated by
+    <tt>';'</tt> and the exclusive time of the stack in nanoseconds.
+  */
+  QString collapsedStacks() const;
+
+  /**
+    Discards everything recorded so far. This must not be called while a
+    Template is being rendered.
+  */
+  void clear();
+
+private:
+  void beginTemplate(const TemplateImpl *t);
+  void beginNode(const Node *node);
+  void beginFilter(const Filter *filter, const QString &name);
+  void end();
+
+  friend class ProfileScope;
+
+  Q_DISABLE_COPY(RenderProfiler)
+  Q_DECLARE_PRIVATE(RenderProfiler)
+  RenderProfilerPrivate *const d_ptr;
+};
+}
+
+#endif
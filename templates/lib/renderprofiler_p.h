@@ -0,0 +1,63 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_RENDERPROFILER_P_H
+#define GRANTLEE_RENDERPROFILER_P_H
+
+#include "renderprofiler.h"
+
+namespace Grantlee
+{
+
+/*
+  Records the time until the end of the scope in a RenderProfiler. The
+  frame is closed even if rendering throws an exception.
+*/
+class ProfileScope
+{
+public:
+  ProfileScope(RenderProfiler *profiler, const TemplateImpl *t)
+      : m_profiler(profiler)
+  {
+    m_profiler->beginTemplate(t);
+  }
+
+  ProfileScope(RenderProfiler *profiler, const Node *node)
+      : m_profiler(profiler)
+  {
+    m_profiler->beginNode(node);
+  }
+
+  ProfileScope(RenderProfiler *profiler, const Filter *filter,
+               const QString &name)
+      : m_profiler(profiler)
+  {
+    m_profiler->beginFilter(filter, name);
+  }
+
+  ~ProfileScope() { m_profiler->end(); }
+
+private:
+  Q_DISABLE_COPY(ProfileScope)
+  RenderProfiler *const m_profiler;
+};
+}
+
+#endif
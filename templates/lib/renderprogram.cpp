@@ -0,0 +1,355 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "renderprogram_p.h"
+
+#include "context.h"
+#include "engine.h"
+#include "exception.h"
+#include "localizerrevision_p.h"
+#include "memoryusage_p.h"
+#include "template.h"
+#include "tracer.h"
+#include "util.h"
+
+#include <memory>
+
+using namespace Grantlee;
+
+static const char *const s_opCodeNames[] = {
+    "Text",      "Variable",  "CallNode",  "Jump",     "JumpUnless",
+    "Push",      "Insert",    "Pop",       "BeginLoop", "NextLoop",
+    "EnterScope", "LeaveScope", "Include", "LocalizedText"};
+
+CompilableNode::~CompilableNode() = default;
+
+RenderLoopIteration::~RenderLoopIteration() = default;
+
+RenderLoop::~RenderLoop() = default;
+
+RenderScope::~RenderScope() = default;
+
+RenderProgram::RenderProgram(const TemplateImpl *t)
+    : m_template(t), m_textInstruction(-1)
+{
+}
+
+int RenderProgram::instruction(OpCode op, int a, int b)
+{
+  m_textInstruction = -1;
+  m_code.append(Instruction{op, a, b});
+  return m_code.size() - 1;
+}
+
+int RenderProgram::label()
+{
+  // Text appended after a jump target must not be merged into the text
+  // before it.
+  m_textInstruction = -1;
+  return m_code.size();
+}
+
+int RenderProgram::addExpression(const FilterExpression &fe)
+{
+  m_expressions.append(fe);
+  return m_expressions.size() - 1;
+}
+
+void RenderProgram::append(const NodeList &nodes)
+{
+  for (const auto node : nodes) {
+    const auto compilable = dynamic_cast<const CompilableNode *>(node);
+    if (!compilable || !compilable->compile(this))
+      appendNode(node);
+  }
+}
+
+void RenderProgram::appendText(const QString &text)
+{
+  if (text.isEmpty())
+    return;
+
+  if (m_textInstruction >= 0) {
+    m_strings[m_code.at(m_textInstruction).a] += text;
+    return;
+  }
+  m_strings.append(text);
+  m_textInstruction = instruction(Text, m_strings.size() - 1);
+}
+
+void RenderProgram::appendVariable(const Node *node, const FilterExpression &fe)
+{
+  m_nodes.append(node);
+  instruction(Variable, addExpression(fe), m_nodes.size() - 1);
+}
+
+void RenderProgram::appendNode(const Node *node)
+{
+  m_nodes.append(node);
+  instruction(CallNode, m_nodes.size() - 1);
+}
+
+void RenderProgram::appendLocalizedText(const Node *node,
+                                        const Localization &localization)
+{
+  m_nodes.append(node);
+  m_localizations.append(localization);
+  instruction(LocalizedText, m_localizations.size() - 1, m_nodes.size() - 1);
+}
+
+void RenderProgram::appendBranches(
+    const QVector<QPair<Condition, NodeList>> &branches)
+{
+  QVector<int> exits;
+  for (const auto &branch : branches) {
+    if (!branch.first) {
+      append(branch.second);
+      break;
+    }
+    m_conditions.append(branch.first);
+    const auto test = instruction(JumpUnless, m_conditions.size() - 1);
+    append(branch.second);
+    exits.append(instruction(Jump));
+    m_code[test].b = label();
+  }
+
+  const auto end = label();
+  for (const auto exit : qAsConst(exits))
+    m_code[exit].a = end;
+}
+
+void RenderProgram::appendVariables(
+    const std::vector<std::pair<QString, FilterExpression>> &variables,
+    const NodeList &nodes)
+{
+  instruction(Push);
+  for (const auto &variable : variables) {
+    m_strings.append(variable.first);
+    instruction(Insert, m_strings.size() - 1, addExpression(variable.second));
+  }
+  append(nodes);
+  instruction(Pop);
+}
+
+void RenderProgram::appendLoop(const RenderLoop *loop, const NodeList &nodes,
+                               const NodeList &emptyNodes)
+{
+  m_loops.append(loop);
+  const auto begin = instruction(BeginLoop, m_loops.size() - 1);
+  const auto next = instruction(NextLoop);
+  append(nodes);
+  instruction(Jump, next);
+  m_code[begin].b = label();
+  append(emptyNodes);
+  m_code[next].b = label();
+}
+
+void RenderProgram::appendScope(const RenderScope *scope,
+                                const NodeList &nodes)
+{
+  m_scopes.append(scope);
+  const auto enter = instruction(EnterScope, m_scopes.size() - 1);
+  append(nodes);
+  instruction(LeaveScope, m_scopes.size() - 1);
+  m_code[enter].b = label();
+}
+
+void RenderProgram::appendInclude(const FilterExpression &fe)
+{
+  instruction(Include, addExpression(fe));
+}
+
+Template RenderProgram::renderInclude(const TemplateImpl *container,
+                                      const QString &name,
+                                      OutputStream *stream, Context *c)
+{
+  TraceScope scope(container->engine()->tracer(), "render", "include");
+  scope.setArgument("template", container->objectName());
+  scope.setArgument("include", name);
+
+  auto t = container->engine()->loadByName(name);
+
+  if (!t)
+    throw Grantlee::Exception(
+        TagSyntaxError, QStringLiteral("Template not found %1").arg(name));
+
+  if (t->error())
+    throw Grantlee::Exception(t->error(), t->errorString());
+
+  t->render(stream, c);
+
+  if (t->error())
+    throw Grantlee::Exception(t->error(), t->errorString());
+  return t;
+}
+
+// The number of locales whose texts are kept.
+static const int s_maxLocalizedLocales = 32;
+
+RenderProgram::LocalizedTexts
+RenderProgram::localizedTexts(Context *c) const
+{
+  const auto localizer = c->localizer();
+  const auto revision = localizerRevision(localizer.data());
+  if (revision < 0)
+    return {};
+
+  const auto key = qMakePair<const AbstractLocalizer *>(
+      localizer.data(), qMakePair(revision, localizer->currentLocale()));
+  {
+    QReadLocker locker(&m_localizedTextsLock);
+    const auto it = m_localizedTexts.constFind(key);
+    if (it != m_localizedTexts.constEnd())
+      return it.value();
+  }
+
+  LocalizedTexts texts;
+  texts.texts.reserve(m_localizations.size());
+  texts.cached.reserve(m_localizations.size());
+  for (const auto &localization : m_localizations) {
+    beginCacheableTranslation();
+    texts.texts.append(localization(c));
+    texts.cached.append(endCacheableTranslation());
+  }
+
+  QWriteLocker locker(&m_localizedTextsLock);
+  if (m_localizedTexts.size() >= s_maxLocalizedLocales)
+    m_localizedTexts.clear();
+  m_localizedTexts.insert(key, texts);
+  return texts;
+}
+
+void RenderProgram::render(OutputStream *stream, Context *c) const
+{
+  // The iterations of the loops being rendered, innermost last.
+  std::vector<std::unique_ptr<RenderLoopIteration>> loops;
+
+  // The localized texts for the locale of the Context, looked up when they
+  // are first used. They are empty if the localizer can not cache them.
+  LocalizedTexts localized;
+  auto localizedReady = false;
+
+  const auto code = m_code.constData();
+  const auto size = m_code.size();
+  auto pc = 0;
+  while (pc < size) {
+    const auto &current = code[pc++];
+    switch (current.op) {
+    case Text:
+      (*stream) << m_strings.at(current.a);
+      break;
+    case Variable: {
+      const auto v = m_expressions.at(current.a).resolve(c);
+      if (v.isValid())
+        streamNodeValue(m_nodes.at(current.b), stream, v, c);
+      break;
+    }
+    case CallNode:
+      m_nodes.at(current.a)->render(stream, c);
+      break;
+    case Jump:
+      pc = current.a;
+      break;
+    case JumpUnless:
+      if (!m_conditions.at(current.a)(c))
+        pc = current.b;
+      break;
+    case Push:
+      c->push();
+      break;
+    case Insert:
+      c->insert(m_strings.at(current.a),
+                m_expressions.at(current.b).resolve(c));
+      break;
+    case Pop:
+      c->pop();
+      break;
+    case BeginLoop: {
+      auto rendered = false;
+      std::unique_ptr<RenderLoopIteration> iteration(
+          m_loops.at(current.a)->begin(stream, c, &rendered));
+      if (iteration)
+        loops.push_back(std::move(iteration));
+      else if (rendered)
+        // The end of the loop is the target of the NextLoop which follows.
+        pc = code[pc].b;
+      else
+        pc = current.b;
+      break;
+    }
+    case NextLoop:
+      if (!loops.back()->next(c)) {
+        loops.pop_back();
+        pc = current.b;
+      }
+      break;
+    case EnterScope:
+      if (!m_scopes.at(current.a)->enter(stream, c))
+        pc = current.b;
+      break;
+    case LeaveScope:
+      m_scopes.at(current.a)->leave(c);
+      break;
+    case Include:
+      renderInclude(m_template,
+                    getSafeString(m_expressions.at(current.a).resolve(c)),
+                    stream, c);
+      break;
+    case LocalizedText:
+      if (!localizedReady) {
+        localized = localizedTexts(c);
+        localizedReady = true;
+      }
+      streamNodeValue(m_nodes.at(current.b), stream,
+                      localized.cached.value(current.a)
+                          ? localized.texts.at(current.a)
+                          : m_localizations.at(current.a)(c),
+                      c);
+      break;
+    }
+  }
+}
+
+QString RenderProgram::dump() const
+{
+  QString result;
+  for (auto i = 0; i < m_code.size(); ++i) {
+    const auto &current = m_code.at(i);
+    result += QString::number(i) + QLatin1Char(' ')
+              + QLatin1String(s_opCodeNames[current.op]) + QLatin1Char(' ')
+              + QString::number(current.a) + QLatin1Char(' ')
+              + QString::number(current.b) + QLatin1Char('\n');
+  }
+  return result;
+}
+
+qint64 RenderProgram::memoryUsage() const
+{
+  auto size = qint64(sizeof(RenderProgram)) + heapSize(m_code)
+              + heapSize<QVector<QString>>(m_strings)
+              + heapSize<QVector<FilterExpression>>(m_expressions)
+              + heapSize(m_nodes) + heapSize(m_conditions) + heapSize(m_loops)
+              + heapSize(m_scopes) + heapSize(m_localizations);
+  for (const auto &str : m_strings)
+    size += heapSize(str);
+  for (const auto &fe : m_expressions)
+    size += fe.memoryUsage();
+  return size;
+}
@@ -0,0 +1,293 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_RENDERPROGRAM_P_H
+#define GRANTLEE_RENDERPROGRAM_P_H
+
+#include "filterexpression.h"
+#include "node.h"
+#include "template.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QVector>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace Grantlee
+{
+
+class AbstractLocalizer;
+class RenderProgram;
+class TemplateImpl;
+
+/**
+  @internal
+
+  Implemented by Nodes which can be lowered into a RenderProgram. This is
+  not a virtual method of Node, so that the vtable of Node stays compatible
+  with plugins built against older releases.
+*/
+class GRANTLEE_TEMPLATES_EXPORT CompilableNode
+{
+public:
+  virtual ~CompilableNode();
+
+  /**
+    Appends the instructions to render the Node to the @p program and
+    returns true, or returns false if the Node must be rendered by calling
+    Node::render.
+  */
+  virtual bool compile(RenderProgram *program) const = 0;
+};
+
+/**
+  @internal
+
+  Streams the value @p input as the @p node does with
+  Node::streamValueInContext.
+*/
+void streamNodeValue(const Node *node, OutputStream *stream,
+                     const QVariant &input, Context *c);
+
+/**
+  @internal
+
+  One execution of a RenderLoop.
+*/
+class GRANTLEE_TEMPLATES_EXPORT RenderLoopIteration
+{
+public:
+  virtual ~RenderLoopIteration();
+
+  /**
+    Inserts the variables of the next item into the Context @p c and returns
+    true, or pops the Context of the loop and returns false if there are no
+    more items.
+  */
+  virtual bool next(Context *c) = 0;
+};
+
+/**
+  @internal
+
+  A loop of a Node which is lowered into a RenderProgram.
+*/
+class GRANTLEE_TEMPLATES_EXPORT RenderLoop
+{
+public:
+  virtual ~RenderLoop();
+
+  /**
+    Starts the loop in the Context @p c and returns the iteration over its
+    items.
+
+    Returns a null pointer if the loop has no items, in which case the
+    empty nodes of the loop are rendered. Loops which can not be iterated by
+    a RenderProgram render themselves completely to @p stream, set
+    @p rendered and return a null pointer.
+  */
+  virtual RenderLoopIteration *begin(OutputStream *stream, Context *c,
+                                     bool *rendered) const = 0;
+};
+
+/**
+  @internal
+
+  A scope of a Node which is lowered into a RenderProgram.
+*/
+class GRANTLEE_TEMPLATES_EXPORT RenderScope
+{
+public:
+  virtual ~RenderScope();
+
+  /**
+    Enters the scope in the Context @p c and returns true if its nodes
+    should be rendered. Scopes which can not be rendered by a RenderProgram
+    render themselves completely to @p stream and return false.
+  */
+  virtual bool enter(OutputStream *stream, Context *c) const = 0;
+
+  /**
+    Leaves the scope entered in the Context @p c.
+  */
+  virtual void leave(Context *c) const = 0;
+};
+
+/**
+  @internal
+
+  A Template lowered into a linear sequence of instructions.
+
+  Nodes implement CompilableNode to append instructions for themselves and
+  their child nodes. Other nodes are called through Node::render.
+  Text and constants are kept in pools which the instructions refer to by
+  index.
+*/
+class GRANTLEE_TEMPLATES_EXPORT RenderProgram
+{
+public:
+  typedef std::function<bool(Context *c)> Condition;
+  typedef std::function<QString(Context *c)> Localization;
+
+  explicit RenderProgram(const TemplateImpl *t);
+
+  /**
+    Appends the instructions for @p nodes.
+  */
+  void append(const NodeList &nodes);
+
+  /**
+    Appends writing the @p text.
+  */
+  void appendText(const QString &text);
+
+  /**
+    Appends writing the value of @p fe, streamed as by @p node.
+  */
+  void appendVariable(const Node *node, const FilterExpression &fe);
+
+  /**
+    Appends rendering the @p node through Node::render.
+  */
+  void appendNode(const Node *node);
+
+  /**
+    Appends writing the text returned by @p localization, streamed as by
+    @p node. The text may only depend on the localizer of the Context. It is
+    computed once for each localizer, locale and localizerRevision, unless
+    it is left to the translators of the application.
+  */
+  void appendLocalizedText(const Node *node, const Localization &localization);
+
+  /**
+    Appends rendering the nodes of the first of the @p branches whose
+    condition is true. A null condition is always true.
+  */
+  void appendBranches(const QVector<QPair<Condition, NodeList>> &branches);
+
+  /**
+    Appends rendering @p nodes with the @p variables inserted into a new
+    scope of the Context.
+  */
+  void appendVariables(
+      const std::vector<std::pair<QString, FilterExpression>> &variables,
+      const NodeList &nodes);
+
+  /**
+    Appends rendering @p nodes for each item of the @p loop, or
+    @p emptyNodes if it has no items.
+  */
+  void appendLoop(const RenderLoop *loop, const NodeList &nodes,
+                  const NodeList &emptyNodes);
+
+  /**
+    Appends rendering @p nodes in the @p scope.
+  */
+  void appendScope(const RenderScope *scope, const NodeList &nodes);
+
+  /**
+    Appends rendering the Template named by the value of @p fe.
+  */
+  void appendInclude(const FilterExpression &fe);
+
+  /**
+    Renders the program to @p stream in the Context @p c.
+  */
+  void render(OutputStream *stream, Context *c) const;
+
+  /**
+    Renders the Template @p name, which is included by the @p container
+    Template, to @p stream in the Context @p c, and returns it.
+
+    Throws a Grantlee::Exception if it can not be loaded or rendered.
+  */
+  static Template renderInclude(const TemplateImpl *container,
+                                const QString &name, OutputStream *stream,
+                                Context *c);
+
+  /**
+    Returns a listing of the instructions, one per line.
+  */
+  QString dump() const;
+
+  qint64 memoryUsage() const;
+
+private:
+  Q_DISABLE_COPY(RenderProgram)
+
+  enum OpCode {
+    Text,
+    Variable,
+    CallNode,
+    Jump,
+    JumpUnless,
+    Push,
+    Insert,
+    Pop,
+    BeginLoop,
+    NextLoop,
+    EnterScope,
+    LeaveScope,
+    Include,
+    LocalizedText
+  };
+
+  struct Instruction {
+    OpCode op;
+    int a;
+    int b;
+  };
+
+  int instruction(OpCode op, int a = 0, int b = 0);
+  int label();
+  int addExpression(const FilterExpression &fe);
+
+  // The texts of m_localizations for a locale. The texts which may not be
+  // cached are localized again on each render.
+  struct LocalizedTexts {
+    QVector<QString> texts;
+    QVector<bool> cached;
+  };
+
+  LocalizedTexts localizedTexts(Context *c) const;
+
+  const TemplateImpl *const m_template;
+  QVector<Instruction> m_code;
+  QVector<QString> m_strings;
+  QVector<FilterExpression> m_expressions;
+  QVector<const Node *> m_nodes;
+  QVector<Condition> m_conditions;
+  QVector<const RenderLoop *> m_loops;
+  QVector<const RenderScope *> m_scopes;
+  QVector<Localization> m_localizations;
+  int m_textInstruction;
+
+  // The localized texts by localizer, revision and locale.
+  typedef QPair<const AbstractLocalizer *, QPair<int, QString>> LocaleKey;
+  mutable QHash<LocaleKey, LocalizedTexts> m_localizedTexts;
+  mutable QReadWriteLock m_localizedTextsLock;
+};
+}
+
+#endif
@@ -25,9 +25,13 @@
 #include "engine.h"
 #include "exception.h"
 #include "lexer_p.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "rendercontext.h"
+#include "renderprofiler_p.h"
+#include "tracer.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QLoggingCategory>
 
 Q_LOGGING_CATEGORY(GRANTLEE_TEMPLATE, "grantlee.template")
@@ -37,12 +41,37 @@ using namespace Grantlee;
 NodeList TemplatePrivate::compileString(const QString &str)
 {
   Q_Q(TemplateImpl);
-  Lexer l(str);
-  Parser p(l.tokenize(m_smartTrim ? Lexer::SmartTrim : Lexer::NoSmartTrim), q);
+  const auto tracer = m_engine ? m_engine->tracer() : nullptr;
+
+  QList<Token> tokens;
+  {
+    TraceScope scope(tracer, "compile", "lex");
+    scope.setArgument("template", q->objectName());
+    Lexer l(str);
+    tokens = l.tokenize(m_smartTrim ? Lexer::SmartTrim : Lexer::NoSmartTrim);
+  }
+
+  TraceScope scope(tracer, "compile", "parse");
+  scope.setArgument("template", q->objectName());
+  Parser p(tokens, q);
 
   return p.parse(q);
 }
 
+void TemplatePrivate::compileProgram()
+{
+  Q_Q(TemplateImpl);
+  m_program.reset();
+  if (!m_bytecodeEnabled || m_error != NoError)
+    return;
+
+  TraceScope scope(m_engine ? m_engine->tracer() : nullptr, "compile",
+                   "bytecode");
+  scope.setArgument("template", q->objectName());
+  m_program.reset(new RenderProgram(q));
+  m_program->append(m_nodeList);
+}
+
 TemplateImpl::TemplateImpl(Engine const *engine, QObject *parent)
     : QObject(parent), d_ptr(new TemplatePrivate(engine, false, this))
 {
@@ -62,13 +91,20 @@ void TemplateImpl::setContent(const QString &templateString)
   if (templateString.isEmpty())
     return;
 
+  QElapsedTimer timer;
+  timer.start();
+
   try {
     d->m_nodeList = d->compileString(templateString);
     d->setError(NoError, QString());
+    d->compileProgram();
   } catch (Grantlee::Exception &e) {
     qCWarning(GRANTLEE_TEMPLATE) << e.what();
     d->setError(e.errorCode(), e.what());
   }
+
+  if (d->m_metrics)
+    d->m_metrics->compileTimes.record(timer.nsecsElapsed());
 }
 
 QString TemplateImpl::render(Context *c) const
@@ -84,20 +120,46 @@ OutputStream *TemplateImpl::render(OutputStream *stream, Context *c) const
 {
   Q_D(const Template);
 
+  QElapsedTimer timer;
+  timer.start();
+
+  TraceScope scope(d->m_engine ? d->m_engine->tracer() : nullptr, "render",
+                   "render");
+  scope.setArgument("template", objectName());
+
+  RenderMetricsScope metricsScope(d->m_metrics.data());
+
   c->clearExternalMedia();
 
   c->renderContext()->push();
 
   try {
-    d->m_nodeList.render(stream, c);
+    if (const auto profiler = c->renderProfiler()) {
+      // The profiler records the frames of the nodes, so the bytecode is
+      // not used.
+      ProfileScope scope(profiler, this);
+      d->m_nodeList.render(stream, c);
+    } else if (d->m_program) {
+      d->m_program->render(stream, c);
+    } else {
+      d->m_nodeList.render(stream, c);
+    }
     d->setError(NoError, QString());
   } catch (Grantlee::Exception &e) {
     qCWarning(GRANTLEE_TEMPLATE) << e.what();
     d->setError(e.errorCode(), e.what());
+    if (d->m_metrics)
+      d->m_metrics->recordRenderError(e.errorCode());
   }
 
   c->renderContext()->pop();
 
+  const auto renderTime = timer.nsecsElapsed();
+  if (d->m_renderTimes)
+    d->m_renderTimes->record(renderTime);
+  if (d->m_metrics && d->m_metrics->callback)
+    d->m_metrics->callback(objectName(), renderTime, d->m_error);
+
   return stream;
 }
 
@@ -111,6 +173,7 @@ void TemplateImpl::setNodeList(const NodeList &list)
 {
   Q_D(Template);
   d->m_nodeList = list;
+  d->compileProgram();
 }
 
 void TemplatePrivate::setError(Error type, const QString &message) const
@@ -136,3 +199,20 @@ Engine const *TemplateImpl::engine() const
   Q_D(const Template);
   return d->m_engine.data();
 }
+
+qint64 TemplateImpl::memoryUsage() const
+{
+  Q_D(const Template);
+  auto size = s_objectSize + sizeof(TemplateImpl) - sizeof(QObject)
+              + sizeof(TemplatePrivate) + heapSize(d->m_nodeList)
+              + heapSize(d->m_errorString) + heapSize(objectName());
+
+  // All nodes are descendants of the Template, including those in the node
+  // lists of other nodes.
+  const auto nodes = findChildren<Node *>();
+  for (const auto node : nodes)
+    size += nodeMemoryUsage(node);
+  if (d->m_program)
+    size += d->m_program->memoryUsage();
+  return size;
+}
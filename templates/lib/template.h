@@ -135,6 +135,15 @@ public:
   */
   Engine const *engine() const;
 
+  /**
+    Returns an estimate of the memory in bytes retained by this compiled
+    **%Template**, including its nodes, text and filter expressions.
+
+    Filters are shared by all Templates created by an Engine and are not
+    included.
+  */
+  qint64 memoryUsage() const;
+
 #ifndef Q_QDOC
 protected:
   TemplateImpl(Engine const *engine, QObject *parent = {});
@@ -152,6 +161,7 @@ private:
   Q_DECLARE_PRIVATE(Template)
   TemplatePrivate *const d_ptr;
 #ifndef Q_QDOC
+  friend class CompiledTemplateLoader;
   friend class Engine;
   friend class Parser;
 #endif
@@ -22,9 +22,12 @@
 #define GRANTLEE_TEMPLATE_P_H
 
 #include "engine.h"
+#include "enginemetrics_p.h"
+#include "renderprogram_p.h"
 #include "template.h"
 
 #include <QtCore/QPointer>
+#include <QtCore/QScopedPointer>
 
 namespace Grantlee
 {
@@ -34,12 +37,14 @@ class Engine;
 class TemplatePrivate
 {
   TemplatePrivate(Engine const *engine, bool smartTrim, TemplateImpl *t)
-      : q_ptr(t), m_error(NoError), m_smartTrim(smartTrim), m_engine(engine)
+      : q_ptr(t), m_error(NoError), m_smartTrim(smartTrim),
+        m_bytecodeEnabled(false), m_engine(engine)
   {
   }
 
   void parse();
   NodeList compileString(const QString &str);
+  void compileProgram();
   void setError(Error type, const QString &message) const;
 
   Q_DECLARE_PUBLIC(TemplateImpl)
@@ -49,8 +54,13 @@ class TemplatePrivate
   mutable QString m_errorString;
   NodeList m_nodeList;
   bool m_smartTrim;
+  bool m_bytecodeEnabled;
+  QScopedPointer<RenderProgram> m_program;
   QPointer<const Engine> m_engine;
+  QSharedPointer<EngineMetricsData> m_metrics;
+  QSharedPointer<MetricHistogram> m_renderTimes;
 
+  friend class CompiledTemplateLoader;
   friend class Grantlee::Engine;
   friend class Parser;
 };
@@ -23,6 +23,7 @@
 #include "engine.h"
 #include "exception.h"
 #include "nulllocalizer_p.h"
+#include "tracer.h"
 
 #include <QtCore/QDir>
 #include <QtCore/QFile>
@@ -159,7 +160,13 @@ Template FileSystemTemplateLoader::loadByName(const QString &fileName,
 #else
   fstream.setEncoding(QStringConverter::Utf8);
 #endif
-  const auto fileContent = fstream.readAll();
+  QString fileContent;
+  {
+    TraceScope scope(engine->tracer(), "load", "readFile");
+    scope.setArgument("template", fileName);
+    scope.setArgument("file", file.fileName());
+    fileContent = fstream.readAll();
+  }
 
   return engine->newTemplate(fileContent, fileName);
 }
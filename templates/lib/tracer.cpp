@@ -0,0 +1,147 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "tracer.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+namespace Grantlee
+{
+
+class TracerPrivate
+{
+  TracerPrivate(Tracer *tracer, QIODevice *device, QFile *file)
+      : q_ptr(tracer), m_device(device), m_file(file), m_events(0)
+  {
+    m_timer.start();
+  }
+
+  // The caller must hold the mutex.
+  void write();
+
+  Q_DECLARE_PUBLIC(Tracer)
+  Tracer *const q_ptr;
+
+  QIODevice *const m_device;
+  QFile *const m_file;
+  QElapsedTimer m_timer;
+  QMutex m_mutex;
+  QByteArray m_buffer;
+  int m_events;
+};
+}
+
+using namespace Grantlee;
+
+// The events are written to the output in batches, so that recording an
+// event rarely has to wait for the device.
+static const int s_bufferSize = 64 * 1024;
+
+void TracerPrivate::write()
+{
+  const auto device = m_file ? m_file : m_device;
+  if (device && device->isWritable())
+    device->write(m_buffer);
+  m_buffer.clear();
+}
+
+static QFile *openTraceFile(const QString &fileName)
+{
+  auto file = new QFile(fileName);
+  file->open(QIODevice::WriteOnly | QIODevice::Truncate);
+  return file;
+}
+
+Tracer::Tracer(const QString &fileName)
+    : d_ptr(new TracerPrivate(this, nullptr, openTraceFile(fileName)))
+{
+}
+
+Tracer::Tracer(QIODevice *device)
+    : d_ptr(new TracerPrivate(this, device, nullptr))
+{
+}
+
+Tracer::~Tracer()
+{
+  Q_D(Tracer);
+  if (d->m_events == 0)
+    d->m_buffer.append('[');
+  d->m_buffer.append("\n]\n");
+  flush();
+  delete d->m_file;
+  delete d_ptr;
+}
+
+bool Tracer::isOpen() const
+{
+  Q_D(const Tracer);
+  const auto device = d->m_file ? d->m_file : d->m_device;
+  return device && device->isWritable();
+}
+
+void Tracer::flush()
+{
+  Q_D(Tracer);
+  QMutexLocker locker(&d->m_mutex);
+  d->write();
+  if (d->m_file)
+    d->m_file->flush();
+}
+
+qint64 Tracer::elapsed() const
+{
+  Q_D(const Tracer);
+  return d->m_timer.nsecsElapsed();
+}
+
+void Tracer::addEvent(const char *category, const char *name, qint64 start,
+                      qint64 duration, const QJsonObject &args)
+{
+  Q_D(Tracer);
+
+  // Complete events with timestamps in microseconds, as described in the
+  // Trace Event Format specification.
+  QJsonObject event;
+  event.insert(QStringLiteral("name"), QLatin1String(name));
+  event.insert(QStringLiteral("cat"), QLatin1String(category));
+  event.insert(QStringLiteral("ph"), QStringLiteral("X"));
+  event.insert(QStringLiteral("ts"), start / 1000.0);
+  event.insert(QStringLiteral("dur"), duration / 1000.0);
+  event.insert(QStringLiteral("pid"), QCoreApplication::applicationPid());
+  event.insert(QStringLiteral("tid"),
+               static_cast<qint64>(reinterpret_cast<quintptr>(
+                   QThread::currentThreadId())));
+  if (!args.isEmpty())
+    event.insert(QStringLiteral("args"), args);
+
+  const auto json = QJsonDocument(event).toJson(QJsonDocument::Compact);
+
+  QMutexLocker locker(&d->m_mutex);
+  d->m_buffer.append(d->m_events++ == 0 ? "[\n" : ",\n");
+  d->m_buffer.append(json);
+  if (d->m_buffer.size() >= s_bufferSize)
+    d->write();
+}
@@ -0,0 +1,166 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_TRACER_H
+#define GRANTLEE_TRACER_H
+
+#include "grantlee_templates_export.h"
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+class QIODevice;
+
+namespace Grantlee
+{
+
+class TracerPrivate;
+
+/// @headerfile tracer.h grantlee/tracer.h
+
+/**
+  @brief The **%Tracer** writes a timeline of the work done by an Engine in
+  the Chrome trace event format.
+
+  A **%Tracer** set on an Engine records an event for each Template loaded,
+  lexed, parsed and rendered, for each nested @gr_tag{extends} and
+  @gr_tag{include} tag and for each library loaded. Each event records the
+  thread it occurred in and the name of the Template it belongs to.
+
+  @code
+    Tracer tracer("trace.json");
+    engine->setTracer(&tracer);
+
+    auto t = engine->loadByName("page.html");
+    t->render(&c);
+  @endcode
+
+  The output can be opened in Perfetto or <tt>chrome://tracing</tt>. The
+  trace is completed when the **%Tracer** is destroyed, so it must outlive
+  the Engine it is set on and all Templates rendered by it.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEMPLATES_EXPORT Tracer
+{
+public:
+  /**
+    Constructs a **%Tracer** which writes the trace to the file called
+    @p fileName.
+  */
+  explicit Tracer(const QString &fileName);
+
+  /**
+    Constructs a **%Tracer** which writes the trace to @p device. The
+    @p device must be open for writing and remain valid until the
+    **%Tracer** is destroyed.
+  */
+  explicit Tracer(QIODevice *device);
+
+  /**
+    Destructor. Completes the trace.
+  */
+  ~Tracer();
+
+  /**
+    Returns whether the trace can be written.
+  */
+  bool isOpen() const;
+
+  /**
+    Writes the events recorded so far to the output.
+  */
+  void flush();
+
+private:
+  qint64 elapsed() const;
+  void addEvent(const char *category, const char *name, qint64 start,
+                qint64 duration, const QJsonObject &args);
+
+  friend class TraceScope;
+
+  Q_DISABLE_COPY(Tracer)
+  Q_DECLARE_PRIVATE(Tracer)
+  TracerPrivate *const d_ptr;
+};
+
+/// @headerfile tracer.h grantlee/tracer.h
+
+/**
+  @brief Records the time until the end of the scope as an event in a
+  Tracer.
+
+  Tag implementations may use a **%TraceScope** to show their work in the
+  trace of the Engine.
+
+  @code
+    void MyNode::render(OutputStream *stream, Context *c) const
+    {
+      TraceScope scope(containerTemplate()->engine()->tracer(), "mytags",
+                       "mytag");
+      scope.setArgument("template", containerTemplate()->objectName());
+      // ...
+    }
+  @endcode
+
+  If the @p tracer is null nothing is recorded.
+*/
+class TraceScope
+{
+public:
+  /**
+    Starts an event called @p name in the @p category.
+  */
+  TraceScope(Tracer *tracer, const char *category, const char *name)
+      : m_tracer(tracer), m_category(category), m_name(name),
+        m_start(tracer ? tracer->elapsed() : 0)
+  {
+  }
+
+  /**
+    Records the event.
+  */
+  ~TraceScope()
+  {
+    if (m_tracer)
+      m_tracer->addEvent(m_category, m_name, m_start,
+                         m_tracer->elapsed() - m_start, m_args);
+  }
+
+  /**
+    Sets the argument @p key of the event to @p value.
+  */
+  void setArgument(const char *key, const QString &value)
+  {
+    if (m_tracer)
+      m_args.insert(QLatin1String(key), value);
+  }
+
+private:
+  Q_DISABLE_COPY(TraceScope)
+  Tracer *const m_tracer;
+  const char *const m_category;
+  const char *const m_name;
+  const qint64 m_start;
+  QJsonObject m_args;
+};
+}
+
+#endif
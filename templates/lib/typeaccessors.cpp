@@ -21,8 +21,10 @@
 #include "typeaccessor.h"
 
 #include "metaenumvariable_p.h"
+#include "modelindexlookup_p.h"
 #include "safestring.h"
 
+#include <QtCore/QAbstractItemModel>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QStringList>
 #include <QtCore/QVariant>
@@ -200,4 +202,115 @@ TypeAccessor<MetaEnumVariable &>::lookUp(const MetaEnumVariable &object,
 
   return {};
 }
+
+/*
+  Returns the row or column of @p index. They are looked up after the role
+  names and column headers of the model, so that a role or header called
+  "row" or "column" is not hidden.
+*/
+static QVariant indexPosition(const QModelIndex &index, const QString &property)
+{
+  if (property == QStringLiteral("row"))
+    return index.row();
+  if (property == QStringLiteral("column"))
+    return index.column();
+  return {};
+}
+
+template <>
+QVariant TypeAccessor<QModelIndex &>::lookUp(const QModelIndex &object,
+                                             const QString &property)
+{
+  const auto model = object.model();
+  if (!model)
+    return {};
+
+  const auto parent = object.parent();
+  const auto columnCount = model->columnCount(parent);
+
+  auto ok = false;
+  const auto column = property.toInt(&ok);
+  if (ok) {
+    if (column < 0 || column >= columnCount)
+      return {};
+    return model->index(object.row(), column, parent).data();
+  }
+
+  if (!parent.isValid()) {
+    if (const auto lookup = ModelIndexLookup::active(model)) {
+      QVariant result;
+      if (lookup->lookUp(object, property, &result))
+        return result;
+      return indexPosition(object, property);
+    }
+  }
+
+  const auto roleNames = model->roleNames();
+  const auto utf8Property = property.toUtf8();
+  for (auto it = roleNames.constBegin(); it != roleNames.constEnd(); ++it) {
+    if (it.value() == utf8Property)
+      return object.data(it.key());
+  }
+
+  for (auto i = 0; i < columnCount; ++i) {
+    if (model->headerData(i, Qt::Horizontal).toString() == property)
+      return model->index(object.row(), i, parent).data();
+  }
+  return indexPosition(object, property);
+}
+}
+
+using namespace Grantlee;
+
+static thread_local const ModelIndexLookup *s_activeLookup = nullptr;
+
+ModelIndexLookup::ModelIndexLookup(const QAbstractItemModel *model)
+    : m_model(model), m_previous(s_activeLookup)
+{
+  // The first role and the first column of each name are used, as in
+  // lookups without a ModelIndexLookup.
+  const auto roleNames = model->roleNames();
+  for (auto it = roleNames.constBegin(); it != roleNames.constEnd(); ++it) {
+    const auto name = QString::fromUtf8(it.value());
+    if (!m_roles.contains(name))
+      m_roles.insert(name, it.key());
+  }
+
+  const auto columnCount = model->columnCount();
+  for (auto i = 0; i < columnCount; ++i) {
+    const auto name = model->headerData(i, Qt::Horizontal).toString();
+    if (!m_columns.contains(name))
+      m_columns.insert(name, i);
+  }
+
+  s_activeLookup = this;
+}
+
+ModelIndexLookup::~ModelIndexLookup() { s_activeLookup = m_previous; }
+
+const ModelIndexLookup *
+ModelIndexLookup::active(const QAbstractItemModel *model)
+{
+  for (auto lookup = s_activeLookup; lookup; lookup = lookup->m_previous) {
+    if (lookup->m_model == model)
+      return lookup;
+  }
+  return nullptr;
+}
+
+bool ModelIndexLookup::lookUp(const QModelIndex &index,
+                              const QString &property, QVariant *result) const
+{
+  const auto role = m_roles.constFind(property);
+  if (role != m_roles.constEnd()) {
+    *result = index.data(role.value());
+    return true;
+  }
+
+  const auto column = m_columns.constFind(property);
+  if (column != m_columns.constEnd()) {
+    *result = m_model->index(index.row(), column.value()).data();
+    return true;
+  }
+  return false;
 }
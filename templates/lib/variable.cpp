@@ -23,12 +23,15 @@
 #include "abstractlocalizer.h"
 #include "context.h"
 #include "exception.h"
+#include "lookupkey_p.h"
+#include "memoryusage_p.h"
 #include "metaenumvariable_p.h"
 #include "metatype.h"
 #include "util.h"
 
 #include <QtCore/QMetaEnum>
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 
 using namespace Grantlee;
 
@@ -46,6 +49,7 @@ public:
   QString m_varString;
   QVariant m_literal;
   QStringList m_lookups;
+  QVector<LookupKey> m_lookupKeys;
   bool m_localize;
 };
 }
@@ -66,6 +70,7 @@ Variable &Variable::operator=(const Variable &other)
   d_ptr->m_varString = other.d_ptr->m_varString;
   d_ptr->m_literal = other.d_ptr->m_literal;
   d_ptr->m_lookups = other.d_ptr->m_lookups;
+  d_ptr->m_lookupKeys = other.d_ptr->m_lookupKeys;
   d_ptr->m_localize = other.d_ptr->m_localize;
   return *this;
 }
@@ -122,6 +127,9 @@ Variable::Variable(const QString &var) : d_ptr(new VariablePrivate(this))
                 .arg(localVar));
       }
       d->m_lookups = localVar.split(QLatin1Char('.'));
+      d->m_lookupKeys.reserve(d->m_lookups.size());
+      for (const auto &segment : qAsConst(d->m_lookups))
+        d->m_lookupKeys.append(LookupKey::intern(segment));
     }
   }
 }
@@ -158,6 +166,15 @@ QStringList Variable::lookups() const
   return d->m_lookups;
 }
 
+qint64 Variable::memoryUsage() const
+{
+  Q_D(const Variable);
+  // The names of lookup keys are interned and shared by all Variables.
+  return sizeof(VariablePrivate) + heapSize(d->m_varString)
+         + heapSize(d->m_literal) + heapSize(d->m_lookups)
+         + heapSize(d->m_lookupKeys);
+}
+
 class StaticQtMetaObject : public QObject
 {
 public:
@@ -216,7 +233,7 @@ QVariant Variable::resolve(Context *c) const
       var = c->lookup(d->m_lookups.at(i++));
     }
     while (i < d->m_lookups.size()) {
-      var = MetaType::lookup(var, d->m_lookups.at(i++));
+      var = d->m_lookupKeys.at(i++).lookup(var);
       if (!var.isValid())
         return {};
     }
@@ -120,6 +120,12 @@ public:
    */
   QStringList lookups() const;
 
+  /**
+    Returns an estimate of the memory in bytes retained by this
+    **%Variable** on the heap.
+   */
+  qint64 memoryUsage() const;
+
 private:
   Q_DECLARE_PRIVATE(Variable)
   VariablePrivate *const d_ptr;
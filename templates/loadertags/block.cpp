@@ -22,6 +22,7 @@
 
 #include "blockcontext.h"
 #include "exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "rendercontext.h"
 #include "template.h"
@@ -164,3 +165,40 @@ SafeString BlockNode::getSuper() const
 NodeList BlockNode::nodeList() const { return m_list; }
 
 QString BlockNode::name() const { return m_name; }
+
+qint64 BlockNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(BlockNode) - sizeof(Node)
+         + heapSize(m_name) + heapSize(m_list);
+}
+
+bool BlockNode::compile(RenderProgram *program) const
+{
+  program->appendScope(this, m_list);
+  return true;
+}
+
+bool BlockNode::enter(OutputStream *stream, Context *c) const
+{
+  // Blocks which are overridden by an extending template are rendered by
+  // the node.
+  const auto &variant = c->renderContext()->data(BLOCK_CONTEXT_KEY);
+  if (!variant.value<BlockContext>().isEmpty()) {
+    render(stream, c);
+    return false;
+  }
+
+  c->push();
+  m_context = c;
+  m_stream = stream;
+  c->insert(QStringLiteral("block"),
+            QVariant::fromValue(
+                const_cast<QObject *>(static_cast<const QObject *>(this))));
+  return true;
+}
+
+void BlockNode::leave(Context *c) const
+{
+  m_stream = nullptr;
+  c->pop();
+}
@@ -21,7 +21,9 @@
 #ifndef BLOCKNODE_H
 #define BLOCKNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
+#include "renderprogram_p.h"
 
 namespace Grantlee
 {
@@ -39,7 +41,10 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class BlockNode : public Node
+class BlockNode : public Node,
+                  public RenderScope,
+                  public NodeMemoryUsage,
+                  public CompilableNode
 {
   Q_OBJECT
   Q_PROPERTY(Grantlee::SafeString super READ getSuper)
@@ -51,6 +56,14 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
+  bool enter(OutputStream *stream, Context *c) const override;
+
+  void leave(Context *c) const override;
+
   BlockNode *takeNodeParent();
 
   QString name() const;
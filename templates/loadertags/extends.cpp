@@ -24,10 +24,12 @@
 #include "blockcontext.h"
 #include "engine.h"
 #include "exception.h"
+#include "memoryusage_p.h"
 #include "nodebuiltins_p.h"
 #include "parser.h"
 #include "rendercontext.h"
 #include "template.h"
+#include "tracer.h"
 #include "util.h"
 
 using namespace Grantlee;
@@ -123,6 +125,10 @@ Template ExtendsNode::getParent(Context *c) const
 
 void ExtendsNode::render(OutputStream *stream, Context *c) const
 {
+  const auto ti = containerTemplate();
+  TraceScope scope(ti->engine()->tracer(), "render", "extends");
+  scope.setArgument("template", ti->objectName());
+
   const auto parentTemplate = getParent(c);
 
   if (!parentTemplate) {
@@ -130,6 +136,8 @@ void ExtendsNode::render(OutputStream *stream, Context *c) const
                               QStringLiteral("Cannot load template."));
   }
 
+  scope.setArgument("parent", parentTemplate->objectName());
+
   QVariant &variant = c->renderContext()->data(nullptr);
   auto blockContext = variant.value<BlockContext>();
   blockContext.addBlocks(m_blocks);
@@ -164,3 +172,14 @@ void ExtendsNode::appendNode(Node *node)
   m_list.append(node);
   node->setParent(parent());
 }
+
+qint64 ExtendsNode::memoryUsage() const
+{
+  // The parent template is loaded when rendering and is not retained.
+  auto size = nodeSize() + sizeof(ExtendsNode) - sizeof(Node)
+              + m_filterExpression.memoryUsage() + heapSize(m_list)
+              + heapSize(m_blocks);
+  for (auto it = m_blocks.constBegin(); it != m_blocks.constEnd(); ++it)
+    size += heapSize(it.key());
+  return size;
+}
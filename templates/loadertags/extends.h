@@ -21,6 +21,7 @@
 #ifndef EXTENDSNODE_H
 #define EXTENDSNODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
 #include "template.h"
 
@@ -42,7 +43,7 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class ExtendsNode : public Node
+class ExtendsNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
@@ -53,6 +54,8 @@ public:
 
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
   void appendNode(Node *node);
 
   Template getParent(Context *c) const;
@@ -24,9 +24,12 @@
 #include "blockcontext.h"
 #include "engine.h"
 #include "exception.h"
+#include "memoryusage_p.h"
 #include "parser.h"
 #include "rendercontext.h"
+#include "renderprogram_p.h"
 #include "template.h"
+#include "tracer.h"
 #include "util.h"
 
 IncludeNodeFactory::IncludeNodeFactory() = default;
@@ -59,23 +62,9 @@ IncludeNode::IncludeNode(const FilterExpression &fe, QObject *parent)
 
 void IncludeNode::render(OutputStream *stream, Context *c) const
 {
-  QString filename = getSafeString(m_filterExpression.resolve(c));
-
-  auto ti = containerTemplate();
-
-  auto t = ti->engine()->loadByName(filename);
-
-  if (!t)
-    throw Grantlee::Exception(
-        TagSyntaxError, QStringLiteral("Template not found %1").arg(filename));
-
-  if (t->error())
-    throw Grantlee::Exception(t->error(), t->errorString());
-
-  t->render(stream, c);
-
-  if (t->error())
-    throw Grantlee::Exception(t->error(), t->errorString());
+  RenderProgram::renderInclude(containerTemplate(),
+                               getSafeString(m_filterExpression.resolve(c)),
+                               stream, c);
 }
 
 ConstantIncludeNode::ConstantIncludeNode(const QString &name, QObject *parent)
@@ -86,20 +75,7 @@ ConstantIncludeNode::ConstantIncludeNode(const QString &name, QObject *parent)
 
 void ConstantIncludeNode::render(OutputStream *stream, Context *c) const
 {
-  auto ti = containerTemplate();
-
-  auto t = ti->engine()->loadByName(m_name);
-  if (!t)
-    throw Grantlee::Exception(
-        TagSyntaxError, QStringLiteral("Template not found %1").arg(m_name));
-
-  if (t->error())
-    throw Grantlee::Exception(t->error(), t->errorString());
-
-  t->render(stream, c);
-
-  if (t->error())
-    throw Grantlee::Exception(t->error(), t->errorString());
+  auto t = RenderProgram::renderInclude(containerTemplate(), m_name, stream, c);
 
   QVariant &variant = c->renderContext()->data(nullptr);
   auto blockContext = variant.value<BlockContext>();
@@ -107,3 +83,21 @@ void ConstantIncludeNode::render(OutputStream *stream, Context *c) const
   blockContext.remove(nodes);
   variant.setValue(blockContext);
 }
+
+qint64 IncludeNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(IncludeNode) - sizeof(Node)
+         + m_filterExpression.memoryUsage();
+}
+
+qint64 ConstantIncludeNode::memoryUsage() const
+{
+  return nodeSize() + sizeof(ConstantIncludeNode) - sizeof(Node)
+         + heapSize(m_name);
+}
+
+bool IncludeNode::compile(RenderProgram *program) const
+{
+  program->appendInclude(m_filterExpression);
+  return true;
+}
@@ -21,7 +21,9 @@
 #ifndef INCLUDENODE_H
 #define INCLUDENODE_H
 
+#include "memoryusage_p.h"
 #include "node.h"
+#include "renderprogram_p.h"
 
 namespace Grantlee
 {
@@ -39,24 +41,32 @@ public:
   Node *getNode(const QString &tagContent, Parser *p) const override;
 };
 
-class IncludeNode : public Node
+class IncludeNode : public Node,
+                    public NodeMemoryUsage,
+                    public CompilableNode
 {
   Q_OBJECT
 public:
   explicit IncludeNode(const FilterExpression &fe, QObject *parent = {});
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
+  bool compile(RenderProgram *program) const override;
+
 private:
   FilterExpression m_filterExpression;
 };
 
-class ConstantIncludeNode : public Node
+class ConstantIncludeNode : public Node, public NodeMemoryUsage
 {
   Q_OBJECT
 public:
   ConstantIncludeNode(const QString &filename, QObject *parent = {});
   void render(OutputStream *stream, Context *c) const override;
 
+  qint64 memoryUsage() const override;
+
 private:
   QString m_name;
 };
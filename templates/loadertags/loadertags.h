@@ -39,7 +39,8 @@ class LoaderTagLibrary : public QObject, public TagLibraryInterface
 {
   Q_OBJECT
   Q_INTERFACES(Grantlee::TagLibraryInterface)
-  Q_PLUGIN_METADATA(IID "org.grantlee.TagLibraryInterface")
+  Q_PLUGIN_METADATA(
+      IID "org.grantlee.TagLibraryInterface" FILE "loadertags.json")
 public:
   LoaderTagLibrary() {}
 
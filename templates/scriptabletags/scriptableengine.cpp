@@ -0,0 +1,327 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "scriptableengine.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtQml/QJSEngine>
+
+#include "scriptablenode.h"
+#include "scriptablesafestring.h"
+#include "scriptabletags.h"
+
+// The engine locked by the current thread, so that scripted filters called
+// while a script runs use it instead of locking another engine.
+static thread_local ScriptableEngine *s_activeEngine = nullptr;
+
+// The engine of the current thread in the last pool it was taken from, so
+// that filters called for each row of a loop do not lock the pool.
+struct ThreadEngine {
+  int pool;
+  ScriptableEngine *engine;
+};
+static thread_local ThreadEngine s_threadEngine = {0, nullptr};
+
+static QAtomicInt s_poolSerial;
+
+ScriptableEngine::ScriptableEngine(ScriptableEnginePool *pool,
+                                   ScriptableTagLibrary *library,
+                                   Engine *templateEngine)
+    : m_pool(pool), m_engine(new QJSEngine), m_filterCalls(0),
+      m_templateEngine(templateEngine), m_scripts(0)
+{
+  for (auto i = 0; i < 2; ++i) {
+    m_arguments[i] = new ScriptableSafeString(m_engine);
+    m_argumentValues[i] = m_engine->newQObject(m_arguments[i]);
+  }
+
+  m_functions = m_engine->newQObject(new ScriptableHelperFunctions(this));
+
+  m_engine->globalObject().setProperty(
+      QStringLiteral("internalGrantleeFunctions"), m_functions);
+
+  // Make Node new-able
+  m_engine->globalObject().setProperty(
+      QStringLiteral("Node"), m_engine->evaluate(QStringLiteral(R"javascript(
+            (function() {
+              return internalGrantleeFunctions.ScriptableNodeConstructor(
+                Array.prototype.slice.call(arguments));
+            })
+          )javascript")));
+
+  // Make Variable new-able
+  m_engine->globalObject().setProperty(
+      QStringLiteral("Variable"),
+      m_functions.property(QStringLiteral("ScriptableVariableConstructor")));
+
+  // Make FilterExpression new-able
+  m_engine->globalObject().setProperty(
+      QStringLiteral("FilterExpression"),
+      m_functions.property(
+          QStringLiteral("ScriptableFilterExpressionConstructor")));
+
+  // Make Template new-able
+  m_engine->globalObject().setProperty(
+      QStringLiteral("Template"),
+      m_functions.property(QStringLiteral("ScriptableTemplateConstructor")));
+
+  // Create a global Library object
+  auto libraryObject = m_engine->newQObject(library);
+  m_engine->globalObject().setProperty(QStringLiteral("Library"),
+                                       libraryObject);
+
+  // Create a global AbstractNodeFactory object to make smartSplit available.
+  auto nodeFactory = new ScriptableNodeFactory(m_engine);
+  auto nodeFactoryObject = m_engine->newQObject(nodeFactory);
+  m_engine->globalObject().setProperty(QStringLiteral("AbstractNodeFactory"),
+                                       nodeFactoryObject);
+
+  // Make mark_safe a globally available object.
+  m_engine->globalObject().setProperty(
+      QStringLiteral("mark_safe"),
+      m_functions.property(QStringLiteral("markSafeFunction")));
+}
+
+ScriptableEngine::~ScriptableEngine()
+{
+  // Values must not outlive their engine.
+  m_nodes.clear();
+  m_globals.clear();
+  m_functions = QJSValue();
+  for (auto &value : m_argumentValues)
+    value = QJSValue();
+  delete m_engine;
+}
+
+QJSValue ScriptableEngine::global(const QString &name)
+{
+  auto it = m_globals.find(name);
+  if (it == m_globals.end())
+    it = m_globals.insert(name, m_engine->globalObject().property(name));
+  return it.value();
+}
+
+QJSValue ScriptableEngine::evaluate(const QString &source)
+{
+  m_globals.clear();
+  return m_engine->evaluate(source);
+}
+
+QJSValue ScriptableEngine::filterArgument(int index, const SafeString &content)
+{
+  if (m_filterCalls > 1) {
+    // A nested call must not change the arguments of the call which is
+    // running. The wrapper is owned by the script engine.
+    auto ssObj = new ScriptableSafeString;
+    ssObj->setContent(content);
+    return m_engine->newQObject(ssObj);
+  }
+  m_arguments[index]->setContent(content);
+  return m_argumentValues[index];
+}
+
+ScriptableEngine::NodeState
+ScriptableEngine::nodeState(const ScriptableNode *node)
+{
+  removeReleasedNodes();
+  return m_nodes.value(node);
+}
+
+void ScriptableEngine::setNodeState(const ScriptableNode *node,
+                                    const NodeState &state)
+{
+  removeReleasedNodes();
+  m_nodes.insert(node, state);
+}
+
+void ScriptableEngine::releaseNode(const ScriptableNode *node)
+{
+  QMutexLocker locker(&m_releasedMutex);
+  m_releasedNodes.append(node);
+}
+
+void ScriptableEngine::removeReleasedNodes()
+{
+  QVector<const ScriptableNode *> nodes;
+  {
+    QMutexLocker locker(&m_releasedMutex);
+    nodes.swap(m_releasedNodes);
+  }
+  for (const auto node : qAsConst(nodes))
+    m_nodes.remove(node);
+}
+
+ScriptableEngine *ScriptableEngine::active() { return s_activeEngine; }
+
+QJSEngine *ScriptableEngine::activeEngine(QJSEngine *fallback)
+{
+  return s_activeEngine ? s_activeEngine->m_engine : fallback;
+}
+
+ScriptableEngineLocker::ScriptableEngineLocker(ScriptableEngine *engine)
+    : m_engine(engine), m_previous(s_activeEngine)
+{
+  m_engine->m_mutex.lock();
+  s_activeEngine = m_engine;
+}
+
+ScriptableEngineLocker::~ScriptableEngineLocker()
+{
+  s_activeEngine = m_previous;
+  m_engine->m_mutex.unlock();
+}
+
+ScriptableEnginePool::ScriptableEnginePool(ScriptableTagLibrary *library)
+    : QObject(library), m_library(library),
+      m_serial(s_poolSerial.fetchAndAddRelaxed(1) + 1),
+      m_templateEngine(nullptr)
+{
+}
+
+ScriptableEnginePool::~ScriptableEnginePool()
+{
+  // Deleting an engine may delete nodes, which release themselves in the
+  // pool.
+  QHash<QThread *, QSharedPointer<ScriptableEngine>> engines;
+  {
+    QMutexLocker locker(&m_mutex);
+    engines.swap(m_engines);
+  }
+}
+
+QSharedPointer<ScriptableEngine> ScriptableEnginePool::engine()
+{
+  // Only the current thread evaluates scripts in its engine, so the count
+  // of scripts of the cached engine is not locked.
+  const auto cached = s_threadEngine;
+  if (cached.pool == m_serial
+      && cached.engine->m_scripts == m_scriptCount.loadAcquire())
+    return cached.engine->self();
+
+  const auto thread = QThread::currentThread();
+
+  QSharedPointer<ScriptableEngine> engine;
+  QVector<QString> scripts;
+  {
+    QMutexLocker locker(&m_mutex);
+    engine = m_engines.value(thread);
+    if (!engine) {
+      engine = QSharedPointer<ScriptableEngine>(
+          new ScriptableEngine(this, m_library, m_templateEngine));
+      engine->m_self = engine;
+      m_engines.insert(thread, engine);
+
+      // The objects of nodes in the engine are deleted with it when the
+      // thread has finished.
+      connect(
+          thread, &QThread::finished, this,
+          [this, thread] {
+            // The engine is deleted after the pool is unlocked, because
+            // deleting the nodes it owns releases them in the pool.
+            QSharedPointer<ScriptableEngine> engine;
+            QMutexLocker locker(&m_mutex);
+            engine = m_engines.take(thread);
+            locker.unlock();
+          },
+          Qt::DirectConnection);
+    }
+    scripts = m_scripts;
+  }
+
+  ScriptableEngineLocker locker(engine.data());
+  for (auto i = engine->m_scripts; i < scripts.size(); ++i)
+    engine->evaluate(scripts.at(i));
+  engine->m_scripts = qMax(engine->m_scripts, int(scripts.size()));
+  s_threadEngine = {m_serial, engine.data()};
+  return engine;
+}
+
+QString ScriptableEnginePool::source(const QString &fileName)
+{
+  const QFileInfo info(fileName);
+  if (!info.exists())
+    return {};
+  const auto modified = info.lastModified();
+
+  QMutexLocker locker(&m_mutex);
+  const auto it = m_sources.constFind(fileName);
+  if (it != m_sources.constEnd() && it.value().first == modified)
+    return it.value().second;
+
+  QFile scriptFile(fileName);
+  if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    return {};
+
+  QTextStream fstream(&scriptFile);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  fstream.setCodec("UTF-8");
+#else
+  fstream.setEncoding(QStringConverter::Utf8);
+#endif
+  auto fileContent = fstream.readAll();
+  // An empty script is not a missing one.
+  if (fileContent.isNull())
+    fileContent = QLatin1String("");
+
+  m_sources.insert(fileName, qMakePair(modified, fileContent));
+  return fileContent;
+}
+
+QJSValue ScriptableEnginePool::evaluate(ScriptableEngine *engine,
+                                        const QString &source)
+{
+  const auto result = engine->evaluate(source);
+  if (result.isError())
+    return result;
+
+  QMutexLocker locker(&m_mutex);
+  if (!m_scripts.contains(source)) {
+    // An engine which evaluated all earlier scripts does not need to
+    // evaluate this one again.
+    if (engine->m_scripts == m_scripts.size())
+      ++engine->m_scripts;
+    m_scripts.append(source);
+    m_scriptCount.storeRelease(m_scripts.size());
+  }
+  return result;
+}
+
+void ScriptableEnginePool::setTemplateEngine(Engine *templateEngine)
+{
+  QMutexLocker locker(&m_mutex);
+  m_templateEngine = templateEngine;
+  for (const auto &engine : qAsConst(m_engines))
+    engine->m_templateEngine.storeRelease(templateEngine);
+}
+
+void ScriptableEnginePool::releaseNode(
+    const ScriptableNode *node, const QVector<ScriptableEngine *> &engines)
+{
+  // The engines are not locked, because they may be running scripts in
+  // other threads.
+  QMutexLocker locker(&m_mutex);
+  for (const auto &engine : qAsConst(m_engines)) {
+    if (engines.contains(engine.data()))
+      engine->releaseNode(node);
+  }
+}
@@ -0,0 +1,248 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SCRIPTABLE_ENGINE_H
+#define SCRIPTABLE_ENGINE_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+#include <QtQml/QJSValue>
+
+class QJSEngine;
+class QThread;
+
+class ScriptableEnginePool;
+class ScriptableNode;
+class ScriptableSafeString;
+
+namespace Grantlee
+{
+class Engine;
+class SafeString;
+class ScriptableTagLibrary;
+}
+
+using namespace Grantlee;
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+class ScriptableEngineMutex : public QMutex
+{
+public:
+  ScriptableEngineMutex() : QMutex(QMutex::Recursive) {}
+};
+#else
+typedef QRecursiveMutex ScriptableEngineMutex;
+#endif
+
+/**
+  A QJSEngine set up with the objects and functions which scripted tag
+  libraries use.
+
+  A QJSEngine may only run one script at a time, so it is locked with a
+  ScriptableEngineLocker while it is used.
+*/
+class ScriptableEngine
+{
+public:
+  ScriptableEngine(ScriptableEnginePool *pool, ScriptableTagLibrary *library,
+                   Engine *templateEngine);
+  ~ScriptableEngine();
+
+  QJSEngine *engine() const { return m_engine; }
+
+  ScriptableEnginePool *pool() const { return m_pool; }
+
+  QSharedPointer<ScriptableEngine> self() const { return m_self.toStrongRef(); }
+
+  Engine *templateEngine() const { return m_templateEngine.loadAcquire(); }
+
+  /**
+    Returns the global object @p name of the engine.
+  */
+  QJSValue global(const QString &name);
+
+  QJSValue evaluate(const QString &source);
+
+  /**
+    Returns @p content wrapped in a ScriptableSafeString for the argument
+    @p index of a filter call. The wrappers of the outermost filter call
+    are reused, so scripts must not keep them.
+  */
+  QJSValue filterArgument(int index, const SafeString &content);
+
+  /**
+    The script objects of a ScriptableNode in one engine.
+  */
+  struct NodeState {
+    QJSValue concreteNode;
+    QJSValue renderMethod;
+  };
+
+  /**
+    Returns the objects of @p node in the locked engine. They are undefined
+    if they were not created in it yet.
+  */
+  NodeState nodeState(const ScriptableNode *node);
+
+  /**
+    Sets the objects of @p node in the locked engine.
+  */
+  void setNodeState(const ScriptableNode *node, const NodeState &state);
+
+  /**
+    Discards the objects of the deleted @p node the next time the engine is
+    used. It may be called from any thread.
+  */
+  void releaseNode(const ScriptableNode *node);
+
+  /**
+    Returns the engine locked by the current thread, if any.
+  */
+  static ScriptableEngine *active();
+
+  /**
+    Returns the script engine locked by the current thread, or @p fallback
+    if there is none.
+  */
+  static QJSEngine *activeEngine(QJSEngine *fallback);
+
+private:
+  Q_DISABLE_COPY(ScriptableEngine)
+  friend class ScriptableEngineLocker;
+  friend class ScriptableEnginePool;
+  friend class ScriptableFilterCall;
+
+  void removeReleasedNodes();
+
+  ScriptableEnginePool *const m_pool;
+  QJSEngine *const m_engine;
+  QJSValue m_functions;
+  QHash<QString, QJSValue> m_globals;
+  ScriptableSafeString *m_arguments[2];
+  QJSValue m_argumentValues[2];
+  // The number of filter calls running in the engine.
+  int m_filterCalls;
+  QWeakPointer<ScriptableEngine> m_self;
+  QAtomicPointer<Engine> m_templateEngine;
+  ScriptableEngineMutex m_mutex;
+  // The number of scripts of the pool which the engine has evaluated.
+  int m_scripts;
+  QHash<const ScriptableNode *, NodeState> m_nodes;
+  // The deleted nodes whose objects are still in m_nodes. They are removed
+  // before m_nodes is used, so a new node at the same address does not find
+  // them.
+  QMutex m_releasedMutex;
+  QVector<const ScriptableNode *> m_releasedNodes;
+};
+
+/**
+  Locks a ScriptableEngine for the current thread.
+*/
+class ScriptableEngineLocker
+{
+public:
+  explicit ScriptableEngineLocker(ScriptableEngine *engine);
+  ~ScriptableEngineLocker();
+
+private:
+  Q_DISABLE_COPY(ScriptableEngineLocker)
+  ScriptableEngine *const m_engine;
+  ScriptableEngine *const m_previous;
+};
+
+/**
+  Marks a filter call running in a locked ScriptableEngine.
+*/
+class ScriptableFilterCall
+{
+public:
+  explicit ScriptableFilterCall(ScriptableEngine *engine) : m_engine(engine)
+  {
+    ++m_engine->m_filterCalls;
+  }
+  ~ScriptableFilterCall() { --m_engine->m_filterCalls; }
+
+private:
+  Q_DISABLE_COPY(ScriptableFilterCall)
+  ScriptableEngine *const m_engine;
+};
+
+/**
+  The script engines of a ScriptableTagLibrary, one for each thread which
+  uses the library.
+
+  The sources of scripts are read once. Engines which are created after a
+  script was loaded evaluate it again before they are used, so that the
+  tags and filters of all libraries are available in all of them.
+*/
+class ScriptableEnginePool : public QObject
+{
+  Q_OBJECT
+public:
+  explicit ScriptableEnginePool(ScriptableTagLibrary *library);
+  ~ScriptableEnginePool() override;
+
+  /**
+    Returns the engine of the current thread.
+  */
+  QSharedPointer<ScriptableEngine> engine();
+
+  /**
+    Returns the source of the script @p fileName, or a null string if it
+    can not be read.
+  */
+  QString source(const QString &fileName);
+
+  /**
+    Evaluates the script @p source in the locked @p engine and adds it to
+    the scripts of the pool.
+  */
+  QJSValue evaluate(ScriptableEngine *engine, const QString &source);
+
+  void setTemplateEngine(Engine *templateEngine);
+
+  /**
+    Discards the objects of the deleted @p node in those of the @p engines
+    which are still in the pool.
+  */
+  void releaseNode(const ScriptableNode *node,
+                   const QVector<ScriptableEngine *> &engines);
+
+private:
+  ScriptableTagLibrary *const m_library;
+  QMutex m_mutex;
+  QHash<QThread *, QSharedPointer<ScriptableEngine>> m_engines;
+  QVector<QString> m_scripts;
+  // The size of m_scripts, read without locking m_mutex.
+  QAtomicInt m_scriptCount;
+  // Identifies the pool in the engine cache of threads.
+  const int m_serial;
+  QHash<QString, QPair<QDateTime, QString>> m_sources;
+  Engine *m_templateEngine;
+};
+
+#endif
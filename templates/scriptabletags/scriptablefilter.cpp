@@ -19,6 +19,7 @@
 */
 
 #include "scriptablefilter.h"
+#include "scriptableengine.h"
 #include "scriptablesafestring.h"
 
 #include "util.h"
@@ -26,18 +27,29 @@
 #include <QtQml/QJSEngine>
 
 ScriptableFilter::ScriptableFilter(const QJSValue &filterObject,
-                                   QJSEngine *engine)
-    : m_filterObject(filterObject), m_scriptEngine(engine)
+                                   ScriptableEnginePool *engines,
+                                   const QString &name)
+    : m_engines(engines), m_name(name), m_isSafe(false), m_plainStrings(false)
 {
+  auto safety = filterObject.property(QStringLiteral("isSafe"));
+  if (safety.isBool()) {
+    m_isSafe = safety.toBool();
+  }
+  auto plainStrings = filterObject.property(QStringLiteral("plainStrings"));
+  if (plainStrings.isBool()) {
+    m_plainStrings = plainStrings.toBool();
+  }
 }
 
 ScriptableFilter::~ScriptableFilter() = default;
 
-bool ScriptableFilter::isSafe() const
+bool ScriptableFilter::isSafe() const { return m_isSafe; }
+
+static bool containsObjects(const QVariantList &list)
 {
-  auto safety = m_filterObject.property(QStringLiteral("isSafe"));
-  if (safety.isBool()) {
-    return safety.toBool();
+  for (const auto &item : list) {
+    if (item.canConvert<QObject *>())
+      return true;
   }
   return false;
 }
@@ -47,54 +59,75 @@ QVariant ScriptableFilter::doFilter(const QVariant &input,
                                     bool autoescape) const
 {
   Q_UNUSED(autoescape)
+
+  // A filter called by a script runs in the engine of the script. Other
+  // calls run in the engine of the current thread.
+  QSharedPointer<ScriptableEngine> ownEngine;
+  auto engine = ScriptableEngine::active();
+  if (!engine || !engine->global(m_name).isCallable()) {
+    ownEngine = m_engines->engine();
+    engine = ownEngine.data();
+  }
+  ScriptableEngineLocker locker(engine);
+  ScriptableFilterCall call(engine);
+  auto scriptEngine = engine->engine();
+
   QJSValueList args;
   if (input.userType() == qMetaTypeId<QVariantList>()) {
     auto inputList = input.value<QVariantList>();
-    auto array = m_scriptEngine->newArray(inputList.size());
-    for (auto i = 0; i < inputList.size(); ++i) {
-      if (inputList.at(i).canConvert<QObject *>()) {
-        array.setProperty(
-            i, m_scriptEngine->newQObject(inputList.at(i).value<QObject *>()));
-      } else {
-        array.setProperty(i, m_scriptEngine->toScriptValue(inputList.at(i)));
+    if (!containsObjects(inputList)) {
+      args << scriptEngine->toScriptValue(inputList);
+    } else {
+      auto array = scriptEngine->newArray(inputList.size());
+      for (auto i = 0; i < inputList.size(); ++i) {
+        if (inputList.at(i).canConvert<QObject *>()) {
+          array.setProperty(
+              i, scriptEngine->newQObject(inputList.at(i).value<QObject *>()));
+        } else {
+          array.setProperty(i, scriptEngine->toScriptValue(inputList.at(i)));
+        }
       }
+      args << array;
     }
-    args << array;
   } else {
     if (isSafeString(input)) {
-      auto ssObj = new ScriptableSafeString(m_scriptEngine);
-      ssObj->setContent(getSafeString(input));
-      args << m_scriptEngine->newQObject(ssObj);
+      if (m_plainStrings)
+        args << QJSValue(getSafeString(input).get());
+      else
+        args << engine->filterArgument(0, getSafeString(input));
     } else if (input.canConvert<QObject *>()) {
-      args << m_scriptEngine->newQObject(input.value<QObject *>());
+      args << scriptEngine->newQObject(input.value<QObject *>());
     } else {
-      args << m_scriptEngine->toScriptValue(input);
+      args << scriptEngine->toScriptValue(input);
     }
   }
 
   if (argument.userType() == qMetaTypeId<SafeString>()) {
-    auto ssObj = new ScriptableSafeString(m_scriptEngine);
-    ssObj->setContent(getSafeString(argument));
-    args << m_scriptEngine->newQObject(ssObj);
+    if (m_plainStrings)
+      args << QJSValue(getSafeString(argument).get());
+    else
+      args << engine->filterArgument(1, getSafeString(argument));
   } else {
-    args << m_scriptEngine->toScriptValue(argument);
+    args << scriptEngine->toScriptValue(argument);
   }
-  auto filterObject = m_filterObject;
+  if (m_plainStrings)
+    args << QJSValue(isSafeString(input) && getSafeString(input).isSafe());
+
+  auto filterObject = engine->global(m_name);
   auto returnValue = filterObject.call(args);
 
   if (returnValue.isString()) {
     return getSafeString(returnValue.toString());
   }
   if (returnValue.isQObject()) {
-    auto returnedObject = qjsvalue_cast<QObject *>(returnValue);
     auto returnedStringObject
-        = qobject_cast<ScriptableSafeString *>(returnedObject);
+        = qobject_cast<ScriptableSafeString *>(returnValue.toQObject());
     if (!returnedStringObject)
       return {};
     auto returnedString = returnedStringObject->wrappedString();
     return returnedString;
   } else if (returnValue.isVariant()) {
-    return qjsvalue_cast<QVariant>(returnValue);
+    return returnValue.toVariant();
   } else if (returnValue.isArray()) {
     return qjsvalue_cast<QVariantList>(returnValue);
   }
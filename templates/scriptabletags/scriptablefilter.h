@@ -25,12 +25,19 @@
 
 #include "filter.h"
 
+class ScriptableEnginePool;
+
 using namespace Grantlee;
 
 class ScriptableFilter : public Filter
 {
 public:
-  ScriptableFilter(const QJSValue &filterObject, QJSEngine *engine);
+  /**
+    Creates the filter for the global function @p name, which is
+    @p filterObject in the engine which loaded it.
+  */
+  ScriptableFilter(const QJSValue &filterObject, ScriptableEnginePool *engines,
+                   const QString &name);
   ~ScriptableFilter() override;
 
   QVariant doFilter(const QVariant &input, const QVariant &argument,
@@ -39,8 +46,11 @@ public:
   bool isSafe() const override;
 
 private:
-  QJSValue m_filterObject;
-  QJSEngine *m_scriptEngine;
+  ScriptableEnginePool *m_engines;
+  QString m_name;
+  bool m_isSafe;
+  // Whether strings are passed to the filter as JavaScript strings.
+  bool m_plainStrings;
 };
 
 #endif
@@ -23,6 +23,7 @@
 #include <QtQml/QJSEngine>
 
 #include "parser.h"
+#include "scriptableengine.h"
 #include "scriptablesafestring.h"
 #include "util.h"
 
@@ -50,9 +51,11 @@ QVariant ScriptableFilterExpression::resolve(ScriptableContext *c)
   auto var = m_filterExpression.resolve(c->context());
 
   if (Grantlee::isSafeString(var)) {
-    auto ssObj = new ScriptableSafeString(m_engine);
+    // The result belongs to the engine of the script which resolves it.
+    const auto engine = ScriptableEngine::activeEngine(m_engine);
+    auto ssObj = new ScriptableSafeString(engine);
     ssObj->setContent(getSafeString(var));
-    return m_engine->newQObject(ssObj).toVariant();
+    return engine->newQObject(ssObj).toVariant();
   }
   return var;
 }
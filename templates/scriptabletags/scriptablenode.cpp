@@ -27,71 +27,147 @@
 #include "exception.h"
 #include "parser.h"
 #include "scriptablecontext.h"
+#include "scriptableengine.h"
 #include "scriptableparser.h"
 
+static QJSValue nodeListValue(QJSEngine *engine,
+                              const QList<QObject *> &objectList)
+{
+  auto objectListArray = engine->newArray(objectList.size());
+
+  for (auto i = 0; i < objectList.size(); ++i) {
+    objectListArray.setProperty(i, engine->newQObject(objectList.at(i)));
+  }
+  return objectListArray;
+}
+
 ScriptableNode::ScriptableNode(QObject *parent)
-    : Node(parent), m_scriptEngine(nullptr)
+    : Node(parent), m_engines(nullptr)
+{
+}
+
+ScriptableNode::~ScriptableNode()
+{
+  if (m_engines)
+    m_engines->releaseNode(this, m_stateEngines);
+}
+
+void ScriptableNode::init(ScriptableEngine *engine,
+                          const QJSValue &concreteNode,
+                          const QJSValueList &arguments)
 {
+  m_engines = engine->pool();
+  for (const auto &argument : arguments) {
+    m_arguments.append(argument.toVariant());
+    adopt(m_arguments.last(), engine->engine());
+  }
+
+  engine->setNodeState(
+      this, {concreteNode, concreteNode.property(QStringLiteral("render"))});
+  m_stateEngines.append(engine);
 }
 
-void ScriptableNode::setScriptEngine(QJSEngine *engine)
+void ScriptableNode::adopt(const QVariant &argument, QJSEngine *engine)
 {
-  m_scriptEngine = engine;
+  // Objects created by the script for the node are used by the engines of
+  // other threads too, so they are deleted with the node instead of the
+  // engine which created them.
+  if (argument.userType() == QMetaType::QVariantList) {
+    for (const auto &item : argument.toList())
+      adopt(item, engine);
+    return;
+  }
+  const auto object = argument.value<QObject *>();
+  if (!object || (object->parent() && object->parent() != engine))
+    return;
+  object->setParent(this);
+  QJSEngine::setObjectOwnership(object, QJSEngine::CppOwnership);
 }
 
-void ScriptableNode::init(const QJSValue &concreteNode,
-                          const QJSValue &renderMethod)
+ScriptableEngine::NodeState
+ScriptableNode::state(ScriptableEngine *engine) const
 {
-  m_concreteNode = concreteNode;
-  m_renderMethod = renderMethod;
+  auto state = engine->nodeState(this);
+  if (!state.concreteNode.isUndefined())
+    return state;
+
+  auto scriptEngine = engine->engine();
+
+  QJSValueList args;
+  for (const auto &argument : m_arguments)
+    args << scriptEngine->toScriptValue(argument);
+
+  state.concreteNode
+      = engine->global(objectName()).callAsConstructor(args);
+  for (const auto &nodeList : m_nodeLists)
+    state.concreteNode.setProperty(
+        nodeList.first, nodeListValue(scriptEngine, nodeList.second));
+  state.renderMethod
+      = state.concreteNode.property(QStringLiteral("render"));
+
+  engine->setNodeState(this, state);
+  QMutexLocker locker(&m_mutex);
+  m_stateEngines.append(engine);
+  return state;
 }
 
 void ScriptableNode::render(OutputStream *stream, Context *c) const
 {
+  // The node is rendered in the engine of the current thread.
+  const auto engine = m_engines->engine();
+  ScriptableEngineLocker locker(engine.data());
+  auto state = this->state(engine.data());
+
   ScriptableContext sc(c);
-  auto contextObject = m_scriptEngine->newQObject(&sc);
+  auto contextObject = engine->engine()->newQObject(&sc);
 
   QJSValueList args;
   args << contextObject;
 
   // Call the render method in the context of the concreteNode
-  auto value = const_cast<QJSValue &>(m_renderMethod)
-                   .callWithInstance(m_concreteNode, args);
+  auto value = state.renderMethod.callWithInstance(state.concreteNode, args);
 
   if (!value.isError() && !value.isUndefined())
     (*stream) << value.toString();
 }
 
 ScriptableNodeFactory::ScriptableNodeFactory(QObject *parent)
-    : AbstractNodeFactory(parent), m_scriptEngine(nullptr)
+    : AbstractNodeFactory(parent), m_engines(nullptr)
 {
 }
 
-void ScriptableNodeFactory::setScriptEngine(QJSEngine *engine)
+void ScriptableNodeFactory::setScriptEngines(ScriptableEnginePool *engines)
 {
-  m_scriptEngine = engine;
+  m_engines = engines;
 }
 
 void ScriptableNodeFactory::setEngine(Engine *engine)
 {
-  m_scriptEngine->setProperty("templateEngine", QVariant::fromValue(engine));
+  if (m_engines)
+    m_engines->setTemplateEngine(engine);
 }
 
-void ScriptableNodeFactory::setFactory(const QJSValue &factoryMethod)
+void ScriptableNodeFactory::setFactory(const QString &factoryName)
 {
-  m_factoryMethod = factoryMethod;
+  m_factoryName = factoryName;
 }
 
 Node *ScriptableNodeFactory::getNode(const QString &tagContent, Parser *p) const
 {
-  auto sp = new ScriptableParser(p, m_scriptEngine);
-  auto parserObject = m_scriptEngine->newQObject(sp);
+  // Nodes are created by the engine of the thread which parses the
+  // template.
+  auto engine = m_engines->engine();
+  ScriptableEngineLocker locker(engine.data());
+  auto scriptEngine = engine->engine();
+
+  auto sp = new ScriptableParser(p, scriptEngine);
+  auto parserObject = scriptEngine->newQObject(sp);
 
   QJSValueList args;
   args << tagContent;
   args << parserObject;
 
-  auto factory = m_factoryMethod;
+  auto factory = engine->global(m_factoryName);
 
   auto scriptNode = factory.callWithInstance(factory, args);
   if (scriptNode.isError())
@@ -102,16 +178,17 @@ Node *ScriptableNodeFactory::getNode(const QString &tagContent, Parser *p) const
   return node;
 }
 
-QJSEngine *ScriptableNode::engine() { return m_scriptEngine; }
-
 void ScriptableNode::setNodeList(const QString &name,
                                  const QList<QObject *> &objectList)
 {
-  auto objectListArray = m_scriptEngine->newArray(objectList.size());
-
-  for (auto i = 0; i < objectList.size(); ++i) {
-    objectListArray.setProperty(i,
-                                m_scriptEngine->newQObject(objectList.at(i)));
-  }
-  m_concreteNode.setProperty(name, objectListArray);
+  m_nodeLists.append(qMakePair(name, objectList));
+
+  // The node lists are set while the node is created by a script.
+  const auto engine = ScriptableEngine::active();
+  if (!engine)
+    return;
+  auto state = engine->nodeState(this);
+  if (!state.concreteNode.isUndefined())
+    state.concreteNode.setProperty(
+        name, nodeListValue(engine->engine(), objectList));
 }
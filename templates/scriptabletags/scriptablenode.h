@@ -21,9 +21,13 @@
 #ifndef SCRIPTABLE_NODE_H
 #define SCRIPTABLE_NODE_H
 
+#include <QtCore/QMutex>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
 #include <QtQml/QJSValue>
 
 #include "node.h"
+#include "scriptableengine.h"
 
 class QJSEngine;
 
@@ -35,22 +39,40 @@ class Engine;
 
 using namespace Grantlee;
 
+/**
+  A node of a scripted tag.
+
+  The script objects of the node are created in the engine of each thread
+  which renders it, from the arguments it was constructed with and its node
+  lists. Properties which the factory function sets on the node in other
+  ways are only available in the engine which parsed it.
+*/
 class ScriptableNode : public Node
 {
   Q_OBJECT
 public:
   ScriptableNode(QObject *parent = {});
-  void setScriptEngine(QJSEngine *engine);
-  void init(const QJSValue &concreteNode, const QJSValue &renderMethod);
+  ~ScriptableNode() override;
 
-  QJSEngine *engine();
+  /**
+    Initializes the node with the @p concreteNode which was constructed in
+    the locked @p engine with the @p arguments.
+  */
+  void init(ScriptableEngine *engine, const QJSValue &concreteNode,
+            const QJSValueList &arguments);
 
   void render(OutputStream *stream, Context *c) const override;
 
 private:
-  QJSEngine *m_scriptEngine;
-  QJSValue m_concreteNode;
-  QJSValue m_renderMethod;
+  ScriptableEngine::NodeState state(ScriptableEngine *engine) const;
+  void adopt(const QVariant &argument, QJSEngine *engine);
+
+  ScriptableEnginePool *m_engines;
+  QVariantList m_arguments;
+  QVector<QPair<QString, QList<QObject *>>> m_nodeLists;
+  mutable QMutex m_mutex;
+  // The engines which have objects of the node.
+  mutable QVector<ScriptableEngine *> m_stateEngines;
 
 public Q_SLOTS:
   void setNodeList(const QString &name, const QList<QObject *> &);
@@ -61,16 +83,20 @@ class ScriptableNodeFactory : public AbstractNodeFactory
   Q_OBJECT
 public:
   ScriptableNodeFactory(QObject *parent = {});
-  void setScriptEngine(QJSEngine *engine);
+  void setScriptEngines(ScriptableEnginePool *engines);
 
   void setEngine(Grantlee::Engine *engine) override;
-  void setFactory(const QJSValue &factoryMethod);
+
+  /**
+    Sets the name of the global factory function of the scripts.
+  */
+  void setFactory(const QString &factoryName);
 
   Node *getNode(const QString &tagContent, Parser *p = {}) const override;
 
 private:
-  QJSEngine *m_scriptEngine;
-  QJSValue m_factoryMethod;
+  ScriptableEnginePool *m_engines;
+  QString m_factoryName;
 };
 
 #endif
@@ -20,7 +20,7 @@
 
 #include "scriptabletags.h"
 
-#include <QtCore/QFile>
+#include <QtCore/QThread>
 #include <QtPlugin>
 
 #include <QtQml/QJSEngine>
@@ -31,6 +31,7 @@
 #include "engine.h"
 #include "exception.h"
 #include "parser.h"
+#include "scriptableengine.h"
 #include "scriptablefilter.h"
 #include "scriptablefilterexpression.h"
 #include "scriptablenode.h"
@@ -45,6 +46,11 @@ Q_DECLARE_METATYPE(Token)
 
 using namespace Grantlee;
 
+ScriptableHelperFunctions::ScriptableHelperFunctions(ScriptableEngine *engine)
+    : m_engine(engine), m_scriptEngine(engine->engine())
+{
+}
+
 QJSValue ScriptableHelperFunctions::markSafeFunction(QJSValue inputValue)
 {
   if (inputValue.isQObject()) {
@@ -92,20 +98,16 @@ ScriptableHelperFunctions::ScriptableNodeConstructor(QJSValue callContext)
 
   concreteNode = concreteNode.callAsConstructor(args);
 
-  auto renderMethod = concreteNode.property(QStringLiteral("render"));
-
   auto object = new ScriptableNode(m_scriptEngine);
   object->setObjectName(scriptableNodeName);
-  object->setScriptEngine(m_scriptEngine);
-  object->init(concreteNode, renderMethod);
+  object->init(m_engine, concreteNode, args);
   return m_scriptEngine->newQObject(object);
 }
 
 QJSValue ScriptableHelperFunctions::ScriptableTemplateConstructor(
     QString content, QString name, QObject *parent)
 {
-  auto templateEngine
-      = m_scriptEngine->property("templateEngine").value<Engine *>();
+  auto templateEngine = m_engine->templateEngine();
 
   if (!templateEngine)
     return {};
@@ -130,76 +132,23 @@ QJSValue ScriptableHelperFunctions::ScriptableVariableConstructor(QString name)
 }
 
 ScriptableTagLibrary::ScriptableTagLibrary(QObject *parent)
-    : QObject(parent), m_scriptEngine(new QJSEngine(this)),
-      m_functions(m_scriptEngine->newQObject(
-          new ScriptableHelperFunctions(m_scriptEngine)))
+    : QObject(parent), m_engines(new ScriptableEnginePool(this)),
+      m_loadingThread(nullptr)
 {
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("internalGrantleeFunctions"), m_functions);
-
-  // Make Node new-able
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("Node"),
-      m_scriptEngine->evaluate(QStringLiteral(R"javascript(
-            (function() {
-              return internalGrantleeFunctions.ScriptableNodeConstructor(
-                Array.prototype.slice.call(arguments));
-            })
-          )javascript")));
-
-  // Make Variable new-able
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("Variable"),
-      m_functions.property(QStringLiteral("ScriptableVariableConstructor")));
-
-  // Make FilterExpression new-able
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("FilterExpression"),
-      m_functions.property(
-          QStringLiteral("ScriptableFilterExpressionConstructor")));
-
-  // Make Template new-able
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("Template"),
-      m_functions.property(QStringLiteral("ScriptableTemplateConstructor")));
-
-  // Create a global Library object
-  auto libraryObject = m_scriptEngine->newQObject(this);
-  m_scriptEngine->globalObject().setProperty(QStringLiteral("Library"),
-                                             libraryObject);
-
-  // Create a global AbstractNodeFactory object to make smartSplit available.
-  auto nodeFactory = new ScriptableNodeFactory(this);
-  auto nodeFactoryObject = m_scriptEngine->newQObject(nodeFactory);
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("AbstractNodeFactory"), nodeFactoryObject);
-
-  // Make mark_safe a globally available object.
-  m_scriptEngine->globalObject().setProperty(
-      QStringLiteral("mark_safe"),
-      m_functions.property(QStringLiteral("markSafeFunction")));
 }
 
 bool ScriptableTagLibrary::evaluateScript(const QString &name)
 {
-  QFile scriptFile(name);
-
-  if (!scriptFile.exists()
-      || !scriptFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+  const auto fileContent = m_engines->source(name);
+  if (fileContent.isNull())
     return false;
-  }
 
-  QTextStream fstream(&scriptFile);
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-  fstream.setCodec("UTF-8");
-#else
-  fstream.setEncoding(QStringConverter::Utf8);
-#endif
-  const auto fileContent = fstream.readAll();
+  auto engine = m_engines->engine();
+  ScriptableEngineLocker locker(engine.data());
 
-  scriptFile.close();
-
-  QJSValue result = m_scriptEngine->evaluate(fileContent);
+  m_loadingThread.storeRelease(QThread::currentThread());
+  QJSValue result = m_engines->evaluate(engine.data(), fileContent);
+  m_loadingThread.storeRelease(nullptr);
   if (result.isError())
     throw Grantlee::Exception(TagSyntaxError, result.toString());
 
@@ -209,6 +158,7 @@ bool ScriptableTagLibrary::evaluateScript(const QString &name)
 QHash<QString, AbstractNodeFactory *>
 ScriptableTagLibrary::nodeFactories(const QString &name)
 {
+  QMutexLocker locker(&m_mutex);
   m_factoryNames.clear();
   m_nodeFactories.clear();
   QHash<QString, AbstractNodeFactory *> h;
@@ -222,6 +172,7 @@ ScriptableTagLibrary::nodeFactories(const QString &name)
 
 QHash<QString, Filter *> ScriptableTagLibrary::filters(const QString &name)
 {
+  QMutexLocker locker(&m_mutex);
   m_filterNames.clear();
   m_filters.clear();
   QHash<QString, Filter *> filters;
@@ -241,11 +192,9 @@ QHash<QString, AbstractNodeFactory *> ScriptableTagLibrary::getFactories()
     auto factoryName = it.value();
     auto tagName = it.key();
 
-    auto factoryObject = m_scriptEngine->globalObject().property(factoryName);
-
     auto snf = new ScriptableNodeFactory();
-    snf->setScriptEngine(m_scriptEngine);
-    snf->setFactory(factoryObject);
+    snf->setScriptEngines(m_engines);
+    snf->setFactory(factoryName);
 
     factories.insert(tagName, snf);
   }
@@ -257,12 +206,14 @@ QHash<QString, Filter *> ScriptableTagLibrary::getFilters()
 {
   QHash<QString, Filter *> filters;
 
+  auto engine = m_engines->engine();
+  ScriptableEngineLocker locker(engine.data());
   for (auto &filterNameString : m_filterNames) {
-    auto filterObject
-        = m_scriptEngine->globalObject().property(filterNameString);
+    auto filterObject = engine->global(filterNameString);
     auto filterName
         = filterObject.property(QStringLiteral("filterName")).toString();
-    auto filter = new ScriptableFilter(filterObject, m_scriptEngine);
+    auto filter = new ScriptableFilter(filterObject, m_engines,
+                                       filterNameString);
     filters.insert(filterName, filter);
   }
 
@@ -272,10 +223,14 @@ QHash<QString, Filter *> ScriptableTagLibrary::getFilters()
 void ScriptableTagLibrary::addFactory(const QString &factoryName,
                                       const QString &tagName)
 {
+  if (m_loadingThread.loadAcquire() != QThread::currentThread())
+    return;
   m_factoryNames.insert(tagName, factoryName);
 }
 
 void ScriptableTagLibrary::addFilter(const QString &filterName)
 {
+  if (m_loadingThread.loadAcquire() != QThread::currentThread())
+    return;
   m_filterNames << filterName;
 }
@@ -24,9 +24,14 @@
 #include "node.h"
 #include "taglibraryinterface.h"
 
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QMutex>
 #include <QtQml/QJSValue>
 
 class QJSEngine;
+class QThread;
+class ScriptableEngine;
+class ScriptableEnginePool;
 
 namespace Grantlee
 {
@@ -36,13 +41,11 @@ class Parser;
 class ScriptableHelperFunctions : public QObject
 {
   Q_OBJECT
+  ScriptableEngine *m_engine;
   QJSEngine *m_scriptEngine;
 
 public:
-  ScriptableHelperFunctions(QJSEngine *scriptEngine)
-      : m_scriptEngine(scriptEngine)
-  {
-  }
+  ScriptableHelperFunctions(ScriptableEngine *engine);
 
   Q_INVOKABLE QJSValue markSafeFunction(QJSValue inputValue);
   Q_INVOKABLE QJSValue ScriptableFilterExpressionConstructor(QString name,
@@ -78,8 +81,12 @@ protected:
   QHash<QString, Filter *> getFilters();
 
 private:
-  QJSEngine *m_scriptEngine;
-  QJSValue m_functions;
+  ScriptableEnginePool *m_engines;
+  // Serializes loading libraries. Only the thread which loads a library
+  // registers its tags and filters, not the engines which evaluate the
+  // script again.
+  QMutex m_mutex;
+  QAtomicPointer<QThread> m_loadingThread;
   QHash<QString, AbstractNodeFactory *> m_nodeFactories;
   QHash<QString, QString> m_factoryNames;
   QStringList m_filterNames;
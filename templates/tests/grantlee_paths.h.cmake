@@ -1,2 +1,3 @@
 #define GRANTLEE_PLUGIN_PATH "@GRANTLEE_PLUGIN_PATH@"
 #define GRANTLEE_TEMPLATE_PATH "@CMAKE_CURRENT_SOURCE_DIR@/themes"
+#define GRANTLEE_COMPILED_TEMPLATE_PATH "@CMAKE_CURRENT_SOURCE_DIR@/compiled"
@@ -21,8 +21,14 @@
 #ifndef BUILTINSTEST_H
 #define BUILTINSTEST_H
 
+#include <QtCore/QBuffer>
 #include <QtCore/QDebug>
+#include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QPluginLoader>
+#include <QtCore/QTemporaryDir>
 #include <QtTest/QTest>
 
 #include "cachingloaderdecorator.h"
@@ -31,8 +37,14 @@
 #include "engine.h"
 #include "filterexpression.h"
 #include "grantlee_paths.h"
+#include "grantlee_version.h"
+#include "lazyvalue.h"
+#include "renderprofiler.h"
+#include "taglibraryinterface.h"
 #include "template.h"
+#include "tracer.h"
 #include "util.h"
+#include <lookupkey_p.h>
 #include <metaenumvariable_p.h>
 
 using Dict = QHash<QString, QVariant>;
@@ -230,6 +242,13 @@ private Q_SLOTS:
   void testMultipleStates();
   void testAlternativeEscaping();
 
+  void testLazyValues();
+  void testPluginCache();
+  void testPluginDeclarations_data();
+  void testPluginDeclarations();
+  void testRenderProfiler();
+  void testLookupKeyAtoms();
+
   void testTemplatePathSafety_data();
   void testTemplatePathSafety();
 
@@ -1464,6 +1483,272 @@ void TestBuiltinSyntax::testMultipleStates()
   QCOMPARE(t3->render(&c), expected3);
 }
 
+void TestBuiltinSyntax::testLazyValues()
+{
+  auto engine = getEngine();
+
+  auto calls = 0;
+  auto t = engine->newTemplate(
+      QStringLiteral("{% if show %}{{ var }},{{ var }},{{ hash.nested }}"
+                     "{% endif %}"),
+      QStringLiteral("lazy"));
+
+  Context c;
+  c.insert(QStringLiteral("show"), false);
+  c.insert(QStringLiteral("var"), LazyValue([&calls] {
+             ++calls;
+             return QVariant(QStringLiteral("this & that"));
+           }));
+  QVariantHash hash;
+  hash.insert(QStringLiteral("nested"),
+              QVariant::fromValue(LazyValue([&calls] {
+                ++calls;
+                return QVariant(42);
+              })));
+  c.insert(QStringLiteral("hash"), hash);
+
+  QCOMPARE(t->render(&c), QString());
+  QCOMPARE(calls, 0);
+
+  c.insert(QStringLiteral("show"), true);
+  QCOMPARE(t->render(&c), QStringLiteral("this &amp; that,this &amp; that,42"));
+  QCOMPARE(calls, 2);
+
+  QCOMPARE(t->render(&c), QStringLiteral("this &amp; that,this &amp; that,42"));
+  QCOMPARE(calls, 2);
+
+  QVERIFY(!LazyValue().isValid());
+  QVERIFY(!LazyValue().value().isValid());
+}
+
+void TestBuiltinSyntax::testPluginCache()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const auto cacheFile = dir.filePath(QStringLiteral("plugins.json"));
+
+  const auto content = QStringLiteral(
+      "{% for item in list %}{{ item|upper }}{% endfor %}{{ list|length }}");
+  QVariantHash h;
+  h.insert(QStringLiteral("list"),
+           QVariantList{QStringLiteral("a"), QStringLiteral("b")});
+  Context c(h);
+
+  {
+    Engine engine;
+    engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+    engine.setPluginCacheFile(cacheFile);
+    QCOMPARE(engine.pluginCacheFile(), cacheFile);
+
+    auto t = engine.newTemplate(content, QStringLiteral("cache1"));
+    QCOMPARE(t->render(&c), QStringLiteral("AB2"));
+  }
+  QVERIFY(QFileInfo::exists(cacheFile));
+
+  // A second engine uses the index from the cache file, and loads a library
+  // only when one of its tags or filters is used.
+  QBuffer buffer;
+  QVERIFY(buffer.open(QIODevice::WriteOnly));
+  Tracer tracer(&buffer);
+
+  Engine engine;
+  engine.setTracer(&tracer);
+  engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  engine.setPluginCacheFile(cacheFile);
+
+  auto t = engine.newTemplate(QStringLiteral("{{ list }}"),
+                              QStringLiteral("cache2"));
+  QCOMPARE(t->error(), NoError);
+  tracer.flush();
+  QVERIFY(!buffer.data().contains("grantlee_defaulttags"));
+  QVERIFY(!buffer.data().contains("grantlee_defaultfilters"));
+
+  t = engine.newTemplate(QStringLiteral("{{ list|length }}"),
+                         QStringLiteral("cache2"));
+  QCOMPARE(t->render(&c), QStringLiteral("2"));
+  tracer.flush();
+  QVERIFY(!buffer.data().contains("grantlee_defaulttags"));
+  QVERIFY(buffer.data().contains("grantlee_defaultfilters"));
+
+  t = engine.newTemplate(content, QStringLiteral("cache2"));
+  QCOMPARE(t->render(&c), QStringLiteral("AB2"));
+  tracer.flush();
+  QVERIFY(buffer.data().contains("grantlee_defaulttags"));
+
+  t = engine.newTemplate(QStringLiteral("{% nosuchtag %}"),
+                         QStringLiteral("cache3"));
+  QCOMPARE(t->error(), InvalidBlockTagError);
+
+  t = engine.newTemplate(QStringLiteral("{{ list|nosuchfilter }}"),
+                         QStringLiteral("cache4"));
+  QCOMPARE(t->error(), UnknownFilterError);
+}
+
+static QStringList sortedStrings(const QJsonValue &value)
+{
+  QStringList result;
+  const auto array = value.toArray();
+  for (const auto &item : array)
+    result.append(item.toString());
+  result.sort();
+  return result;
+}
+
+static QJsonObject pluginMetaData(const QString &name)
+{
+  const auto plugins = QPluginLoader::staticPlugins();
+  for (const auto &plugin : plugins) {
+    const auto metaData
+        = plugin.metaData().value(QStringLiteral("MetaData")).toObject();
+    if (metaData.value(QStringLiteral("name")).toString() == name)
+      return metaData;
+  }
+
+  const QDir dir(QStringLiteral(GRANTLEE_PLUGIN_PATH "/grantlee/")
+                 + QString::number(GRANTLEE_VERSION_MAJOR) + QLatin1Char('.')
+                 + QString::number(GRANTLEE_VERSION_MINOR));
+  const auto files
+      = dir.entryList({name + QLatin1Char('*')}, QDir::Files, QDir::Name);
+  for (const auto &file : files) {
+    QPluginLoader loader(dir.absoluteFilePath(file));
+    const auto metaData
+        = loader.metaData().value(QStringLiteral("MetaData")).toObject();
+    if (!metaData.isEmpty())
+      return metaData;
+  }
+  return {};
+}
+
+void TestBuiltinSyntax::testPluginDeclarations_data()
+{
+  QTest::addColumn<QString>("name");
+
+  QTest::newRow("defaulttags") << QStringLiteral("grantlee_defaulttags");
+  QTest::newRow("defaultfilters") << QStringLiteral("grantlee_defaultfilters");
+  QTest::newRow("loadertags") << QStringLiteral("grantlee_loadertags");
+  QTest::newRow("i18ntags") << QStringLiteral("grantlee_i18ntags");
+}
+
+void TestBuiltinSyntax::testPluginDeclarations()
+{
+  QFETCH(QString, name);
+
+  // The tags and filters declared in the metadata of a library are those
+  // it provides, so that deferring the library does not change parsing.
+  const auto metaData = pluginMetaData(name);
+  QVERIFY(!metaData.isEmpty());
+  QCOMPARE(metaData.value(QStringLiteral("name")).toString(), name);
+
+  Engine engine;
+  engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  const auto library = engine.loadLibrary(name);
+  QVERIFY(library);
+
+  const auto nodeFactories = library->nodeFactories();
+  auto tags = nodeFactories.keys();
+  tags.sort();
+  QCOMPARE(tags, sortedStrings(metaData.value(QStringLiteral("tags"))));
+  qDeleteAll(nodeFactories);
+
+  const auto filters = library->filters();
+  auto filterNames = filters.keys();
+  filterNames.sort();
+  QCOMPARE(filterNames,
+           sortedStrings(metaData.value(QStringLiteral("filters"))));
+  qDeleteAll(filters);
+}
+
+void TestBuiltinSyntax::testLookupKeyAtoms()
+{
+  const auto key = LookupKey::intern(QStringLiteral("objectName"));
+  const auto other = LookupKey::intern(QStringLiteral("objectName"));
+  QVERIFY(key.atom >= 0);
+  QCOMPARE(other.atom, key.atom);
+  QCOMPARE(other.utf8Name.constData(), key.utf8Name.constData());
+  QCOMPARE(other.name.constData(), key.name.constData());
+  QCOMPARE(LookupKey(QStringLiteral("objectName")).atom, -1);
+
+  const auto title = LookupKey::intern(QStringLiteral("title"));
+  QVariantHash hash;
+  hash.insert(QStringLiteral("title"), QStringLiteral("Grantlee"));
+  QCOMPARE(title.lookup(hash).toString(), QStringLiteral("Grantlee"));
+  QVariantMap map;
+  map.insert(QStringLiteral("title"), QStringLiteral("Map"));
+  QCOMPARE(title.lookup(map).toString(), QStringLiteral("Map"));
+
+  // The property index is cached for the class of the object.
+  QObject object;
+  object.setObjectName(QStringLiteral("name"));
+  const auto parentKey = LookupKey::intern(QStringLiteral("parent"));
+  QCOMPARE(parentKey.propertyIndex(object.metaObject()), -1);
+  const auto nameKey = LookupKey::intern(QStringLiteral("objectName"));
+  QCOMPARE(nameKey.propertyIndex(object.metaObject()),
+           object.metaObject()->indexOfProperty("objectName"));
+  QCOMPARE(nameKey.propertyIndex(object.metaObject()),
+           object.metaObject()->indexOfProperty("objectName"));
+}
+
+void TestBuiltinSyntax::testRenderProfiler()
+{
+  auto engine = getEngine();
+
+  auto t = engine->newTemplate(
+      QStringLiteral("{% for item in list %}\n{{ item|upper }}\n{% endfor %}"),
+      QStringLiteral("profiled"));
+
+  QVariantHash h;
+  h.insert(QStringLiteral("list"),
+           QVariantList{QStringLiteral("a"), QStringLiteral("b")});
+  Context c(h);
+  QVERIFY(!c.renderProfiler());
+
+  RenderProfiler profiler;
+  c.setRenderProfiler(&profiler);
+  QCOMPARE(c.renderProfiler(), &profiler);
+
+  QCOMPARE(t->render(&c), QStringLiteral("\nA\n\nB\n"));
+
+  QHash<QString, RenderProfiler::Entry> entries;
+  for (const auto &entry : profiler.entries()) {
+    QCOMPARE(entry.templateName, QStringLiteral("profiled"));
+    QVERIFY(entry.inclusiveTime >= entry.exclusiveTime);
+    entries.insert(entry.nodeType, entry);
+  }
+  QCOMPARE(entries.size(), 4);
+  QCOMPARE(entries.value(QStringLiteral("Template")).calls, 1);
+  QCOMPARE(entries.value(QStringLiteral("ForNode")).calls, 1);
+  QCOMPARE(entries.value(QStringLiteral("ForNode")).line, 1);
+  QCOMPARE(entries.value(QStringLiteral("VariableNode")).calls, 2);
+  QCOMPARE(entries.value(QStringLiteral("VariableNode")).line, 2);
+  QCOMPARE(entries.value(QStringLiteral("|upper")).calls, 2);
+  QCOMPARE(entries.value(QStringLiteral("|upper")).line, 2);
+
+  const auto stacks = profiler.collapsedStacks();
+  QVERIFY(stacks.contains(
+      QStringLiteral("profiled;profiled:1 ForNode;profiled:2 VariableNode;"
+                     "profiled:2 VariableNode |upper ")));
+
+  // The frames of a template do not depend on the addresses of its nodes,
+  // so those of a template parsed again are recorded in the same frames.
+  t = engine->newTemplate(
+      QStringLiteral("{% for item in list %}\n{{ item|upper }}\n{% endfor %}"),
+      QStringLiteral("profiled"));
+  QCOMPARE(t->render(&c), QStringLiteral("\nA\n\nB\n"));
+  QCOMPARE(profiler.entries().size(), 4);
+  for (const auto &entry : profiler.entries()) {
+    if (entry.nodeType == QLatin1String("VariableNode"))
+      QCOMPARE(entry.calls, 4);
+  }
+
+  profiler.clear();
+  QVERIFY(profiler.entries().isEmpty());
+  QVERIFY(profiler.collapsedStacks().isEmpty());
+
+  c.setRenderProfiler(nullptr);
+  QCOMPARE(t->render(&c), QStringLiteral("\nA\n\nB\n"));
+  QVERIFY(profiler.entries().isEmpty());
+}
+
 void TestBuiltinSyntax::testAlternativeEscaping()
 {
   auto engine1 = getEngine();
@@ -26,6 +26,7 @@
 #include "context.h"
 #include "coverageobject.h"
 #include "engine.h"
+#include "enginemetrics.h"
 #include "filterexpression.h"
 #include "grantlee_paths.h"
 #include "template.h"
@@ -43,6 +44,8 @@ class TestCachingLoader : public CoverageObject
 
 private Q_SLOTS:
   void testRenderAfterError();
+  void testMetrics();
+  void testMemoryBudget();
 };
 
 void TestCachingLoader::testRenderAfterError()
@@ -75,5 +78,146 @@ void TestCachingLoader::testRenderAfterError()
   QCOMPARE(t->error(), NoError);
 }
 
+void TestCachingLoader::testMetrics()
+{
+  Engine engine;
+  engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+
+  QSharedPointer<InMemoryTemplateLoader> loader(new InMemoryTemplateLoader);
+  loader->setTemplate(QStringLiteral("template1"),
+                      QStringLiteral("This template has an error {{ va>r }}"));
+  loader->setTemplate(QStringLiteral("template2"), QStringLiteral("Ok"));
+  loader->setTemplate(QStringLiteral("main"),
+                      QStringLiteral("{% include template_var %}"));
+
+  QSharedPointer<Grantlee::CachingLoaderDecorator> cache(
+      new Grantlee::CachingLoaderDecorator(loader));
+
+  engine.addTemplateLoader(cache);
+
+  QStringList rendered;
+  QList<Error> errors;
+  engine.setMetricsCallback([&rendered, &errors](const QString &name,
+                                                 qint64 renderTime,
+                                                 Error error) {
+    QVERIFY(renderTime >= 0);
+    rendered << name;
+    errors << error;
+  });
+
+  Context c;
+  auto t = engine.loadByName(QStringLiteral("main"));
+
+  c.insert(QStringLiteral("template_var"), QLatin1String("template2"));
+  QCOMPARE(t->render(&c), QLatin1String("Ok"));
+  QCOMPARE(t->render(&c), QLatin1String("Ok"));
+
+  c.insert(QStringLiteral("template_var"), QLatin1String("template1"));
+  QCOMPARE(t->render(&c), QString());
+
+  QCOMPARE(rendered,
+           QStringList({QStringLiteral("template2"), QStringLiteral("main"),
+                        QStringLiteral("template2"), QStringLiteral("main"),
+                        QStringLiteral("main")}));
+  QCOMPARE(errors,
+           QList<Error>({NoError, NoError, NoError, NoError, TagSyntaxError}));
+
+  const auto metrics = engine.metrics();
+  QCOMPARE(metrics.compileTimes.count, qint64(3));
+  QCOMPARE(metrics.compileTimes.buckets.size(),
+           metrics.compileTimes.bounds.size() + 1);
+
+  QCOMPARE(metrics.renderTimes.size(), 2);
+  const auto mainTimes = metrics.renderTimes.value(QStringLiteral("main"));
+  QCOMPARE(mainTimes.count, qint64(3));
+  qint64 bucketed = 0;
+  for (auto count : mainTimes.buckets)
+    bucketed += count;
+  QCOMPARE(bucketed, qint64(3));
+  QCOMPARE(metrics.renderTimes.value(QStringLiteral("template2")).count,
+           qint64(2));
+
+  QCOMPARE(metrics.renderErrors.size(), 1);
+  QCOMPARE(metrics.renderErrors.value(TagSyntaxError), qint64(1));
+
+  QCOMPARE(metrics.loaders.size(), 1);
+  const auto loaderMetrics = metrics.loaders.first();
+  QCOMPARE(loaderMetrics.loader, cache.staticCast<AbstractTemplateLoader>());
+  QCOMPARE(loaderMetrics.hits, qint64(4));
+  QCOMPARE(loaderMetrics.misses, qint64(0));
+  QCOMPARE(loaderMetrics.cacheHits, qint64(1));
+  QCOMPARE(loaderMetrics.cacheMisses, qint64(3));
+  QCOMPARE(loaderMetrics.evictions, qint64(0));
+
+  cache->clear();
+  QCOMPARE(engine.metrics().loaders.first().evictions, qint64(3));
+
+  engine.loadByName(QStringLiteral("missing"));
+  QCOMPARE(engine.metrics().loaders.first().misses, qint64(1));
+
+  // Render times are recorded for a bounded number of names. Further names
+  // are recorded under the empty name.
+  Engine generatedEngine;
+  for (auto i = 0; i < 1100; ++i) {
+    auto generated = generatedEngine.newTemplate(
+        QStringLiteral("Ok"), QStringLiteral("generated%1").arg(i));
+    QCOMPARE(generated->render(&c), QLatin1String("Ok"));
+  }
+  const auto generatedTimes = generatedEngine.metrics().renderTimes;
+  QCOMPARE(generatedTimes.size(), 1025);
+  QCOMPARE(generatedTimes.value(QStringLiteral("generated0")).count,
+           qint64(1));
+  QCOMPARE(generatedTimes.value(QString()).count, qint64(76));
+}
+
+void TestCachingLoader::testMemoryBudget()
+{
+  Engine engine;
+  engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+
+  QSharedPointer<InMemoryTemplateLoader> loader(new InMemoryTemplateLoader);
+  loader->setTemplate(QStringLiteral("small"), QStringLiteral("Ok"));
+  loader->setTemplate(
+      QStringLiteral("large"),
+      QStringLiteral("{% for item in list %}{% if item %}{{ item|upper }}"
+                     "{% else %}Some text{% endif %}{% endfor %}")
+          .repeated(10));
+
+  QSharedPointer<Grantlee::CachingLoaderDecorator> cache(
+      new Grantlee::CachingLoaderDecorator(loader));
+
+  engine.addTemplateLoader(cache);
+
+  const auto small = engine.loadByName(QStringLiteral("small"));
+  const auto large = engine.loadByName(QStringLiteral("large"));
+  QVERIFY(small->memoryUsage() > 0);
+  QVERIFY(large->memoryUsage() > small->memoryUsage());
+
+  QCOMPARE(cache->memoryBudget(), qint64(0));
+  QCOMPARE(cache->memoryUsage(),
+           small->memoryUsage() + large->memoryUsage());
+  auto report = cache->memoryReport();
+  QCOMPARE(report.size(), 2);
+  QCOMPARE(report.value(QStringLiteral("small")), small->memoryUsage());
+  QCOMPARE(report.value(QStringLiteral("large")), large->memoryUsage());
+
+  // The least recently used template is removed first.
+  cache->setMemoryBudget(large->memoryUsage());
+  QCOMPARE(cache->size(), 1);
+  QCOMPARE(cache->memoryUsage(), large->memoryUsage());
+  QCOMPARE(cache->evictions(), qint64(1));
+
+  // The template which was just loaded is kept.
+  engine.loadByName(QStringLiteral("small"));
+  report = cache->memoryReport();
+  QCOMPARE(report.size(), 1);
+  QVERIFY(report.contains(QStringLiteral("small")));
+  QCOMPARE(cache->evictions(), qint64(2));
+
+  cache->setMemoryBudget(0);
+  engine.loadByName(QStringLiteral("large"));
+  QCOMPARE(cache->size(), 2);
+}
+
 QTEST_MAIN(TestCachingLoader)
 #include "testcachingloader.moc"
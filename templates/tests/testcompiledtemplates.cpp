@@ -0,0 +1,159 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <QtTest/QTest>
+
+#include "compiledtemplate.h"
+#include "context.h"
+#include "coverageobject.h"
+#include "engine.h"
+#include "grantlee_paths.h"
+#include "template.h"
+
+// Generated by grantlee-compile from the templates in the compiled
+// directory.
+void addCompiledTestTemplates(Grantlee::CompiledTemplateLoader *loader);
+
+using namespace Grantlee;
+
+class TestCompiledTemplates : public CoverageObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void testTemplateNames();
+
+  void testRender_data();
+  void testRender();
+
+  void testCompiledNodes();
+
+private:
+  Engine *m_compiledEngine;
+  Engine *m_interpretedEngine;
+};
+
+void TestCompiledTemplates::initTestCase()
+{
+  m_compiledEngine = new Engine(this);
+  m_compiledEngine->setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  auto compiledLoader = QSharedPointer<CompiledTemplateLoader>::create();
+  addCompiledTestTemplates(compiledLoader.data());
+  m_compiledEngine->addTemplateLoader(compiledLoader);
+
+  m_interpretedEngine = new Engine(this);
+  m_interpretedEngine->setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+  auto fileLoader = QSharedPointer<FileSystemTemplateLoader>::create();
+  fileLoader->setTemplateDirs(
+      {QStringLiteral(GRANTLEE_COMPILED_TEMPLATE_PATH)});
+  m_interpretedEngine->addTemplateLoader(fileLoader);
+}
+
+void TestCompiledTemplates::cleanupTestCase()
+{
+  delete m_compiledEngine;
+  delete m_interpretedEngine;
+}
+
+void TestCompiledTemplates::testTemplateNames()
+{
+  CompiledTemplateLoader loader;
+  QVERIFY(!loader.canLoadTemplate(QStringLiteral("text.html")));
+
+  addCompiledTestTemplates(&loader);
+  QCOMPARE(loader.templateNames(),
+           QStringList({QStringLiteral("base.html"),
+                        QStringLiteral("child.html"),
+                        QStringLiteral("include.html"),
+                        QStringLiteral("tags.html"),
+                        QStringLiteral("text.html")}));
+  QVERIFY(loader.canLoadTemplate(QStringLiteral("text.html")));
+  QVERIFY(!loader.canLoadTemplate(QStringLiteral("missing.html")));
+}
+
+void TestCompiledTemplates::testRender_data()
+{
+  QTest::addColumn<QString>("name");
+
+  QTest::newRow("text") << QStringLiteral("text.html");
+  QTest::newRow("tags") << QStringLiteral("tags.html");
+  QTest::newRow("extends") << QStringLiteral("child.html");
+  QTest::newRow("block") << QStringLiteral("base.html");
+  QTest::newRow("include") << QStringLiteral("include.html");
+}
+
+void TestCompiledTemplates::testRender()
+{
+  QFETCH(QString, name);
+
+  QVariantHash user;
+  user.insert(QStringLiteral("name"), QStringLiteral("Alice <admin>"));
+
+  QVariantHash mapping;
+  mapping.insert(QStringLiteral("name"), QStringLiteral("World & Co"));
+  mapping.insert(QStringLiteral("user"), user);
+  mapping.insert(QStringLiteral("items"),
+                 QVariantList{QStringLiteral("a"), QStringLiteral("b")});
+  mapping.insert(QStringLiteral("html"), QStringLiteral("<b>bold</b>"));
+
+  Context c(mapping);
+
+  const auto interpreted = m_interpretedEngine->loadByName(name);
+  QCOMPARE(interpreted->error(), NoError);
+  const auto expected = interpreted->render(&c);
+  QVERIFY(!expected.isEmpty());
+
+  const auto compiled = m_compiledEngine->loadByName(name);
+  QCOMPARE(compiled->error(), NoError);
+  QCOMPARE(compiled->render(&c), expected);
+  QCOMPARE(compiled->error(), NoError);
+
+  c.insert(QStringLiteral("items"), QVariantList());
+  c.insert(QStringLiteral("user"), QVariant());
+  QCOMPARE(compiled->render(&c), interpreted->render(&c));
+}
+
+void TestCompiledTemplates::testCompiledNodes()
+{
+  // Text and variables are rendered by the compiled function, and tags by
+  // the nodes parsed when the template is loaded.
+  const auto text = m_compiledEngine->loadByName(QStringLiteral("text.html"));
+  QCOMPARE(text->nodeList().size(), 1);
+  QCOMPARE(text->nodeList().first()->metaObject()->className(),
+           "Grantlee::CompiledNode");
+  QCOMPARE(text->findChildren<Node *>().size(), 1);
+
+  const auto tags = m_compiledEngine->loadByName(QStringLiteral("tags.html"));
+  QCOMPARE(tags->nodeList().size(), 1);
+  QVERIFY(tags->findChildren<Node *>().size() > 1);
+
+  // Templates which use the extends tag are parsed entirely.
+  const auto child
+      = m_compiledEngine->loadByName(QStringLiteral("child.html"));
+  QCOMPARE(child->nodeList().size(), 1);
+  QCOMPARE(child->nodeList().first()->metaObject()->className(),
+           "Grantlee::ExtendsNode");
+}
+
+QTEST_MAIN(TestCompiledTemplates)
+#include "testcompiledtemplates.moc"
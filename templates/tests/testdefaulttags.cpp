@@ -21,14 +21,18 @@
 #ifndef DEFAULTTAGSTEST_H
 #define DEFAULTTAGSTEST_H
 
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QAbstractTableModel>
 #include <QtCore/QDebug>
 #include <QtTest/QTest>
 
 #include "context.h"
 #include "coverageobject.h"
 #include "engine.h"
+#include "generator.h"
 #include "grantlee_paths.h"
 #include "metatype.h"
+#include "renderprogram_p.h"
 #include "template.h"
 #include "util.h"
 
@@ -70,6 +74,122 @@ public:
   Q_ENUMS(Animals)
 };
 
+/**
+  A model which makes its rows available in batches of two, like a
+  QSqlQueryModel does with large result sets.
+*/
+class BookModel : public QAbstractTableModel
+{
+  Q_OBJECT
+  Q_PROPERTY(int fetched READ fetched)
+public:
+  BookModel(int bookCount, QObject *parent = {})
+      : QAbstractTableModel(parent), m_bookCount(bookCount)
+  {
+  }
+
+  int rowCount(const QModelIndex &parent = {}) const override
+  {
+    return parent.isValid() ? 0 : m_fetched;
+  }
+
+  int columnCount(const QModelIndex &parent = {}) const override
+  {
+    return parent.isValid() ? 0 : 2;
+  }
+
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override
+  {
+    if (role != Qt::DisplayRole)
+      return {};
+    if (index.column() == 0)
+      return QStringLiteral("Title %1").arg(index.row());
+    return QStringLiteral("Author %1").arg(index.row());
+  }
+
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override
+  {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+      return {};
+    ++m_headerLookups;
+    return section == 0 ? QStringLiteral("title") : QStringLiteral("author");
+  }
+
+  bool canFetchMore(const QModelIndex &parent) const override
+  {
+    return !parent.isValid() && m_fetched < m_bookCount;
+  }
+
+  void fetchMore(const QModelIndex &parent) override
+  {
+    if (parent.isValid())
+      return;
+    const auto toFetch = qMin(2, m_bookCount - m_fetched);
+    beginInsertRows({}, m_fetched, m_fetched + toFetch - 1);
+    m_fetched += toFetch;
+    endInsertRows();
+  }
+
+  int fetched() const { return m_fetched; }
+
+  int m_bookCount;
+  int m_fetched = 0;
+  mutable int m_headerLookups = 0;
+};
+
+/**
+  A model with a role called "row", which takes precedence over the row of
+  the index in lookups.
+*/
+class SeatModel : public QAbstractListModel
+{
+  Q_OBJECT
+public:
+  enum { RowRole = Qt::UserRole };
+
+  SeatModel(QObject *parent = {}) : QAbstractListModel(parent) {}
+
+  int rowCount(const QModelIndex &parent = {}) const override
+  {
+    return parent.isValid() ? 0 : 2;
+  }
+
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override
+  {
+    if (role == RowRole)
+      return QStringLiteral("R%1").arg(index.row() + 10);
+    if (role == Qt::DisplayRole)
+      return QStringLiteral("Seat %1").arg(index.row());
+    return {};
+  }
+
+  QHash<int, QByteArray> roleNames() const override
+  {
+    return {{Qt::DisplayRole, "display"}, {RowRole, "row"}};
+  }
+};
+
+class CounterGenerator : public Grantlee::AbstractGenerator
+{
+  Q_OBJECT
+public:
+  CounterGenerator(int count, QObject *parent = {})
+      : Grantlee::AbstractGenerator(parent), m_count(count)
+  {
+  }
+
+  void reset() override { m_current = 0; }
+  bool hasNext() override { return m_current < m_count; }
+  QVariant next() override { return m_current++; }
+
+private:
+  int m_count;
+  int m_current = 0;
+};
+
 using namespace Grantlee;
 
 class TestDefaultTags : public CoverageObject
@@ -92,6 +212,10 @@ private Q_SLOTS:
   void testForTag_data();
   void testForTag() { doTest(); }
 
+  void testForTagLazySequences();
+
+  void testBytecode();
+
   void testIfEqualTag_data();
   void testIfEqualTag() { doTest(); }
 
@@ -184,6 +308,16 @@ void TestDefaultTags::doTest()
 
   auto result = t->render(&context);
 
+  // The bytecode of the template renders the same result.
+  m_engine->setBytecodeEnabled(true);
+  auto program
+      = m_engine->newTemplate(input, QLatin1String(QTest::currentDataTag()));
+  Context programContext(dict);
+  const auto programResult = program->render(&programContext);
+  m_engine->setBytecodeEnabled(false);
+  QCOMPARE(program->error(), t->error());
+  QCOMPARE(programResult, result);
+
   if (t->error() != NoError) {
     if (t->error() != error)
       qDebug() << t->errorString();
@@ -1313,6 +1447,122 @@ void TestDefaultTags::testForTag_data()
       << dict << QStringLiteral("values array not found") << NoError;
 }
 
+void TestDefaultTags::testForTagLazySequences()
+{
+  auto t = m_engine->newTemplate(
+      QStringLiteral("{% for book in books %}{{ book.title }}/{{ book.1 }}"
+                     "{% if forloop.last %}.{% else %},{% endif %}"
+                     "{% empty %}None{% endfor %}"),
+      QStringLiteral("lazy-for01"));
+
+  BookModel model(5);
+  Context c;
+  c.insert(QStringLiteral("books"), &model);
+  QCOMPARE(t->render(&c), QStringLiteral("Title 0/Author 0,Title 1/Author "
+                                         "1,Title 2/Author 2,Title 3/Author "
+                                         "3,Title 4/Author 4."));
+  QCOMPARE(model.m_fetched, 5);
+  // The column headers are read once for the loop, not for each row.
+  QCOMPARE(model.m_headerLookups, 2);
+
+  BookModel emptyModel(0);
+  c.insert(QStringLiteral("books"), &emptyModel);
+  QCOMPARE(t->render(&c), QStringLiteral("None"));
+
+  // Rows are fetched in batches, one batch ahead of the current row, and
+  // forloop.revcounter is not defined for any row of a lazy loop.
+  t = m_engine->newTemplate(
+      QStringLiteral("{% for book in books %}{{ forloop.counter0 }}:"
+                     "{{ books.fetched }}:{{ forloop.revcounter }};"
+                     "{% endfor %}"),
+      QStringLiteral("lazy-for05"));
+  BookModel lazyModel(5);
+  c.insert(QStringLiteral("books"), &lazyModel);
+  QCOMPARE(t->render(&c), QStringLiteral("0:2:;1:4:;2:4:;3:5:;4:5:;"));
+
+  // All rows of the model are available, so the loop is not lazy.
+  QCOMPARE(t->render(&c), QStringLiteral("0:5:5;1:5:4;2:5:3;3:5:2;4:5:1;"));
+
+  t = m_engine->newTemplate(
+      QStringLiteral("{% for title, author in books reversed %}{{ title }}:"
+                     "{{ author }};{% endfor %}"),
+      QStringLiteral("lazy-for02"));
+  BookModel reversedModel(3);
+  c.insert(QStringLiteral("books"), &reversedModel);
+  QCOMPARE(t->render(&c), QStringLiteral("Title 2:Author 2;Title 1:Author "
+                                         "1;Title 0:Author 0;"));
+
+  t = m_engine->newTemplate(
+      QStringLiteral("{% for i in numbers %}{{ i }}{{ forloop.revcounter }}"
+                     "{% if not forloop.last %},{% endif %}"
+                     "{% empty %}None{% endfor %}"),
+      QStringLiteral("lazy-for03"));
+
+  CounterGenerator generator(4);
+  c.insert(QStringLiteral("numbers"), &generator);
+  QCOMPARE(t->render(&c), QStringLiteral("0,1,2,3"));
+  // The generator is reset for each loop.
+  QCOMPARE(t->render(&c), QStringLiteral("0,1,2,3"));
+
+  CounterGenerator emptyGenerator(0);
+  c.insert(QStringLiteral("numbers"), &emptyGenerator);
+  QCOMPARE(t->render(&c), QStringLiteral("None"));
+
+  t = m_engine->newTemplate(
+      QStringLiteral("{% for i in numbers reversed %}{{ i }}{{ "
+                     "forloop.revcounter }};{% endfor %}"),
+      QStringLiteral("lazy-for04"));
+  c.insert(QStringLiteral("numbers"), &generator);
+  QCOMPARE(t->render(&c), QStringLiteral("34;23;12;01;"));
+
+  // Roles and headers of the model are not hidden by the row and column of
+  // the index.
+  t = m_engine->newTemplate(
+      QStringLiteral("{% for seat in seats %}{{ seat.display }}:{{ seat.row }}"
+                     ":{{ seat.column }};{% endfor %}"),
+      QStringLiteral("lazy-for06"));
+  SeatModel seats;
+  c.insert(QStringLiteral("seats"), &seats);
+  QCOMPARE(t->render(&c), QStringLiteral("Seat 0:R10:0;Seat 1:R11:0;"));
+}
+
+void TestDefaultTags::testBytecode()
+{
+  m_engine->setBytecodeEnabled(true);
+  auto t = m_engine->newTemplate(
+      QStringLiteral("{% for item in items %}{% if item %}{{ item }}"
+                     "{% else %}-{% endif %}{% with last=forloop.last %}"
+                     "{% if not last %},{% endif %}{% endwith %}"
+                     "{% empty %}None{% endfor %}"),
+      QStringLiteral("bytecode01"));
+  auto modelTemplate = m_engine->newTemplate(
+      QStringLiteral("{% for book in books %}{{ book.title }};"
+                     "{% empty %}None{% endfor %}"),
+      QStringLiteral("bytecode02"));
+  m_engine->setBytecodeEnabled(false);
+
+  // The builtin tags are lowered into instructions.
+  RenderProgram program(t.data());
+  program.append(t->nodeList());
+  QVERIFY(!program.dump().contains(QStringLiteral("CallNode")));
+
+  Context c;
+  c.insert(QStringLiteral("items"),
+           QVariantList{1, 0, QStringLiteral("<b>")});
+  QCOMPARE(t->render(&c), QStringLiteral("1,-,&lt;b&gt;"));
+  c.insert(QStringLiteral("items"), QVariantList());
+  QCOMPARE(t->render(&c), QStringLiteral("None"));
+
+  // Models are iterated by the node.
+  BookModel model(3);
+  c.insert(QStringLiteral("books"), &model);
+  QCOMPARE(modelTemplate->render(&c),
+           QStringLiteral("Title 0;Title 1;Title 2;"));
+  BookModel emptyModel(0);
+  c.insert(QStringLiteral("books"), &emptyModel);
+  QCOMPARE(modelTemplate->render(&c), QStringLiteral("None"));
+}
+
 void TestDefaultTags::testIfEqualTag_data()
 {
   QTest::addColumn<QString>("input");
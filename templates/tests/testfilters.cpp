@@ -33,6 +33,8 @@
 #include "template.h"
 #include <util.h>
 
+#include <algorithm>
+
 using Dict = QHash<QString, QVariant>;
 
 Q_DECLARE_METATYPE(Grantlee::Error)
@@ -382,6 +384,17 @@ void TestFilters::testDateBasedFilters_data()
   dict.insert(QStringLiteral("d"), QStringLiteral("fail_string"));
   QTest::newRow("date03") << "{{ d|date:\"MM\" }}" << dict << QString()
                           << NoError;
+
+  d = QDateTime(QDate(2008, 1, 1), QTime(15, 4, 5, 6));
+  dict.clear();
+  dict.insert(QStringLiteral("d"), d);
+  QTest::newRow("date04")
+      << QStringLiteral("{{ d|date:\"ddd, d MMM yyyy 'at' h:mm ap\" }}")
+      << dict << d.toString(QStringLiteral("ddd, d MMM yyyy 'at' h:mm ap"))
+      << NoError;
+  QTest::newRow("time01")
+      << QStringLiteral("{{ d|time:\"HH:mm:ss.zzz\" }}{{ d|time:\"HH:mm\" }}")
+      << dict << QStringLiteral("15:04:05.00615:04") << NoError;
 }
 
 void TestFilters::testStringFilters_data()
@@ -574,6 +587,15 @@ void TestFilters::testStringFilters_data()
   QTest::newRow("filter-slugify03") << QStringLiteral("{{ a|slugify }}") << dict
                                     << QStringLiteral("schone-grue") << NoError;
 
+  dict.clear();
+  dict.insert(QStringLiteral("a"),
+              QStringLiteral("  -Hello,  World! - foo_bar\t "));
+  dict.insert(QStringLiteral("b"), QStringLiteral("! tail -"));
+
+  QTest::newRow("filter-slugify04")
+      << QStringLiteral("{{ a|slugify }} {{ b|slugify }}") << dict
+      << QStringLiteral("-hello-world-foo_bar tail-") << NoError;
+
   dict.clear();
   dict.insert(
       QStringLiteral("a"),
@@ -978,6 +1000,12 @@ void TestFilters::testStringFilters_data()
       << "{% autoescape off %}{{ a|removetags:\"a b\" }} {{ b|removetags:\"a "
          "b\" }}{% endautoescape %}"
       << dict << QStringLiteral("x <p>y</p> x <p>y</p>") << NoError;
+
+  dict.insert(QStringLiteral("tags"), QStringLiteral("p"));
+
+  QTest::newRow("filter-removetags03")
+      << R"({{ b|removetags:tags }} {{ b|removetags:"b p" }})" << dict
+      << QStringLiteral("<a>x</a> <b>y</b> <a>x</a> y") << NoError;
   QTest::newRow("filter-striptags01")
       << QStringLiteral("{{ a|striptags }} {{ b|striptags }}") << dict
       << QStringLiteral("x y x y") << NoError;
@@ -1075,6 +1103,34 @@ void TestFilters::testStringFilters_data()
 
   QTest::newRow("filter-filesizeformat07")
       << fsInput << dict << fsExpect << NoError;
+
+  // Chains of string filters are run without converting the string to a
+  // QVariant between the filters, and must give the same results.
+
+  dict.clear();
+  dict.insert(QStringLiteral("a"), QStringLiteral("Hello <B>World</B> Again"));
+  dict.insert(QStringLiteral("b"), QVariant::fromValue(markSafe(
+                                       QStringLiteral("<b>Bold</b> text"))));
+  dict.insert(QStringLiteral("c"),
+              QVariantList{QStringLiteral("a"), QStringLiteral("b")});
+
+  QTest::newRow("filter-chain01")
+      << QStringLiteral("{{ a|lower|truncatewords:2|escape }}") << dict
+      << QStringLiteral("hello &lt;b&gt;world&lt;/b&gt; ...") << NoError;
+
+  QTest::newRow("filter-chain02")
+      << QStringLiteral("{{ b|lower|capfirst }} {{ b|lower|upper }}") << dict
+      << QStringLiteral("<b>bold</b> text &lt;B&gt;BOLD&lt;/B&gt; TEXT")
+      << NoError;
+
+  QTest::newRow("filter-chain03")
+      << QStringLiteral("{{ c|join:\", \"|upper|cut:\" \" }} "
+                        "{{ a|lower|length }}")
+      << dict << QStringLiteral("A,B 24") << NoError;
+
+  QTest::newRow("filter-chain04")
+      << QStringLiteral("{{ b|truncatewords:\"x\"|upper }}") << dict
+      << QStringLiteral("&lt;B&gt;BOLD&lt;/B&gt; TEXT") << NoError;
 }
 
 void TestFilters::testListFilters_data()
@@ -1461,6 +1517,50 @@ void TestFilters::testListFilters_data()
       << "London;England;English,Paris;France;French,Berlin;Germany;"
          "German,Dublin;Ireland;Irish,"
       << NoError;
+
+  dict.clear();
+
+  // Items without the key sort first.
+  QVariantList mixedList;
+  for (const auto &n : {QVariant(2), QVariant(), QVariant(1)}) {
+    QVariantHash map;
+    if (n.isValid())
+      map.insert(QStringLiteral("n"), n);
+    mixedList << map;
+  }
+  dict.insert(QStringLiteral("mixedList"), mixedList);
+
+  QTest::newRow("dictsort05")
+      << "{% for item in mixedList|dictsort:'n' %}{{ item.n }},{% endfor %}"
+      << dict << ",1,2," << NoError;
+
+  // Enough items to be sorted on several threads. Items with equal keys
+  // keep their order.
+  QVariantList numberList;
+  QList<QPair<int, int>> expectedNumbers;
+  for (auto i = 0; i < 20000; ++i) {
+    const auto n = (i * 7919) % 1000;
+    QVariantHash map;
+    map.insert(QStringLiteral("n"), n);
+    map.insert(QStringLiteral("i"), i);
+    numberList << map;
+    expectedNumbers << qMakePair(n, i);
+  }
+  std::stable_sort(
+      expectedNumbers.begin(), expectedNumbers.end(),
+      [](const QPair<int, int> &l, const QPair<int, int> &r) {
+        return l.first < r.first;
+      });
+  QString expectedOutput;
+  for (const auto &number : qAsConst(expectedNumbers))
+    expectedOutput += QString::number(number.first) + QLatin1Char('.')
+                      + QString::number(number.second) + QLatin1Char(',');
+  dict.insert(QStringLiteral("numberList"), numberList);
+
+  QTest::newRow("dictsort06")
+      << "{% for item in numberList|dictsort:'n' %}{{ item.n }}.{{ item.i "
+         "}},{% endfor %}"
+      << dict << expectedOutput << NoError;
 }
 
 void TestFilters::testLogicFilters_data()
@@ -20,6 +20,7 @@
 */
 
 #include "engine.h"
+#include "enginemetrics.h"
 #include "grantlee_paths.h"
 #include "metatype.h"
 #include "template.h"
@@ -164,6 +165,11 @@ void TestGenericTypes::testGenericClassType()
   Grantlee::Context c(h);
   QCOMPARE(t1->render(&c),
            QStringLiteral("Person: \nName: Grant Lee\nAge: 2\nUnknown: "));
+
+  // The lookups are counted for the Engine which rendered them.
+  QCOMPARE(engine.metrics().customTypeLookups, qint64(3));
+  Grantlee::Engine otherEngine;
+  QCOMPARE(otherEngine.metrics().customTypeLookups, qint64(0));
 }
 
 static QMap<int, Person> getPeople()
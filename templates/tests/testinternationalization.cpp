@@ -18,13 +18,16 @@
 
 */
 
+#include "datetimeformat_p.h"
 #include "engine.h"
 #include "grantlee_paths.h"
+#include "localizerrevision_p.h"
 #include "nulllocalizer_p.h"
 #include "qtlocalizer.h"
 #include "util.h"
 
 #include "coverageobject.h"
+#include <QtCore/QCoreApplication>
 #include <QtCore/QScopedPointer>
 #include <QtCore/QTranslator>
 #include <QtTest/QTest>
@@ -96,6 +99,10 @@ private Q_SLOTS:
   void testLocalizedTemplate();
   void testSafeContent();
   void testFailure();
+  void testTranslationCache();
+  void testLocalizedBytecode();
+  void testLocalizedBytecodeCatalogs();
+  void testDateTimeFormat();
 
   void testStrings_data();
   void testIntegers_data();
@@ -106,6 +113,7 @@ private Q_SLOTS:
   void testLocalizedTemplate_data();
   void testSafeContent_data();
   void testFailure_data();
+  void testDateTimeFormat_data();
 
 private:
   QSharedPointer<QtLocalizer> cLocalizer;
@@ -130,6 +138,108 @@ void TestInternationalization::testContext()
   QVERIFY(c.localizer());
 }
 
+void TestInternationalization::testTranslationCache()
+{
+  QtLocalizer localizer(QLocale::c());
+  localizer.setAppTranslatorPrefix(QStringLiteral("test_"));
+  localizer.setAppTranslatorPath(QStringLiteral(":/"));
+  localizer.pushLocale(QStringLiteral("de_DE"));
+
+  for (auto i = 0; i < 2; ++i) {
+    QCOMPARE(localizer.localizeString(QStringLiteral("Birthday")),
+             QStringLiteral("Geburtstag"));
+    QCOMPARE(localizer.localizePluralString(QStringLiteral("%n People"),
+                                            QString(), {1}),
+             QStringLiteral("1 Person"));
+    QCOMPARE(localizer.localizePluralString(QStringLiteral("%n People"),
+                                            QString(), {2}),
+             QStringLiteral("2 Personen"));
+  }
+
+  // Installing a translator discards the cached translations.
+  auto frTranslator = new QTranslator(this);
+  QVERIFY(frTranslator->load(QStringLiteral(":/test_fr_FR.qm")));
+  localizer.installTranslator(frTranslator, QStringLiteral("de_DE"));
+  QCOMPARE(localizer.localizeString(QStringLiteral("Birthday")),
+           QStringLiteral("Anniversaire"));
+}
+
+void TestInternationalization::testLocalizedBytecode()
+{
+  m_engine->setBytecodeEnabled(true);
+  auto t = m_engine->newTemplate(
+      QStringLiteral("{% i18n 'Birthday' %} {{ _('Birthday') }} "
+                     "{% i18nc 'Name of a Person' 'Name' %} "
+                     "{% i18n '%1 People' count %}"),
+      QString());
+  m_engine->setBytecodeEnabled(false);
+
+  auto localizer = QSharedPointer<QtLocalizer>::create(QLocale::c());
+  localizer->setAppTranslatorPrefix(QStringLiteral("test_"));
+  localizer->setAppTranslatorPath(QStringLiteral(":/"));
+  localizer->pushLocale(QStringLiteral("de_DE"));
+
+  QVariantHash h;
+  h.insert(QStringLiteral("count"), 3);
+  Context c(h);
+  c.setLocalizer(localizer);
+  const auto de = QStringLiteral("Geburtstag Geburtstag Namen einer Person "
+                                 "3 People");
+  QCOMPARE(t->render(&c), de);
+  QCOMPARE(t->render(&c), de);
+
+  // The text is localized again when the translators change.
+  const auto revision = localizerRevision(localizer.data());
+  auto frTranslator = new QTranslator(this);
+  QVERIFY(frTranslator->load(QStringLiteral(":/test_fr_FR.qm")));
+  localizer->installTranslator(frTranslator, QStringLiteral("de_DE"));
+  QVERIFY(localizerRevision(localizer.data()) != revision);
+  QCOMPARE(t->render(&c),
+           QStringLiteral("Anniversaire Anniversaire Nom d&#39;une personne "
+                          "3 People"));
+
+  localizer->popLocale();
+  QCOMPARE(t->render(&c), QStringLiteral("Birthday Birthday Name 3 People"));
+}
+
+void TestInternationalization::testLocalizedBytecodeCatalogs()
+{
+  m_engine->setBytecodeEnabled(true);
+  auto t = m_engine->newTemplate(
+      QStringLiteral("{% i18n 'Birthday' %} {% i18n 'Guests' %}"), QString());
+  m_engine->setBytecodeEnabled(false);
+
+  // The localizer only has the translations of a catalog.
+  auto localizer = QSharedPointer<QtLocalizer>::create(
+      QLocale(QLocale::French, QLocale::France));
+  localizer->loadCatalog(QStringLiteral(":/catalogs"), QStringLiteral("test"));
+  QVERIFY(localizerRevision(localizer.data()) >= 0);
+
+  // Text from the catalog is cached, and text left to the translators of
+  // the application is not.
+  beginCacheableTranslation();
+  QCOMPARE(localizer->localizeString(QStringLiteral("Birthday")),
+           QStringLiteral("Anniversaire"));
+  QVERIFY(endCacheableTranslation());
+  beginCacheableTranslation();
+  QCOMPARE(localizer->localizeString(QStringLiteral("Guests")),
+           QStringLiteral("Guests"));
+  QVERIFY(!endCacheableTranslation());
+
+  Context c;
+  c.setLocalizer(localizer);
+  QCOMPARE(t->render(&c), QStringLiteral("Anniversaire Guests"));
+
+  QTranslator appTranslator;
+  QVERIFY(appTranslator.load(QStringLiteral(":/test_de_DE.qm")));
+  QCoreApplication::installTranslator(&appTranslator);
+  QCOMPARE(t->render(&c), QStringLiteral("Anniversaire Guests"));
+  localizer->unloadCatalog(QStringLiteral("test"));
+  QCOMPARE(t->render(&c), QStringLiteral("Geburtstag Guests"));
+  QCoreApplication::removeTranslator(&appTranslator);
+  QCOMPARE(t->render(&c), QStringLiteral("Birthday Guests"));
+}
+
 void TestInternationalization::testStrings()
 {
   QFETCH(QString, input);
@@ -323,18 +433,26 @@ void TestInternationalization::testLocalizedTemplate()
   QFETCH(QString, frFragment);
   QFETCH(Dict, dict);
 
-  auto t = m_engine->newTemplate(input, QString());
-  Context c(dict);
-  c.setLocalizer(cLocalizer);
-  QCOMPARE(t->render(&c), cFragment);
-  c.setLocalizer(en_USLocalizer);
-  QCOMPARE(t->render(&c), en_USFragment);
-  c.setLocalizer(en_GBLocalizer);
-  QCOMPARE(t->render(&c), en_GBFragment);
-  c.setLocalizer(deLocalizer);
-  QCOMPARE(t->render(&c), deFragment);
-  c.setLocalizer(frLocalizer);
-  QCOMPARE(t->render(&c), frFragment);
+  // Bytecode renders localize constant text once for each locale, so the
+  // bytecode template is rendered twice in each locale.
+  for (auto bytecode : {false, true}) {
+    m_engine->setBytecodeEnabled(bytecode);
+    auto t = m_engine->newTemplate(input, QString());
+    m_engine->setBytecodeEnabled(false);
+    for (auto i = 0; i < (bytecode ? 2 : 1); ++i) {
+      Context c(dict);
+      c.setLocalizer(cLocalizer);
+      QCOMPARE(t->render(&c), cFragment);
+      c.setLocalizer(en_USLocalizer);
+      QCOMPARE(t->render(&c), en_USFragment);
+      c.setLocalizer(en_GBLocalizer);
+      QCOMPARE(t->render(&c), en_GBFragment);
+      c.setLocalizer(deLocalizer);
+      QCOMPARE(t->render(&c), deFragment);
+      c.setLocalizer(frLocalizer);
+      QCOMPARE(t->render(&c), frFragment);
+    }
+  }
 }
 
 void TestInternationalization::testLocalizedTemplate_data()
@@ -1009,6 +1127,51 @@ void TestInternationalization::testFailure_data()
       "visited today' %}");
 }
 
+void TestInternationalization::testDateTimeFormat()
+{
+  QFETCH(QString, format);
+
+  // Years after 9999 are formatted by QLocale.
+  const QVector<QDateTime> dateTimes{
+      QDateTime(QDate(2010, 5, 9), QTime(13, 5, 9, 45)),
+      QDateTime(QDate(1999, 12, 31), QTime(0, 0)),
+      QDateTime(QDate(12345, 1, 1), QTime(12, 0))};
+
+  for (const auto &name : {"C", "en_US", "de_DE", "fr_FR"}) {
+    const QLocale locale(QLatin1String(name));
+    const DateTimeFormat dateFormat(locale, format, DateTimeFormat::DateFields);
+    const DateTimeFormat timeFormat(locale, format, DateTimeFormat::TimeFields);
+    const DateTimeFormat dateTimeFormat(locale, format,
+                                        DateTimeFormat::DateTimeFields);
+    for (const auto &dateTime : dateTimes) {
+      QCOMPARE(dateFormat.toString(dateTime.date()),
+               locale.toString(dateTime.date(), format));
+      QCOMPARE(timeFormat.toString(dateTime.time()),
+               locale.toString(dateTime.time(), format));
+      QCOMPARE(dateTimeFormat.toString(dateTime),
+               locale.toString(dateTime, format));
+    }
+    QCOMPARE(dateTimeFormat.toString(QDateTime()),
+             locale.toString(QDateTime(), format));
+  }
+}
+
+void TestInternationalization::testDateTimeFormat_data()
+{
+  QTest::addColumn<QString>("format");
+
+  QTest::newRow("numbers") << QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz");
+  QTest::newRow("short") << QStringLiteral("d/M/yy h:m:s");
+  QTest::newRow("names") << QStringLiteral("dddd d MMMM yy, ddd MMM");
+  QTest::newRow("ampm") << QStringLiteral("h:mm ap, hh:mm AP, H a A");
+  QTest::newRow("quoted") << QStringLiteral("'Date:' d 'o''clock' '' 'open");
+  QTest::newRow("repeated") << QStringLiteral("ddddd MMMMM hhh yyy y zzzz");
+  QTest::newRow("literal") << QStringLiteral("yyyy-MM-ddTHH:mm, % \\ ");
+  QTest::newRow("fallback") << QStringLiteral("h:mm:ss.z t");
+  QTest::newRow("mixed-ampm") << QStringLiteral("h Ap aP");
+  QTest::newRow("empty") << QString();
+}
+
 void TestInternationalization::testDates()
 {
   QFETCH(QDate, date);
@@ -21,9 +21,13 @@
 #ifndef LOADERTAGSTEST_H
 #define LOADERTAGSTEST_H
 
+#include <QtCore/QBuffer>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QSet>
 #include <QtTest/QTest>
 
 #include "context.h"
@@ -31,6 +35,7 @@
 #include "engine.h"
 #include "grantlee_paths.h"
 #include "template.h"
+#include "tracer.h"
 
 using Dict = QHash<QString, QVariant>;
 
@@ -47,6 +52,7 @@ private Q_SLOTS:
   void cleanupTestCase();
 
   void testTemplateFromQrc();
+  void testTracer();
 
   void testIncludeTag_data();
   void testIncludeTag() { doTest(); }
@@ -122,6 +128,91 @@ void TestLoaderTags::testTemplateFromQrc()
   QCOMPARE(result, QStringLiteral("one-two-three-four\n\n"));
 }
 
+void TestLoaderTags::testTracer()
+{
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+
+  {
+    Tracer tracer(&buffer);
+    QVERIFY(tracer.isOpen());
+
+    Engine engine;
+    engine.setTracer(&tracer);
+    QCOMPARE(engine.tracer(), &tracer);
+
+    auto fileLoader
+        = QSharedPointer<Grantlee::FileSystemTemplateLoader>::create();
+    fileLoader->setTemplateDirs({QStringLiteral(":/templates/")});
+    engine.addTemplateLoader(fileLoader);
+
+    auto memoryLoader = QSharedPointer<InMemoryTemplateLoader>::create();
+    memoryLoader->setTemplate(
+        QStringLiteral("base"),
+        QStringLiteral("base-{% block b %}{% endblock %}"));
+    memoryLoader->setTemplate(
+        QStringLiteral("child"),
+        QStringLiteral("{% extends \"base\" %}"
+                       "{% block b %}child{% endblock %}"));
+    engine.addTemplateLoader(memoryLoader);
+    engine.setPluginPaths({QStringLiteral(GRANTLEE_PLUGIN_PATH)});
+
+    auto t = engine.newTemplate(
+        QStringLiteral("{% include \"resourcetemplate1.html\" %}"
+                       "{% include \"child\" %}"),
+        QStringLiteral("main"));
+
+    Context context;
+    context.insert(QStringLiteral("numbertwo"), QStringLiteral("two"));
+    context.insert(QStringLiteral("numberfour"), QStringLiteral("four"));
+
+    QCOMPARE(t->render(&context),
+             QStringLiteral("one-two-three-four\n\nbase-child"));
+  }
+
+  const auto document = QJsonDocument::fromJson(buffer.data());
+  QVERIFY(document.isArray());
+
+  QSet<QString> names;
+  QSet<QString> renderedTemplates;
+  QStringList loadedLibraries;
+  for (const auto &value : document.array()) {
+    const auto event = value.toObject();
+    QCOMPARE(event.value(QStringLiteral("ph")).toString(),
+             QStringLiteral("X"));
+    QVERIFY(event.contains(QStringLiteral("tid")));
+    QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 0);
+
+    const auto name = event.value(QStringLiteral("name")).toString();
+    const auto args = event.value(QStringLiteral("args")).toObject();
+    names.insert(name);
+    if (name == QLatin1String("render"))
+      renderedTemplates.insert(
+          args.value(QStringLiteral("template")).toString());
+    if (name == QLatin1String("extends"))
+      QCOMPARE(args.value(QStringLiteral("parent")).toString(),
+               QStringLiteral("base"));
+    if (name == QLatin1String("loadLibrary"))
+      loadedLibraries.append(args.value(QStringLiteral("library")).toString());
+  }
+
+  // Libraries are traced once when they are loaded. The filters are not
+  // used, so their library is not loaded.
+  QCOMPARE(loadedLibraries.count(QStringLiteral("grantlee_loadertags")), 1);
+  QVERIFY(!loadedLibraries.contains(QStringLiteral("grantlee_defaultfilters")));
+
+  for (const auto &name :
+       {"loadByName", "probeLoader", "readFile", "lex", "parse", "render",
+        "include", "extends", "loadLibrary"})
+    QVERIFY2(names.contains(QLatin1String(name)), name);
+
+  QCOMPARE(renderedTemplates,
+           QSet<QString>({QStringLiteral("main"),
+                          QStringLiteral("resourcetemplate1.html"),
+                          QStringLiteral("resourcetemplate2.html"),
+                          QStringLiteral("child")}));
+}
+
 void TestLoaderTags::doTest()
 {
   QFETCH(QString, input);
@@ -142,6 +233,16 @@ void TestLoaderTags::doTest()
 
   auto result = t->render(&context);
 
+  // The bytecode of the template renders the same result.
+  m_engine->setBytecodeEnabled(true);
+  auto program
+      = m_engine->newTemplate(input, QLatin1String(QTest::currentDataTag()));
+  Context programContext(dict);
+  const auto programResult = program->render(&programContext);
+  m_engine->setBytecodeEnabled(false);
+  QCOMPARE(program->error(), t->error());
+  QCOMPARE(programResult, result);
+
   if (t->error() != NoError) {
     if (t->error() != error)
       qDebug() << t->errorString();
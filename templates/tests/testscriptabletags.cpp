@@ -24,6 +24,8 @@
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 #include <QtTest/QTest>
 
 #include "context.h"
@@ -33,12 +35,28 @@
 #include "grantlee_paths.h"
 #include "template.h"
 
+#include <functional>
+
 using Dict = QHash<QString, QVariant>;
 
 Q_DECLARE_METATYPE(Grantlee::Error)
 
 using namespace Grantlee;
 
+class FunctionRunnable : public QRunnable
+{
+public:
+  explicit FunctionRunnable(const std::function<void()> &function)
+      : m_function(function)
+  {
+  }
+
+  void run() override { m_function(); }
+
+private:
+  std::function<void()> m_function;
+};
+
 class TestScriptableTagsSyntax : public CoverageObject
 {
   Q_OBJECT
@@ -52,6 +70,8 @@ private Q_SLOTS:
   void testResolve_data();
   void testResolve() { doTest(); }
 
+  void testConcurrentRender();
+
   void cleanupTestCase();
 
 private:
@@ -185,6 +205,25 @@ void TestScriptableTagsSyntax::testBasicSyntax_data()
       << QStringLiteral("{% load scripteddefaults %}{{ booList|join2:amp }}")
       << dict << QStringLiteral("Tom & Dick & Harry") << NoError;
 
+  // The arguments of filters called in a loop are passed in the same
+  // objects.
+  QTest::newRow("scriptable-tags12")
+      << "{% load scripteddefaults %}{% for name in booList %}"
+         "{{ name|upper }} {% endfor %}"
+      << dict << QStringLiteral("TOM DICK HARRY ") << NoError;
+
+  // Filters can take strings as plain strings, with the safety of the input
+  // passed separately.
+  QTest::newRow("scriptable-tags13")
+      << QStringLiteral("{% load scripteddefaults %}{{ boo|lower2 }}") << dict
+      << QStringLiteral("far &amp; away") << NoError;
+  QTest::newRow("scriptable-tags14")
+      << QStringLiteral("{% load scripteddefaults %}{{ boo|safe|lower2 }}")
+      << dict << QStringLiteral("far & away") << NoError;
+  QTest::newRow("scriptable-tags15")
+      << "{% load scripteddefaults %}{{ boo|safety }} {{ boo|safe|safety }}"
+      << dict << QStringLiteral("unsafe safe") << NoError;
+
   QTest::newRow("scriptable-load-error01")
       << QStringLiteral("{% load %}{{ booList|join2:amp }}") << dict
       << QString() << TagSyntaxError;
@@ -208,6 +247,62 @@ void TestScriptableTagsSyntax::testResolve_data()
       << QStringLiteral("Far - Bang") << NoError;
 }
 
+void TestScriptableTagsSyntax::testConcurrentRender()
+{
+  const auto content = QStringLiteral(
+      "{% load scripteddefaults %}{% if2 boo %}{{ boo|upper }}{% endif2 %} "
+      "{{ booList|join2:\", \" }}");
+  const auto expected = QStringLiteral("FAR Tom, Dick, Harry");
+
+  QVariantHash mapping;
+  mapping.insert(QStringLiteral("boo"), QStringLiteral("Far"));
+  mapping.insert(QStringLiteral("booList"),
+                 QVariantList{QStringLiteral("Tom"), QStringLiteral("Dick"),
+                              QStringLiteral("Harry")});
+
+  // The engine of another thread evaluates the scripts loaded so far and
+  // creates the nodes of templates parsed in that thread.
+  Template threadTemplate;
+  QString threadResult;
+  {
+    QThreadPool parsePool;
+    parsePool.start(new FunctionRunnable([&] {
+      threadTemplate
+          = m_engine->newTemplate(content, QStringLiteral("thread-template"));
+      Context c(mapping);
+      threadResult = threadTemplate->render(&c);
+    }));
+  }
+  QCOMPARE(threadTemplate->error(), NoError);
+  QCOMPARE(threadResult, expected);
+
+  // The thread which parsed the template has finished, and its engine with
+  // it. The nodes are created again in the engine of this thread.
+  {
+    Context c(mapping);
+    QCOMPARE(threadTemplate->render(&c), expected);
+  }
+
+  const auto mainTemplate
+      = m_engine->newTemplate(content, QStringLiteral("main-template"));
+  QCOMPARE(mainTemplate->error(), NoError);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  QVector<QString> results(32);
+  for (auto i = 0; i < results.size(); ++i) {
+    const auto t = i % 2 ? mainTemplate : threadTemplate;
+    pool.start(new FunctionRunnable([&results, &mapping, t, i] {
+      Context c(mapping);
+      results[i] = t->render(&c);
+    }));
+  }
+  pool.waitForDone();
+
+  for (const auto &result : qAsConst(results))
+    QCOMPARE(result, expected);
+}
+
 QTEST_MAIN(TestScriptableTagsSyntax)
 #include "testscriptabletags.moc"
 
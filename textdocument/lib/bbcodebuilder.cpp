@@ -19,12 +19,13 @@
 */
 
 #include "bbcodebuilder.h"
+#include "markupoutput_p.h"
 
 using namespace Grantlee;
 
 BBCodeBuilder::BBCodeBuilder() : m_currentAlignment(Qt::AlignLeft) {}
 
-BBCodeBuilder::~BBCodeBuilder() = default;
+BBCodeBuilder::~BBCodeBuilder() { MarkupOutputs::remove(this); }
 
 void BBCodeBuilder::beginStrong() { m_text.append(QStringLiteral("[B]")); }
 void BBCodeBuilder::endStrong() { m_text.append(QStringLiteral("[/B]")); }
@@ -89,6 +90,7 @@ void BBCodeBuilder::endParagraph()
     m_text.append(QLatin1Char('\n'));
   }
   m_currentAlignment = Qt::AlignLeft;
+  MarkupOutputs::write(this, &m_text, false);
 }
 
 void BBCodeBuilder::addNewline() { m_text.append(QLatin1Char('\n')); }
@@ -123,7 +125,11 @@ void BBCodeBuilder::beginList(QTextListFormat::Style type)
   }
 }
 
-void BBCodeBuilder::endList() { m_text.append(QStringLiteral("[/LIST]\n")); }
+void BBCodeBuilder::endList()
+{
+  m_text.append(QStringLiteral("[/LIST]\n"));
+  MarkupOutputs::write(this, &m_text, false);
+}
 
 void BBCodeBuilder::beginListItem() { m_text.append(QStringLiteral("[*] ")); }
 
@@ -166,7 +172,19 @@ const QString BBCodeBuilder::escape(const QString &s) const
 
 QString BBCodeBuilder::getResult()
 {
+  MarkupOutputs::write(this, &m_text, true);
   auto ret = m_text;
   m_text.clear();
   return ret;
 }
+
+void BBCodeBuilder::setOutputDevice(QIODevice *device)
+{
+  MarkupOutputs::setDevice(this, &m_text, device);
+}
+
+void BBCodeBuilder::setOutputFunction(
+    const std::function<void(const QString &)> &function)
+{
+  MarkupOutputs::setFunction(this, &m_text, function);
+}
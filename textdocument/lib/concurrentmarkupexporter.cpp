@@ -0,0 +1,239 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "concurrentmarkupexporter.h"
+
+#include "abstractmarkupbuilder.h"
+#include "markupdirector.h"
+#include "plaintextmarkupbuilder.h"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtGui/QTextDocument>
+#include <QtGui/QTextFrame>
+#include <QtGui/QTextTable>
+
+#include <typeinfo>
+
+namespace Grantlee
+{
+
+class ConcurrentMarkupExporterPrivate
+{
+public:
+  ConcurrentMarkupExporterPrivate(
+      const ConcurrentMarkupExporter::BuilderFactory &createBuilder,
+      const ConcurrentMarkupExporter::DirectorFactory &createDirector)
+      : m_createBuilder(createBuilder), m_createDirector(createDirector),
+        m_minimumPartLength(16384), m_partCount(0)
+  {
+  }
+
+  /**
+    A range of top level elements of the document, and the builder and
+    director which process it.
+  */
+  struct Part {
+    QTextFrame::iterator begin;
+    QTextFrame::iterator end;
+    AbstractMarkupBuilder *builder;
+    MarkupDirector *director;
+  };
+
+  static void prepare(QTextDocument *document);
+  static void process(const Part &part);
+
+  QVector<QTextFrame::iterator> bounds(QTextDocument *document, int parts);
+
+  const ConcurrentMarkupExporter::BuilderFactory m_createBuilder;
+  const ConcurrentMarkupExporter::DirectorFactory m_createDirector;
+  int m_minimumPartLength;
+  int m_partCount;
+};
+
+namespace
+{
+class PartRunnable : public QRunnable
+{
+public:
+  PartRunnable(const ConcurrentMarkupExporterPrivate::Part &part,
+               QSemaphore *done)
+      : m_part(part), m_done(done)
+  {
+  }
+
+  void run() override
+  {
+    ConcurrentMarkupExporterPrivate::process(m_part);
+    m_done->release();
+  }
+
+private:
+  const ConcurrentMarkupExporterPrivate::Part m_part;
+  QSemaphore *const m_done;
+};
+}
+}
+
+using namespace Grantlee;
+
+static void prepareFrame(QTextFrame *frame)
+{
+  if (const auto table = qobject_cast<QTextTable *>(frame))
+    table->rows();
+  for (const auto child : frame->childFrames())
+    prepareFrame(child);
+}
+
+void ConcurrentMarkupExporterPrivate::prepare(QTextDocument *document)
+{
+  // QTextDocument creates the cells of tables and the objects of formats
+  // when they are first used. They are created before the document is read
+  // on several threads.
+  prepareFrame(document->rootFrame());
+  for (auto block = document->begin(); block.isValid(); block = block.next()) {
+    document->objectForFormat(block.blockFormat());
+    for (auto it = block.begin(); !it.atEnd(); ++it) {
+      const auto format = it.fragment().charFormat();
+      if (format.objectIndex() != -1)
+        document->objectForFormat(format);
+    }
+  }
+}
+
+void ConcurrentMarkupExporterPrivate::process(const Part &part)
+{
+  auto it = part.begin;
+  while (!it.atEnd() && it != part.end)
+    it = part.director->processDocumentElement(it);
+}
+
+QVector<QTextFrame::iterator>
+ConcurrentMarkupExporterPrivate::bounds(QTextDocument *document, int parts)
+{
+  const auto root = document->rootFrame();
+  const qint64 length = document->characterCount();
+
+  QVector<QTextFrame::iterator> result;
+  result.append(root->begin());
+  for (auto it = root->begin(); !it.atEnd() && result.size() < parts; ++it) {
+    const auto frame = it.currentFrame();
+    const auto block = frame ? document->findBlock(frame->firstPosition())
+                             : it.currentBlock();
+    if (block.position() < length * result.size() / parts)
+      continue;
+
+    // A list is processed together with the blocks which follow it, so the
+    // document is not split next to one.
+    if (block.textList() || block.previous().textList())
+      continue;
+
+    result.append(it);
+  }
+  result.append(root->end());
+  return result;
+}
+
+ConcurrentMarkupExporter::ConcurrentMarkupExporter(
+    const BuilderFactory &createBuilder, const DirectorFactory &createDirector)
+    : d_ptr(new ConcurrentMarkupExporterPrivate(createBuilder, createDirector))
+{
+}
+
+ConcurrentMarkupExporter::~ConcurrentMarkupExporter() { delete d_ptr; }
+
+void ConcurrentMarkupExporter::setMinimumPartLength(int length)
+{
+  Q_D(ConcurrentMarkupExporter);
+  d->m_minimumPartLength = qMax(length, 1);
+}
+
+int ConcurrentMarkupExporter::minimumPartLength() const
+{
+  Q_D(const ConcurrentMarkupExporter);
+  return d->m_minimumPartLength;
+}
+
+QString ConcurrentMarkupExporter::markup(QTextDocument *document)
+{
+  Q_D(ConcurrentMarkupExporter);
+
+  const auto parts = qMin(QThread::idealThreadCount(),
+                          document->characterCount() / d->m_minimumPartLength);
+  if (parts >= 2)
+    d->prepare(document);
+  const auto bounds = d->bounds(document, qMax(parts, 1));
+
+  QVector<ConcurrentMarkupExporterPrivate::Part> partList;
+  for (auto i = 0; i + 1 < bounds.size(); ++i) {
+    const auto builder = d->m_createBuilder();
+    const auto director = d->m_createDirector ? d->m_createDirector(builder)
+                                              : new MarkupDirector(builder);
+    partList.append(ConcurrentMarkupExporterPrivate::Part{
+        bounds.at(i), bounds.at(i + 1), builder, director});
+  }
+  d->m_partCount = int(partList.size());
+
+  // The parts are processed on free threads of the global pool, or on this
+  // thread if there are none, so that the export never waits for a thread.
+  QSemaphore done;
+  for (auto i = 1; i < partList.size(); ++i) {
+    auto runnable = new PartRunnable(partList.at(i), &done);
+    if (!QThreadPool::globalInstance()->tryStart(runnable)) {
+      runnable->run();
+      delete runnable;
+    }
+  }
+  ConcurrentMarkupExporterPrivate::process(partList.first());
+  done.acquire(int(partList.size()) - 1);
+
+  // The references of PlainTextMarkupBuilders are numbered again for the
+  // whole document. Subclasses may reimplement getResult, so their markup
+  // is joined as it is.
+  QVector<PlainTextMarkupBuilder *> plainTextBuilders;
+  for (const auto &part : qAsConst(partList)) {
+    if (typeid(*part.builder) == typeid(PlainTextMarkupBuilder))
+      plainTextBuilders.append(
+          static_cast<PlainTextMarkupBuilder *>(part.builder));
+  }
+
+  QString result;
+  if (plainTextBuilders.size() == partList.size()) {
+    result = PlainTextMarkupBuilder::mergeResults(plainTextBuilders);
+  } else {
+    for (const auto &part : qAsConst(partList))
+      result.append(part.builder->getResult());
+  }
+
+  for (const auto &part : qAsConst(partList)) {
+    delete part.director;
+    delete part.builder;
+  }
+  return result;
+}
+
+int ConcurrentMarkupExporter::lastPartCount() const
+{
+  Q_D(const ConcurrentMarkupExporter);
+  return d->m_partCount;
+}
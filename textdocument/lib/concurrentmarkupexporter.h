@@ -0,0 +1,137 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_CONCURRENTMARKUPEXPORTER_H
+#define GRANTLEE_CONCURRENTMARKUPEXPORTER_H
+
+#include "grantlee_textdocument_export.h"
+
+#include <QtCore/QString>
+
+#include <functional>
+
+class QTextDocument;
+
+namespace Grantlee
+{
+
+class AbstractMarkupBuilder;
+class MarkupDirector;
+
+class ConcurrentMarkupExporterPrivate;
+
+/// @headerfile concurrentmarkupexporter.h grantlee/concurrentmarkupexporter.h
+
+/**
+  @brief Creates the markup of a large QTextDocument on several threads.
+
+  The **%ConcurrentMarkupExporter** splits a document into parts at top level
+  blocks and frames which are not next to a list. Each part is processed by
+  its own builder and director on a thread of the global QThreadPool, and
+  their markup is joined in document order.
+
+  @code
+    ConcurrentMarkupExporter exporter([] { return new TextHTMLBuilder(); });
+    browser->setHtml(exporter.markup(textEdit->document()));
+  @endcode
+
+  The result is the same as that of MarkupDirector::processDocument, as
+  long as the markup of each part depends only on that part. The references
+  of a PlainTextMarkupBuilder are numbered again for the whole document when
+  the parts are joined. The markup of builders of other types, including
+  subclasses of PlainTextMarkupBuilder, is joined as getResult returns it.
+
+  The builders and directors are created on the calling thread, and used on
+  one other thread each. The document is read on several threads while
+  markup runs, so it must not be changed meanwhile, and the directors must
+  not change it either. Documents shorter than twice the
+  @ref minimumPartLength are processed on the calling thread.
+
+  QTextDocument is not thread-safe for anything but reading its blocks,
+  fragments, frames and formats. A director created by a custom
+  DirectorFactory must not create a QTextCursor or use the layout of the
+  document. A director which needs them can be used with
+  MarkupDirector::processDocument on a QTextDocument::clone of the document
+  instead.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEXTDOCUMENT_EXPORT ConcurrentMarkupExporter
+{
+public:
+  /**
+    Creates a builder for a part of the document.
+  */
+  typedef std::function<AbstractMarkupBuilder *()> BuilderFactory;
+
+  /**
+    Creates a director which directs the @p builder. The director runs on
+    a thread of the pool, so it must not create a QTextCursor or use the
+    layout of the document.
+  */
+  typedef std::function<MarkupDirector *(AbstractMarkupBuilder *builder)>
+      DirectorFactory;
+
+  /**
+    Creates an exporter which uses builders created by @p createBuilder, and
+    directors created by @p createDirector. A MarkupDirector is used if no
+    @p createDirector is given. The exporter deletes the builders and
+    directors when it is done with them.
+  */
+  explicit ConcurrentMarkupExporter(
+      const BuilderFactory &createBuilder,
+      const DirectorFactory &createDirector = DirectorFactory());
+
+  /**
+    Destructor
+  */
+  ~ConcurrentMarkupExporter();
+
+  /**
+    Sets the number of characters below which a part of the document is not
+    split further. The default is 16384.
+  */
+  void setMinimumPartLength(int length);
+
+  /**
+    Returns the number of characters below which a part of the document is
+    not split further.
+  */
+  int minimumPartLength() const;
+
+  /**
+    Returns the markup of the @p document.
+  */
+  QString markup(QTextDocument *document);
+
+  /**
+    Returns the number of parts the document was processed in by the last
+    call to markup.
+  */
+  int lastPartCount() const;
+
+private:
+  Q_DISABLE_COPY(ConcurrentMarkupExporter)
+  Q_DECLARE_PRIVATE(ConcurrentMarkupExporter)
+  ConcurrentMarkupExporterPrivate *const d_ptr;
+};
+}
+
+#endif
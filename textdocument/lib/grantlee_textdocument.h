@@ -23,6 +23,8 @@
 
 #include "grantlee/abstractmarkupbuilder.h"
 #include "grantlee/bbcodebuilder.h"
+#include "grantlee/concurrentmarkupexporter.h"
+#include "grantlee/incrementalmarkupexporter.h"
 #include "grantlee/markupdirector.h"
 #include "grantlee/mediawikimarkupbuilder.h"
 #include "grantlee/plaintextmarkupbuilder.h"
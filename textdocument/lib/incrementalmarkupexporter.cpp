@@ -0,0 +1,246 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "incrementalmarkupexporter.h"
+
+#include "abstractmarkupbuilder.h"
+#include "markupdirector.h"
+#include "plaintextmarkupbuilder.h"
+
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+#include <QtGui/QTextDocument>
+#include <QtGui/QTextFrame>
+
+#include <algorithm>
+
+namespace Grantlee
+{
+
+class IncrementalMarkupExporterPrivate
+{
+public:
+  IncrementalMarkupExporterPrivate(IncrementalMarkupExporter *exporter,
+                                   QTextDocument *document,
+                                   MarkupDirector *director,
+                                   AbstractMarkupBuilder *builder)
+      : q_ptr(exporter), m_document(document), m_director(director),
+        m_builder(builder),
+        m_splittable(!dynamic_cast<PlainTextMarkupBuilder *>(builder)),
+        m_valid(false), m_changed(true), m_processed(0)
+  {
+  }
+
+  /**
+    The markup of a top level element of the document. An element is a
+    block, a list, a frame or a table.
+  */
+  struct Element {
+    // The position of the first block of the element, or of the first
+    // position in the frame.
+    int position;
+    bool dirty;
+    QString markup;
+  };
+
+  static int position(const QTextFrame::iterator &it);
+
+  void contentsChange(int position, int charsRemoved, int charsAdded);
+  QString process(QTextFrame::iterator *it);
+  void update();
+  void updateAll();
+
+  Q_DECLARE_PUBLIC(IncrementalMarkupExporter)
+  IncrementalMarkupExporter *const q_ptr;
+
+  QPointer<QTextDocument> m_document;
+  MarkupDirector *const m_director;
+  AbstractMarkupBuilder *const m_builder;
+  // Whether the markup of an element depends only on that element. A
+  // PlainTextMarkupBuilder numbers the references of the whole document.
+  const bool m_splittable;
+
+  // The elements in document order. Their positions are ascending, and
+  // those of clean elements are up to date.
+  QVector<Element> m_elements;
+  bool m_valid;
+  bool m_changed;
+  QString m_markup;
+  int m_processed;
+};
+}
+
+using namespace Grantlee;
+
+int IncrementalMarkupExporterPrivate::position(const QTextFrame::iterator &it)
+{
+  if (const auto frame = it.currentFrame())
+    return frame->firstPosition();
+  return it.currentBlock().position();
+}
+
+void IncrementalMarkupExporterPrivate::contentsChange(int position,
+                                                      int charsRemoved,
+                                                      int charsAdded)
+{
+  m_changed = true;
+  if (m_elements.isEmpty())
+    return;
+
+  const auto end = position + charsRemoved;
+  const auto byPosition = [](int pos, const Element &element) {
+    return pos < element.position;
+  };
+
+  // The elements which contain the start and the end of the change.
+  const auto first = int(std::upper_bound(m_elements.begin(), m_elements.end(),
+                                          position, byPosition)
+                         - m_elements.begin());
+  const auto last = int(std::upper_bound(m_elements.begin() + first,
+                                         m_elements.end(), end, byPosition)
+                        - m_elements.begin());
+
+  // A change may join an element with its neighbours, such as two lists
+  // which were separated by a removed block, or split it.
+  const auto dirtyBegin = std::max(first - 2, 0);
+  const auto dirtyEnd = std::min(last + 1, int(m_elements.size()));
+  for (auto i = dirtyBegin; i < dirtyEnd; ++i)
+    m_elements[i].dirty = true;
+
+  // Elements which started in the removed text start at the change now.
+  const auto delta = charsAdded - charsRemoved;
+  for (auto i = first; i < m_elements.size(); ++i) {
+    auto &element = m_elements[i];
+    element.position
+        = element.position <= end ? position : element.position + delta;
+  }
+}
+
+QString IncrementalMarkupExporterPrivate::process(QTextFrame::iterator *it)
+{
+  *it = m_director->processDocumentElement(*it);
+  ++m_processed;
+  return m_builder->getResult();
+}
+
+void IncrementalMarkupExporterPrivate::updateAll()
+{
+  m_processed = 0;
+  auto it = m_document->rootFrame()->begin();
+  while (!it.atEnd()) {
+    it = m_director->processDocumentElement(it);
+    ++m_processed;
+  }
+  m_markup = m_builder->getResult();
+}
+
+void IncrementalMarkupExporterPrivate::update()
+{
+  m_processed = 0;
+
+  QVector<Element> elements;
+  elements.reserve(m_elements.size());
+
+  const auto size = m_valid ? int(m_elements.size()) : 0;
+  auto i = 0;
+  auto it = m_document->rootFrame()->begin();
+  while (!it.atEnd()) {
+    const auto pos = position(it);
+
+    // Elements before the current one were joined with the previous one.
+    while (i < size && m_elements.at(i).position < pos)
+      ++i;
+
+    if (i < size && m_elements.at(i).position == pos
+        && !m_elements.at(i).dirty) {
+      // Step over the blocks of the unchanged element.
+      elements.append(m_elements.at(i));
+      ++i;
+      const auto next = i < size ? m_elements.at(i).position : -1;
+      do {
+        ++it;
+      } while (!it.atEnd() && (next < 0 || position(it) < next));
+      continue;
+    }
+
+    elements.append(Element{pos, false, process(&it)});
+  }
+
+  m_elements = elements;
+  m_valid = true;
+}
+
+IncrementalMarkupExporter::IncrementalMarkupExporter(
+    QTextDocument *document, MarkupDirector *director,
+    AbstractMarkupBuilder *builder, QObject *parent)
+    : QObject(parent), d_ptr(new IncrementalMarkupExporterPrivate(
+                           this, document, director, builder))
+{
+  connect(document, &QTextDocument::contentsChange, this,
+          [this](int position, int charsRemoved, int charsAdded) {
+            Q_D(IncrementalMarkupExporter);
+            d->contentsChange(position, charsRemoved, charsAdded);
+          });
+}
+
+IncrementalMarkupExporter::~IncrementalMarkupExporter() { delete d_ptr; }
+
+QString IncrementalMarkupExporter::markup()
+{
+  Q_D(IncrementalMarkupExporter);
+  if (!d->m_document)
+    return {};
+  if (!d->m_changed) {
+    d->m_processed = 0;
+    return d->m_markup;
+  }
+
+  if (!d->m_splittable) {
+    d->updateAll();
+    d->m_changed = false;
+    return d->m_markup;
+  }
+
+  d->update();
+
+  auto length = 0;
+  for (const auto &element : qAsConst(d->m_elements))
+    length += element.markup.size();
+  d->m_markup.clear();
+  d->m_markup.reserve(length);
+  for (const auto &element : qAsConst(d->m_elements))
+    d->m_markup.append(element.markup);
+  d->m_changed = false;
+  return d->m_markup;
+}
+
+void IncrementalMarkupExporter::invalidate()
+{
+  Q_D(IncrementalMarkupExporter);
+  d->m_elements.clear();
+  d->m_valid = false;
+  d->m_changed = true;
+}
+
+int IncrementalMarkupExporter::lastProcessedCount() const
+{
+  Q_D(const IncrementalMarkupExporter);
+  return d->m_processed;
+}
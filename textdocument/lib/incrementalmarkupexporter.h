@@ -0,0 +1,114 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_INCREMENTALMARKUPEXPORTER_H
+#define GRANTLEE_INCREMENTALMARKUPEXPORTER_H
+
+#include "grantlee_textdocument_export.h"
+
+#include <QtCore/QObject>
+
+class QTextDocument;
+
+namespace Grantlee
+{
+
+class AbstractMarkupBuilder;
+class MarkupDirector;
+
+class IncrementalMarkupExporterPrivate;
+
+/// @headerfile incrementalmarkupexporter.h grantlee/incrementalmarkupexporter.h
+
+/**
+  @brief Keeps the markup of a QTextDocument up to date while it is edited.
+
+  The **%IncrementalMarkupExporter** caches the markup created for each top
+  level block, list, frame and table of a document. When the document
+  changes, only the elements touched by the change and their neighbours are
+  processed again, so that a preview can be refreshed after each keystroke
+  without processing the whole document.
+
+  @code
+    auto builder = new TextHTMLBuilder();
+    auto director = new MarkupDirector(builder);
+    auto exporter = new IncrementalMarkupExporter(textEdit->document(),
+                                                  director, builder, this);
+
+    connect(textEdit, &QTextEdit::textChanged, this, [=] {
+      browser->setHtml(exporter->markup());
+    });
+  @endcode
+
+  The result is the same as that of MarkupDirector::processDocument, as
+  long as the markup of each top level element depends only on that element.
+  That is the case for TextHTMLBuilder, but not for PlainTextMarkupBuilder,
+  which numbers the links of the whole document. The markup of a
+  PlainTextMarkupBuilder is therefore not split into elements: the whole
+  document is processed again after each change.
+
+  The elements are processed with MarkupDirector::processDocumentElement. A
+  reimplementation of MarkupDirector::processDocument is not used.
+
+  @author Stephen Kelly <steveire@gmail.com>
+*/
+class GRANTLEE_TEXTDOCUMENT_EXPORT IncrementalMarkupExporter : public QObject
+{
+  Q_OBJECT
+public:
+  /**
+    Creates an exporter for @p document which creates the markup with the
+    @p director, which directs the @p builder.
+  */
+  IncrementalMarkupExporter(QTextDocument *document, MarkupDirector *director,
+                            AbstractMarkupBuilder *builder,
+                            QObject *parent = {});
+
+  /**
+    Destructor
+  */
+  ~IncrementalMarkupExporter() override;
+
+  /**
+    Returns the markup of the document, processing the elements which
+    changed since the last call.
+  */
+  QString markup();
+
+  /**
+    Discards the cached markup, so that the next call to markup processes
+    the whole document. This is needed if the director or builder is
+    configured differently.
+  */
+  void invalidate();
+
+  /**
+    Returns the number of top level elements which were processed by the
+    last call to markup.
+  */
+  int lastProcessedCount() const;
+
+private:
+  Q_DECLARE_PRIVATE(IncrementalMarkupExporter)
+  IncrementalMarkupExporterPrivate *const d_ptr;
+};
+}
+
+#endif
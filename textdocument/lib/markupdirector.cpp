@@ -49,21 +49,24 @@ MarkupDirector::~MarkupDirector() { delete d_ptr; }
 void MarkupDirector::processDocumentContents(QTextFrame::iterator start,
                                              QTextFrame::iterator end)
 {
-  while (!start.atEnd() && start != end) {
-    auto frame = start.currentFrame();
-    if (frame) {
-      auto table = qobject_cast<QTextTable *>(frame);
-      if (table) {
-        start = processTable(start, table);
-      } else {
-        start = processFrame(start, frame);
-      }
-    } else {
-      auto block = start.currentBlock();
-      Q_ASSERT(block.isValid());
-      start = processBlock(start, block);
+  while (!start.atEnd() && start != end)
+    start = processDocumentElement(start);
+}
+
+QTextFrame::iterator
+MarkupDirector::processDocumentElement(QTextFrame::iterator it)
+{
+  auto frame = it.currentFrame();
+  if (frame) {
+    auto table = qobject_cast<QTextTable *>(frame);
+    if (table) {
+      return processTable(it, table);
     }
+    return processFrame(it, frame);
   }
+  auto block = it.currentBlock();
+  Q_ASSERT(block.isValid());
+  return processBlock(it, block);
 }
 
 QTextFrame::iterator MarkupDirector::processFrame(QTextFrame::iterator it,
@@ -81,6 +81,20 @@ class MarkupDirectorPrivate;
     browser->setPlainText(builder->getResult());
   @endcode
 
+  Large documents can be written to a QIODevice while they are processed,
+  so that the whole markup is not held in memory:
+
+  @code
+    QFile file("export.html");
+    file.open(QIODevice::WriteOnly);
+
+    TextHTMLBuilder builder;
+    builder.setOutputDevice(&file);
+    MarkupDirector md(&builder);
+    md.processDocument(doc);
+    builder.getResult(); // Writes the rest of the markup.
+  @endcode
+
   The behaviour of the **%MarkupDirector** can be customized by subclassing.
   Support for custom types can also be added by implementing the @ref
   processCustomFragment method.
@@ -218,6 +232,13 @@ public:
   virtual void processTableCell(const QTextTableCell &tableCell,
                                 QTextTable *table);
 
+  /**
+    Directs the builder to create output for the block, list, frame or table
+    at @p it, and returns the iterator after it. This is the step which
+    processDocumentContents repeats for each element of a frame.
+  */
+  QTextFrame::iterator processDocumentElement(QTextFrame::iterator it);
+
 protected:
   /**
     Processes the document between @p begin and @p end
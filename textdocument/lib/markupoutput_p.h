@@ -0,0 +1,239 @@
+/*
+  This file is part of the Grantlee template system.
+
+  Copyright (c) 2020 Stephen Kelly <steveire@gmail.com>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version
+  2.1 of the Licence, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRANTLEE_MARKUPOUTPUT_P_H
+#define GRANTLEE_MARKUPOUTPUT_P_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QIODevice>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <functional>
+
+//@cond PRIVATE
+
+namespace Grantlee
+{
+
+/**
+  @internal
+  The output of a markup builder.
+
+  The output is kept until it is taken with takeText, unless a device or a
+  callback is set. It is then written in chunks while it is built, so that
+  only one chunk is held in memory.
+*/
+class MarkupOutput
+{
+public:
+  typedef std::function<void(const QString &chunk)> ChunkFunction;
+
+  MarkupOutput() : m_device(nullptr) {}
+
+  /**
+    Writes the output to @p device, encoded as UTF-8.
+  */
+  void setDevice(QIODevice *device)
+  {
+    flush();
+    m_device = device;
+    m_function = nullptr;
+  }
+
+  /**
+    Passes the output to @p function in chunks.
+  */
+  void setFunction(const ChunkFunction &function)
+  {
+    flush();
+    m_device = nullptr;
+    m_function = function;
+  }
+
+  void append(const QString &text)
+  {
+    m_text.append(text);
+    if (isStreaming() && m_text.size() >= ChunkSize)
+      writeChunk();
+  }
+
+  void append(QChar c)
+  {
+    m_text.append(c);
+    if (isStreaming() && m_text.size() >= ChunkSize)
+      writeChunk();
+  }
+
+  bool isStreaming() const { return m_device || m_function; }
+
+  /**
+    Returns the number of characters which are kept.
+  */
+  int size() const { return int(m_text.size()); }
+
+  /**
+    Returns the output which was not written yet, which is all of it if no
+    device or callback is set.
+  */
+  QString takeText()
+  {
+    flush();
+    const auto text = m_text;
+    m_text.clear();
+    return text;
+  }
+
+  /**
+    Writes all of the output which is kept, if a device or callback is set.
+  */
+  void flush()
+  {
+    if (isStreaming() && !m_text.isEmpty())
+      write(int(m_text.size()));
+  }
+
+private:
+  Q_DISABLE_COPY(MarkupOutput)
+
+  // The number of characters written at once.
+  enum { ChunkSize = 16384 };
+
+  void writeChunk()
+  {
+    // A surrogate pair is written in one chunk, so that each chunk can be
+    // encoded on its own.
+    auto size = int(m_text.size());
+    if (m_text.at(size - 1).isHighSurrogate())
+      --size;
+    write(size);
+  }
+
+  void write(int size)
+  {
+    if (m_device)
+      m_device->write(m_text.left(size).toUtf8());
+    else
+      m_function(m_text.left(size));
+    // Keep the capacity for the next chunk.
+    m_text.remove(0, size);
+  }
+
+  QString m_text;
+  QIODevice *m_device;
+  ChunkFunction m_function;
+};
+
+/**
+  @internal
+  The outputs of builders which have no private class to keep a
+  MarkupOutput in, so that their size does not change.
+
+  Such a builder keeps its markup in a QString. While it streams, the
+  markup is passed to its output at the end of each paragraph and list.
+  An output is only created for a builder which is set to stream.
+*/
+class MarkupOutputs
+{
+public:
+  static void setDevice(const void *builder, QString *text, QIODevice *device)
+  {
+    write(builder, text, true);
+    output(builder)->setDevice(device);
+  }
+
+  static void setFunction(const void *builder, QString *text,
+                          const MarkupOutput::ChunkFunction &function)
+  {
+    write(builder, text, true);
+    output(builder)->setFunction(function);
+  }
+
+  /**
+    Passes @p text to the output of @p builder and clears it, if the
+    builder streams. The output is flushed if @p flush is true.
+  */
+  static void write(const void *builder, QString *text, bool flush)
+  {
+    auto &outputs = instance();
+    if (outputs.m_count.loadAcquire() == 0)
+      return;
+
+    MarkupOutput *output;
+    {
+      QMutexLocker locker(&outputs.m_mutex);
+      output = outputs.m_outputs.value(builder);
+    }
+    if (!output || !output->isStreaming())
+      return;
+
+    output->append(*text);
+    text->clear();
+    if (flush)
+      output->flush();
+  }
+
+  /**
+    Deletes the output of @p builder.
+  */
+  static void remove(const void *builder)
+  {
+    auto &outputs = instance();
+    if (outputs.m_count.loadAcquire() == 0)
+      return;
+
+    QMutexLocker locker(&outputs.m_mutex);
+    if (const auto output = outputs.m_outputs.take(builder)) {
+      outputs.m_count.deref();
+      delete output;
+    }
+  }
+
+private:
+  static MarkupOutputs &instance()
+  {
+    static MarkupOutputs outputs;
+    return outputs;
+  }
+
+  static MarkupOutput *output(const void *builder)
+  {
+    auto &outputs = instance();
+    QMutexLocker locker(&outputs.m_mutex);
+    auto &output = outputs.m_outputs[builder];
+    if (!output) {
+      output = new MarkupOutput;
+      outputs.m_count.ref();
+    }
+    return output;
+  }
+
+  QMutex m_mutex;
+  QHash<const void *, MarkupOutput *> m_outputs;
+  // The number of outputs, so that builders which do not stream do not
+  // need to lock the mutex.
+  QAtomicInt m_count;
+};
+}
+
+//@endcond
+
+#endif
@@ -19,12 +19,16 @@
 */
 
 #include "mediawikimarkupbuilder.h"
+#include "markupoutput_p.h"
 
 using namespace Grantlee;
 
 MediaWikiMarkupBuilder::MediaWikiMarkupBuilder() = default;
 
-MediaWikiMarkupBuilder::~MediaWikiMarkupBuilder() = default;
+MediaWikiMarkupBuilder::~MediaWikiMarkupBuilder()
+{
+  MarkupOutputs::remove(this);
+}
 
 void MediaWikiMarkupBuilder::beginStrong()
 {
@@ -59,6 +63,7 @@ void MediaWikiMarkupBuilder::endStrikeout()
 void MediaWikiMarkupBuilder::endParagraph()
 {
   m_text.append(QLatin1Char('\n'));
+  MarkupOutputs::write(this, &m_text, false);
 }
 void MediaWikiMarkupBuilder::addNewline() { m_text.append(QLatin1Char('\n')); }
 
@@ -143,6 +148,7 @@ void MediaWikiMarkupBuilder::endList()
 {
   m_text.append(QLatin1Char('\n'));
   currentListItemStyles.removeLast();
+  MarkupOutputs::write(this, &m_text, false);
 }
 
 void MediaWikiMarkupBuilder::beginListItem()
@@ -182,7 +188,19 @@ const QString MediaWikiMarkupBuilder::escape(const QString &s)
 
 QString MediaWikiMarkupBuilder::getResult()
 {
+  MarkupOutputs::write(this, &m_text, true);
   auto ret = m_text;
   m_text.clear();
   return ret;
 }
+
+void MediaWikiMarkupBuilder::setOutputDevice(QIODevice *device)
+{
+  MarkupOutputs::setDevice(this, &m_text, device);
+}
+
+void MediaWikiMarkupBuilder::setOutputFunction(
+    const std::function<void(const QString &)> &function)
+{
+  MarkupOutputs::setFunction(this, &m_text, function);
+}
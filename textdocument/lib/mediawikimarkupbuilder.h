@@ -23,6 +23,10 @@
 
 #include "abstractmarkupbuilder.h"
 
+#include <functional>
+
+class QIODevice;
+
 namespace Grantlee
 {
 
@@ -69,6 +73,19 @@ public:
 
   QString getResult() override;
 
+  /**
+    Writes the markup to @p device while it is built, encoded as UTF-8.
+    getResult then writes the rest of the markup and returns an empty
+    string.
+  */
+  void setOutputDevice(QIODevice *device);
+
+  /**
+    Passes the markup to @p function in chunks while it is built. getResult
+    then passes the rest of the markup and returns an empty string.
+  */
+  void setOutputFunction(const std::function<void(const QString &)> &function);
+
 private:
   QList<QTextListFormat::Style> currentListItemStyles;
 
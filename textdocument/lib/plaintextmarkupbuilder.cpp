@@ -19,6 +19,10 @@
 */
 
 #include "plaintextmarkupbuilder.h"
+#include "markupoutput_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
 
 namespace Grantlee
 {
@@ -45,15 +49,24 @@ public:
     Gets a block of references in the body of the text.
     This is an ordered list of links and images in the text.
   */
-  QString getReferences();
+  static QString getReferences(const QStringList &urls);
+
+  /**
+    Appends the number of a reference to the text.
+  */
+  void appendReference(int number);
 
   QStringList m_urls;
+  // The positions in the kept text of the reference numbers, and the
+  // numbers. They are used to number the references again when the markup
+  // of several builders is merged.
+  QVector<QPair<int, int>> m_referenceMarkers;
   QList<QTextListFormat::Style> currentListItemStyles;
   QList<int> currentListItemNumbers;
 
   QString activeLink;
 
-  QString m_text;
+  MarkupOutput m_text;
 
   PlainTextMarkupBuilder *q_ptr;
 
@@ -126,21 +139,27 @@ QString PlainTextMarkupBuilderPrivate::getLetterString(int itemNumber)
   return letterString;
 }
 
-QString PlainTextMarkupBuilderPrivate::getReferences()
+QString PlainTextMarkupBuilderPrivate::getReferences(const QStringList &urls)
 {
   QString refs;
-  if (!m_urls.isEmpty()) {
+  if (!urls.isEmpty()) {
     refs.append(QStringLiteral("\n--------\n"));
 
     auto index = 1;
-    while (!m_urls.isEmpty()) {
-      refs.append(
-          QStringLiteral("[%1] %2\n").arg(index++).arg(m_urls.takeFirst()));
+    for (const auto &url : urls) {
+      refs.append(QStringLiteral("[%1] %2\n").arg(index++).arg(url));
     }
   }
   return refs;
 }
 
+void PlainTextMarkupBuilderPrivate::appendReference(int number)
+{
+  if (number > 0 && !m_text.isStreaming())
+    m_referenceMarkers.append(qMakePair(m_text.size(), number));
+  m_text.append(QStringLiteral("[%1]").arg(number));
+}
+
 PlainTextMarkupBuilder::PlainTextMarkupBuilder()
     : d_ptr(new PlainTextMarkupBuilderPrivate(this))
 {
@@ -211,8 +230,7 @@ void PlainTextMarkupBuilder::beginAnchor(const QString &href,
 void PlainTextMarkupBuilder::endAnchor()
 {
   Q_D(PlainTextMarkupBuilder);
-  d->m_text.append(
-      QStringLiteral("[%1]").arg(d->m_urls.indexOf(d->activeLink) + 1));
+  d->appendReference(d->m_urls.indexOf(d->activeLink) + 1);
 }
 
 void PlainTextMarkupBuilder::endParagraph()
@@ -251,9 +269,7 @@ void PlainTextMarkupBuilder::insertImage(const QString &src, qreal width,
   Q_UNUSED(width)
   Q_UNUSED(height)
 
-  auto ref = addReference(src);
-
-  d->m_text.append(QStringLiteral("[%1]").arg(ref));
+  d->appendReference(addReference(src));
 }
 
 void PlainTextMarkupBuilder::beginList(QTextListFormat::Style style)
@@ -361,10 +377,58 @@ void PlainTextMarkupBuilder::appendRawText(const QString &text)
 QString PlainTextMarkupBuilder::getResult()
 {
   Q_D(PlainTextMarkupBuilder);
-  auto ret = d->m_text;
-  ret.append(d->getReferences());
-  d->m_text.clear();
-  return ret;
+  d->m_text.append(d->getReferences(d->m_urls));
+  d->m_urls.clear();
+  d->m_referenceMarkers.clear();
+  return d->m_text.takeText();
+}
+
+QString PlainTextMarkupBuilder::mergeResults(
+    const QVector<PlainTextMarkupBuilder *> &builders)
+{
+  // The references are numbered in the order they were first added to any
+  // of the builders.
+  QStringList urls;
+  QHash<QString, int> numbers;
+  for (const auto builder : builders) {
+    for (const auto &url : qAsConst(builder->d_func()->m_urls)) {
+      if (!numbers.contains(url)) {
+        urls.append(url);
+        numbers.insert(url, int(urls.size()));
+      }
+    }
+  }
+
+  QString result;
+  for (const auto builder : builders) {
+    const auto d = builder->d_func();
+    const auto text = d->m_text.takeText();
+    auto position = 0;
+    for (const auto &marker : qAsConst(d->m_referenceMarkers)) {
+      const auto url = d->m_urls.at(marker.second - 1);
+      result.append(text.mid(position, marker.first - position));
+      result.append(QStringLiteral("[%1]").arg(numbers.value(url)));
+      position = marker.first + QString::number(marker.second).size() + 2;
+    }
+    result.append(text.mid(position));
+    d->m_urls.clear();
+    d->m_referenceMarkers.clear();
+  }
+  result.append(PlainTextMarkupBuilderPrivate::getReferences(urls));
+  return result;
+}
+
+void PlainTextMarkupBuilder::setOutputDevice(QIODevice *device)
+{
+  Q_D(PlainTextMarkupBuilder);
+  d->m_text.setDevice(device);
+}
+
+void PlainTextMarkupBuilder::setOutputFunction(
+    const std::function<void(const QString &)> &function)
+{
+  Q_D(PlainTextMarkupBuilder);
+  d->m_text.setFunction(function);
 }
 
 void PlainTextMarkupBuilder::beginBackground(const QBrush &brush)
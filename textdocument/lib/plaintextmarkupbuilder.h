@@ -32,7 +32,12 @@
 #include "grantlee_textdocument_export.h"
 #include "markupdirector.h"
 
+#include <QtCore/QVector>
+
+#include <functional>
+
 class QBrush;
+class QIODevice;
 
 namespace Grantlee
 {
@@ -202,6 +207,31 @@ public:
   */
   QString getResult() override;
 
+  /**
+    Returns the markup of the @p builders, which processed consecutive parts
+    of a document, as getResult would return it if one builder had processed
+    the whole document. The references are numbered again and listed once at
+    the end.
+
+    This is used by ConcurrentMarkupExporter. The @p builders must not write
+    their markup to a device or a function.
+  */
+  static QString
+  mergeResults(const QVector<PlainTextMarkupBuilder *> &builders);
+
+  /**
+    Writes the markup to @p device while it is built, encoded as UTF-8.
+    getResult then writes the rest of the markup and returns an empty
+    string.
+  */
+  void setOutputDevice(QIODevice *device);
+
+  /**
+    Passes the markup to @p function in chunks while it is built. getResult
+    then passes the rest of the markup and returns an empty string.
+  */
+  void setOutputFunction(const std::function<void(const QString &)> &function);
+
 private:
   PlainTextMarkupBuilderPrivate *const d_ptr;
   Q_DECLARE_PRIVATE(PlainTextMarkupBuilder)
@@ -19,6 +19,7 @@
 */
 
 #include "texthtmlbuilder.h"
+#include "markupoutput_p.h"
 
 #include <QtCore/QList>
 #include <QtGui/QTextDocument>
@@ -32,7 +33,7 @@ public:
   TextHTMLBuilderPrivate(TextHTMLBuilder *b) : q_ptr(b) {}
 
   QList<QTextListFormat::Style> currentListItemStyles;
-  QString m_text;
+  MarkupOutput m_text;
 
   TextHTMLBuilder *q_ptr;
 
@@ -101,8 +102,8 @@ void TextHTMLBuilder::endStrikeout()
 void TextHTMLBuilder::beginForeground(const QBrush &brush)
 {
   Q_D(TextHTMLBuilder);
-  d->m_text.append(
-      QStringLiteral("<span style=\"color:%1;\">").arg(brush.color().name()));
+  d->m_text.append(QStringLiteral("<span style=\"color:") + brush.color().name()
+                   + QStringLiteral(";\">"));
 }
 
 void TextHTMLBuilder::endForeground()
@@ -114,8 +115,8 @@ void TextHTMLBuilder::endForeground()
 void TextHTMLBuilder::beginBackground(const QBrush &brush)
 {
   Q_D(TextHTMLBuilder);
-  d->m_text.append(QStringLiteral("<span style=\"background-color:%1;\">")
-                       .arg(brush.color().name()));
+  d->m_text.append(QStringLiteral("<span style=\"background-color:")
+                   + brush.color().name() + QStringLiteral(";\">"));
 }
 
 void TextHTMLBuilder::endBackground()
@@ -129,14 +130,17 @@ void TextHTMLBuilder::beginAnchor(const QString &href, const QString &name)
   Q_D(TextHTMLBuilder);
   if (!href.isEmpty()) {
     if (!name.isEmpty()) {
-      d->m_text.append(
-          QStringLiteral("<a href=\"%1\" name=\"%2\">").arg(href, name));
+      d->m_text.append(QStringLiteral("<a href=\"") + href
+                       + QStringLiteral("\" name=\"") + name
+                       + QStringLiteral("\">"));
     } else {
-      d->m_text.append(QStringLiteral("<a href=\"%1\">").arg(href));
+      d->m_text.append(QStringLiteral("<a href=\"") + href
+                       + QStringLiteral("\">"));
     }
   } else {
     if (!name.isEmpty()) {
-      d->m_text.append(QStringLiteral("<a name=\"%1\">").arg(name));
+      d->m_text.append(QStringLiteral("<a name=\"") + name
+                       + QStringLiteral("\">"));
     }
   }
 }
@@ -150,8 +154,8 @@ void TextHTMLBuilder::endAnchor()
 void TextHTMLBuilder::beginFontFamily(const QString &family)
 {
   Q_D(TextHTMLBuilder);
-  d->m_text.append(
-      QStringLiteral("<span style=\"font-family:%1;\">").arg(family));
+  d->m_text.append(QStringLiteral("<span style=\"font-family:") + family
+                   + QStringLiteral(";\">"));
 }
 
 void TextHTMLBuilder::endFontFamily()
@@ -163,8 +167,8 @@ void TextHTMLBuilder::endFontFamily()
 void TextHTMLBuilder::beginFontPointSize(int size)
 {
   Q_D(TextHTMLBuilder);
-  d->m_text.append(QStringLiteral("<span style=\"font-size:%1pt;\">")
-                       .arg(QString::number(size)));
+  d->m_text.append(QStringLiteral("<span style=\"font-size:")
+                   + QString::number(size) + QStringLiteral("pt;\">"));
 }
 
 void TextHTMLBuilder::endFontPointSize()
@@ -473,7 +477,18 @@ void TextHTMLBuilder::appendRawText(const QString &text)
 QString TextHTMLBuilder::getResult()
 {
   Q_D(TextHTMLBuilder);
-  auto ret = d->m_text;
-  d->m_text.clear();
-  return ret;
+  return d->m_text.takeText();
+}
+
+void TextHTMLBuilder::setOutputDevice(QIODevice *device)
+{
+  Q_D(TextHTMLBuilder);
+  d->m_text.setDevice(device);
+}
+
+void TextHTMLBuilder::setOutputFunction(
+    const std::function<void(const QString &)> &function)
+{
+  Q_D(TextHTMLBuilder);
+  d->m_text.setFunction(function);
 }
@@ -29,6 +29,10 @@
 #include "grantlee_textdocument_export.h"
 #include "markupdirector.h"
 
+#include <functional>
+
+class QIODevice;
+
 namespace Grantlee
 {
 
@@ -229,6 +233,19 @@ public:
 
   QString getResult() override;
 
+  /**
+    Writes the markup to @p device while it is built, encoded as UTF-8.
+    getResult then writes the rest of the markup and returns an empty
+    string.
+  */
+  void setOutputDevice(QIODevice *device);
+
+  /**
+    Passes the markup to @p function in chunks while it is built. getResult
+    then passes the rest of the markup and returns an empty string.
+  */
+  void setOutputFunction(const std::function<void(const QString &)> &function);
+
 private:
   TextHTMLBuilderPrivate *d_ptr;
   Q_DECLARE_PRIVATE(TextHTMLBuilder)
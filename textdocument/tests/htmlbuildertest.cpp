@@ -25,7 +25,9 @@
 #include <QtTest/QtTest>
 #include <QtTest/qtestevent.h>
 
+#include "concurrentmarkupexporter.h"
 #include "coverageobject.h"
+#include "incrementalmarkupexporter.h"
 #include "markupdirector.h"
 #include "testutils.h"
 #include "texthtmlbuilder.h"
@@ -62,6 +64,10 @@ private Q_SLOTS:
   void testHorizontalRule();
   void testNewlines();
   void testNewlinesThroughQTextCursor();
+  void testOutputDevice();
+  void testOutputFunction();
+  void testIncrementalExport();
+  void testConcurrentExport();
 };
 
 void TestHtmlOutput::testSingleFormat()
@@ -606,5 +612,165 @@ void TestHtmlOutput::testNewlinesThroughQTextCursor()
   QVERIFY(regex.match(result).hasMatch());
 }
 
+static void fillDocument(QTextDocument *doc, int paragraphs)
+{
+  QTextCursor cursor(doc);
+  for (auto i = 0; i < paragraphs; ++i) {
+    cursor.insertText(QStringLiteral("Paragraph %1 with an \u00e9 and a ")
+                          .arg(i));
+    cursor.insertHtml(QStringLiteral("<b>bold \U0001F600</b> word"));
+    cursor.insertBlock();
+  }
+}
+
+void TestHtmlOutput::testOutputDevice()
+{
+  QTextDocument doc;
+  fillDocument(&doc, 2000);
+
+  TextHTMLBuilder expectedBuilder;
+  MarkupDirector(&expectedBuilder).processDocument(&doc);
+  const auto expected = expectedBuilder.getResult();
+
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+
+  TextHTMLBuilder hb;
+  hb.setOutputDevice(&buffer);
+  MarkupDirector md(&hb);
+  md.processDocument(&doc);
+
+  // The markup is written while the document is processed.
+  QVERIFY(!buffer.data().isEmpty());
+  QVERIFY(buffer.data().size() < expected.toUtf8().size());
+
+  QCOMPARE(hb.getResult(), QString());
+  QCOMPARE(QString::fromUtf8(buffer.data()), expected);
+}
+
+void TestHtmlOutput::testOutputFunction()
+{
+  QTextDocument doc;
+  fillDocument(&doc, 2000);
+
+  TextHTMLBuilder expectedBuilder;
+  MarkupDirector(&expectedBuilder).processDocument(&doc);
+  const auto expected = expectedBuilder.getResult();
+
+  QStringList chunks;
+  TextHTMLBuilder hb;
+  hb.setOutputFunction(
+      [&chunks](const QString &chunk) { chunks.append(chunk); });
+  MarkupDirector md(&hb);
+  md.processDocument(&doc);
+  QCOMPARE(hb.getResult(), QString());
+
+  QVERIFY(chunks.size() > 1);
+  // Surrogate pairs are not split between chunks.
+  for (const auto &chunk : qAsConst(chunks))
+    QVERIFY(!chunk.at(chunk.size() - 1).isHighSurrogate());
+  QCOMPARE(chunks.join(QString()), expected);
+}
+
+static QString exportDocument(QTextDocument *doc)
+{
+  TextHTMLBuilder hb;
+  MarkupDirector(&hb).processDocument(doc);
+  return hb.getResult();
+}
+
+void TestHtmlOutput::testIncrementalExport()
+{
+  QTextDocument doc;
+  doc.setHtml(QStringLiteral(
+      "<p>First</p><p>Second <b>bold</b></p>"
+      "<ul><li>one</li><li>two</li></ul>"
+      "<p>Between</p>"
+      "<ul><li>three</li></ul>"
+      "<table><tr><td>cell</td><td>other</td></tr></table>"
+      "<p>Last</p>"));
+  fillDocument(&doc, 50);
+
+  TextHTMLBuilder hb;
+  MarkupDirector md(&hb);
+  IncrementalMarkupExporter exporter(&doc, &md, &hb);
+
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  const auto elements = exporter.lastProcessedCount();
+
+  // Nothing is processed if the document did not change.
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QCOMPARE(exporter.lastProcessedCount(), 0);
+
+  QTextCursor cursor(&doc);
+  const auto find = [&doc](const QString &text) {
+    return doc.find(text).selectionStart();
+  };
+
+  // Insert text in a paragraph.
+  cursor.setPosition(find(QStringLiteral("Second")));
+  cursor.insertText(QStringLiteral("The "));
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QVERIFY(exporter.lastProcessedCount() < 5);
+
+  // Edit a cell of the table.
+  cursor.setPosition(find(QStringLiteral("cell")));
+  cursor.insertText(QStringLiteral("A "));
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QVERIFY(exporter.lastProcessedCount() < 5);
+
+  // Remove the paragraph between the lists, which joins them.
+  cursor.setPosition(find(QStringLiteral("Between")));
+  cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+  cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QVERIFY(exporter.lastProcessedCount() < 5);
+
+  // Change the format of a block.
+  cursor.setPosition(find(QStringLiteral("Last")));
+  auto format = cursor.blockFormat();
+  format.setAlignment(Qt::AlignRight);
+  cursor.setBlockFormat(format);
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QVERIFY(exporter.lastProcessedCount() < 5);
+
+  // Several edits between two exports.
+  cursor.setPosition(find(QStringLiteral("First")));
+  cursor.insertBlock();
+  cursor.setPosition(find(QStringLiteral("Paragraph 20 ")));
+  cursor.insertText(QStringLiteral("Edited "));
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QVERIFY(exporter.lastProcessedCount() < 10);
+
+  exporter.invalidate();
+  QCOMPARE(exporter.markup(), exportDocument(&doc));
+  QVERIFY(exporter.lastProcessedCount() >= elements);
+}
+
+void TestHtmlOutput::testConcurrentExport()
+{
+  QTextDocument doc;
+  fillDocument(&doc, 100);
+  QTextCursor cursor(&doc);
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertHtml(QStringLiteral(
+      "<ul><li>one</li><li>two</li></ul>"
+      "<table><tr><td>cell</td><td>other</td></tr></table>"
+      "<ol><li>three</li></ol>"));
+  fillDocument(&doc, 100);
+
+  ConcurrentMarkupExporter exporter([] { return new TextHTMLBuilder(); });
+  exporter.setMinimumPartLength(500);
+  QCOMPARE(exporter.markup(&doc), exportDocument(&doc));
+  if (QThread::idealThreadCount() > 1)
+    QVERIFY(exporter.lastPartCount() > 1);
+
+  // Small documents are processed in one part.
+  exporter.setMinimumPartLength(doc.characterCount());
+  QCOMPARE(exporter.markup(&doc), exportDocument(&doc));
+  QCOMPARE(exporter.lastPartCount(), 1);
+}
+
 QTEST_MAIN(TestHtmlOutput)
 #include "htmlbuildertest.moc"
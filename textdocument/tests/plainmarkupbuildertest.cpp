@@ -26,7 +26,9 @@
 #include <QtTest/QtTest>
 #include <QtTest/qtestevent.h>
 
+#include "concurrentmarkupexporter.h"
 #include "coverageobject.h"
+#include "incrementalmarkupexporter.h"
 #include "markupdirector.h"
 #include "plaintextmarkupbuilder.h"
 #include "testutils.h"
@@ -68,6 +70,9 @@ private Q_SLOTS:
   void testBrInsideParagraph();
   void testLongDocument();
   void testNestedList();
+  void testOutputDevice();
+  void testConcurrentExport();
+  void testIncrementalExport();
 };
 
 void TestPlainMarkupOutput::testSingleFormat()
@@ -677,5 +682,79 @@ void TestPlainMarkupOutput::testNestedList()
   QCOMPARE(result, expected);
 }
 
+void TestPlainMarkupOutput::testOutputDevice()
+{
+  QTextDocument doc;
+  doc.setHtml(
+      QStringLiteral("A <a href=\"http://www.kde.org\">link</a> to KDE."));
+
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+
+  PlainTextMarkupBuilder hb;
+  hb.setOutputDevice(&buffer);
+  MarkupDirector md(&hb);
+  md.processDocument(&doc);
+  QCOMPARE(hb.getResult(), QString());
+
+  // The references are written after the text.
+  QCOMPARE(QString::fromUtf8(buffer.data()),
+           QStringLiteral("A link[1] to KDE.\n\n--------\n"
+                          "[1] http://www.kde.org\n"));
+}
+
+void TestPlainMarkupOutput::testConcurrentExport()
+{
+  QString html;
+  for (auto i = 0; i < 200; ++i)
+    html += QStringLiteral("<p>Paragraph %1 with a "
+                           "<a href=\"http://www.kde.org/%2\">link</a> and "
+                           "<a href=\"http://www.kde.org\">KDE</a>.</p>")
+                .arg(i)
+                .arg(i % 7);
+  QTextDocument doc;
+  doc.setHtml(html);
+
+  PlainTextMarkupBuilder hb;
+  MarkupDirector md(&hb);
+  md.processDocument(&doc);
+  const auto expected = hb.getResult();
+
+  // The references of the parts are numbered for the whole document.
+  ConcurrentMarkupExporter exporter(
+      [] { return new PlainTextMarkupBuilder(); });
+  exporter.setMinimumPartLength(500);
+  QCOMPARE(exporter.markup(&doc), expected);
+  if (QThread::idealThreadCount() > 1)
+    QVERIFY(exporter.lastPartCount() > 1);
+}
+
+void TestPlainMarkupOutput::testIncrementalExport()
+{
+  QTextDocument doc;
+  doc.setHtml(QStringLiteral(
+      "<p>A <a href=\"http://www.kde.org\">link</a>.</p>"
+      "<p>Another <a href=\"http://www.gnome.org\">link</a>.</p>"));
+
+  const auto exportDocument = [&doc] {
+    PlainTextMarkupBuilder hb;
+    MarkupDirector md(&hb);
+    md.processDocument(&doc);
+    return hb.getResult();
+  };
+
+  PlainTextMarkupBuilder hb;
+  MarkupDirector md(&hb);
+  IncrementalMarkupExporter exporter(&doc, &md, &hb);
+  QCOMPARE(exporter.markup(), exportDocument());
+
+  // The references are numbered for the whole document after an edit.
+  QTextCursor cursor(&doc);
+  cursor.setPosition(doc.find(QStringLiteral("Another")).selectionStart());
+  cursor.insertText(QStringLiteral("Yet "));
+  QCOMPARE(exporter.markup(), exportDocument());
+  QCOMPARE(exporter.lastProcessedCount(), 2);
+}
+
 QTEST_MAIN(TestPlainMarkupOutput)
 #include "plainmarkupbuildertest.moc"